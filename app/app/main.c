@@ -144,6 +144,9 @@ static void MemoryTask(void) {
 
 static void MainTask_10ms(void) {
 #ifdef USE_CAN
+#ifdef USE_CANIF
+  CanIf_MainFunction();
+#endif
 #ifdef USE_CANTP
   CanTp_MainFunction();
 #endif
@@ -163,6 +166,9 @@ static void MainTask_10ms(void) {
 #ifdef USE_COM
   Com_MainFunction();
 #endif
+#ifdef USE_PDUR
+  PduR_MainFunction();
+#endif
 
   MemoryTask();
 #ifdef USE_DCM
@@ -378,7 +384,14 @@ void Task_MainLoop(void) {
     stdio_main_function();
 #endif
     STD_TRACE_TEST_MAIN();
-#ifdef USE_OSAL
+#ifdef USE_TCPIP
+    /* the datagrams queued by the main functions above go out before the sleep */
+    TcpIp_FlushTx();
+#endif
+#if defined(USE_TCPIP_EPOLL)
+    /* sleep until any socket is readable, at most 1ms */
+    (void)TcpIp_Wait(1);
+#elif defined(USE_OSAL)
     osal_usleep(1000);
 #endif
   }
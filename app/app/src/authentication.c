@@ -103,7 +103,7 @@ Std_ReturnType Dcm_AuthenticationGetChallenge(uint8_t *challenge, uint16_t *leng
     *length = sizeof(lChallenge);
     for (i = 0; i < sizeof(lChallenge) / 4; i++) {
       uint32_t u32Seed; /* intentional not initialized to use the stack random value */
-      uint32_t u32Time = Std_GetTime();
+      uint32_t u32Time = (uint32_t)Std_GetRealTime(); /* not monotonic, differs on each boot */
       lChallengeSeed = lChallengeSeed ^ u32Seed ^ u32Time ^ 0xfeedbeef;
       lChallenge[i * 4 + 0] = (uint8_t)(lChallengeSeed >> 24);
       lChallenge[i * 4 + 1] = (uint8_t)(lChallengeSeed >> 16);
@@ -16,6 +16,13 @@
 #define App_SECURITY_LEVEL_EXTDS DCM_SEC_LEVEL1
 
 #define TO_BCD(v) (((v) / 10) * 16 + ((v) % 10))
+
+#if defined(linux) || defined(_WIN32)
+/* the monotonic Std_GetTime restarts from the same value on each boot */
+#define App_GetSeedTime() Std_GetRealTime()
+#else
+#define App_GetSeedTime() Std_GetTime()
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 /* ================================ [ DECLARES  ] ============================================== */
 extern void App_EnterProgramSession(void);
@@ -57,7 +64,7 @@ Std_ReturnType App_GetSessionChangePermission(Dcm_SesCtrlType sesCtrlTypeActive,
 
 Std_ReturnType App_GetProgramSessionSeed(uint8_t *seed, Dcm_NegativeResponseCodeType *errorCode) {
   uint32_t u32Seed; /* intentional not initialized to use the stack random value */
-  uint32_t u32Time = Std_GetTime();
+  uint32_t u32Time = (uint32_t)App_GetSeedTime();
 
   app_prgs_seed = app_prgs_seed ^ u32Seed ^ u32Time ^ 0xfeedbeef;
 
@@ -89,7 +96,7 @@ Std_ReturnType App_CompareProgramSessionKey(uint8_t *key, Dcm_NegativeResponseCo
 
 Std_ReturnType App_GetExtendedSessionSeed(uint8_t *seed, Dcm_NegativeResponseCodeType *errorCode) {
   uint32_t u32Seed; /* intentional not initialized to use the stack random value */
-  uint32_t u32Time = Std_GetTime();
+  uint32_t u32Time = (uint32_t)App_GetSeedTime();
 
   app_extds_seed = app_extds_seed ^ u32Seed ^ u32Time ^ 0x95774321;
 
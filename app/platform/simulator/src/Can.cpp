@@ -69,6 +69,9 @@ __attribute__((weak)) void CanIf_RxIndication(const Can_HwType *Mailbox,
 }
 __attribute__((weak)) void CanIf_TxConfirmation(PduIdType CanTxPduId) {
 }
+__attribute__((weak)) void CanIf_ControllerModeIndication(uint8_t ControllerId,
+                                                          Can_ControllerStateType ControllerMode) {
+}
 #ifdef USE_CAN_FILE_LOG
 static void logCan(boolean isRx, uint8_t Controller, uint32_t canid, uint8_t dlc,
                    const uint8_t *data) {
@@ -191,6 +194,11 @@ Std_ReturnType Can_SetControllerMode(uint8_t Controller, Can_ControllerStateType
   }
   ExitCritical();
 
+  if (E_OK == ret) {
+    /* the pending frames are dropped, their Tx confirmation never comes */
+    CanIf_ControllerModeIndication(Controller, Transition);
+  }
+
   return ret;
 }
 
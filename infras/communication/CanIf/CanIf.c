@@ -8,76 +8,100 @@
 #include "CanIf.h"
 #include "CanIf_Priv.h"
 #include "Can.h"
+#include "CanIf_Can.h"
 #include "Std_Debug.h"
+#ifdef CANIF_USE_TX_BUFFER
+#include "Std_Critical.h"
+#include <string.h>
+#endif
 /* ================================ [ MACROS    ] ============================================== */
 #define AS_LOG_CANIF 0
 #define AS_LOG_CANIFI 2
 #define AS_LOG_CANIFE 3
 
 #define CANIF_CONFIG (&CanIf_Config)
+
+#if defined(CANIF_USE_TX_BUFFER) && !defined(CANIF_TX_CONFIRM_TIMEOUT)
+/* a frame whose Tx confirmation is lost doesn't block its HTH longer than this */
+#define CANIF_TX_CONFIRM_TIMEOUT CANIF_CONVERT_MS_TO_MAIN_CYCLES(100)
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 /* ================================ [ DECLARES  ] ============================================== */
 extern const CanIf_ConfigType CanIf_Config;
 /* ================================ [ DATAS     ] ============================================== */
+#ifdef CANIF_USE_TX_BUFFER
+/* times a pending frame was refused by Can_Write, it is retried by CanIf_MainFunction */
+static uint32_t canIfTxBufferWriteErrors = 0;
+/* times an HTH was released as its Tx confirmation didn't come in time */
+static uint32_t canIfTxConfirmTimeouts = 0;
+#endif
 /* ================================ [ LOCALS    ] ============================================== */
-/* ================================ [ FUNCTIONS ] ============================================== */
-void CanIf_Init(const CanIf_ConfigType *ConfigPtr) {
-}
-
-Std_ReturnType CanIf_Transmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
-  Std_ReturnType ret = E_NOT_OK;
-  const CanIf_ConfigType *config = CANIF_CONFIG;
-  Can_PduType canPdu;
-  const CanIf_TxPduType *txPdu;
+#ifdef CANIF_USE_RX_HASH
+/* return the index of the rxPdus of rxMask matching the mailbox, or CANIF_RX_HASH_EMPTY */
+static uint16_t canIfFindMaskedRxPdu(const CanIf_RxMaskType *rxMask, const Can_HwType *Mailbox) {
+  const CanIf_RxPduType *var;
+  Can_IdType canid = Mailbox->CanId & rxMask->mask;
+  uint16_t index = CANIF_RX_HASH_EMPTY;
+  uint16_t l, h, m;
 
-  if (TxPduId < config->numOfTxPdus) {
-    canPdu.swPduHandle = TxPduId;
-    canPdu.length = PduInfoPtr->SduLength;
-    canPdu.sdu = PduInfoPtr->SduDataPtr;
-    txPdu = &config->txPdus[TxPduId];
-    if (NULL != txPdu->p_canid) {
-      canPdu.id = *txPdu->p_canid;
+  /* the lower bound of (Hoh, canid) */
+  l = 0;
+  h = rxMask->numOfRxPdus;
+  while (l < h) {
+    m = l + ((h - l) >> 1);
+    var = &CANIF_CONFIG->rxPdus[rxMask->rxPdus[m]];
+    if ((var->hoh < Mailbox->Hoh) || ((var->hoh == Mailbox->Hoh) && (var->canid < canid))) {
+      l = m + 1;
     } else {
-      canPdu.id = txPdu->canid;
+      h = m;
     }
+  }
 
-    ret = Can_Write(txPdu->hoh, &canPdu);
-  } else {
-    ASLOG(CANIFE, ("transmist with invalid TxPduId\n"));
+  if (l < rxMask->numOfRxPdus) {
+    var = &CANIF_CONFIG->rxPdus[rxMask->rxPdus[l]];
+    if ((var->hoh == Mailbox->Hoh) && (var->canid == canid)) {
+      index = rxMask->rxPdus[l];
+    }
   }
 
-  return ret;
+  return index;
 }
 
-void CanIf_SetDynamicTxId(PduIdType CanIfTxSduId, Can_IdType CanId) {
+static const CanIf_RxPduType *canIfFindRxPdu(const Can_HwType *Mailbox) {
   const CanIf_ConfigType *config = CANIF_CONFIG;
-  const CanIf_TxPduType *txPdu;
+  const CanIf_RxPduType *var;
+  const CanIf_RxPduType *rxPdu = NULL;
+  uint64_t key;
+  uint16_t i;
+  uint16_t index;
+  uint16_t first = CANIF_RX_HASH_EMPTY;
 
-  if (CanIfTxSduId < config->numOfTxPdus) {
-    txPdu = &config->txPdus[CanIfTxSduId];
-    if (NULL != txPdu->p_canid) {
-      *txPdu->p_canid = CanId;
-    } else {
-      ASLOG(CANIFE, ("[%d] canid is constant\n", CanIfTxSduId));
+  key = ((uint64_t)Mailbox->Hoh << 32) | (uint64_t)Mailbox->CanId;
+  i = config->rxHashSeeds[(uint64_t)(key * CANIF_RX_HASH_M1) >> (64 - config->rxHashSeedBits)];
+  i = config->rxHash[(uint64_t)((key ^ i) * CANIF_RX_HASH_M2) >> (64 - config->rxHashBits)];
+  if (CANIF_RX_HASH_EMPTY != i) {
+    var = &config->rxPdus[i];
+    if ((var->hoh == Mailbox->Hoh) && (var->canid == Mailbox->CanId)) {
+      rxPdu = var;
     }
-  } else {
-    ASLOG(CANIFE, ("set canid with invalid TxPduId\n"));
   }
-}
-
-void CanIf_TxConfirmation(PduIdType CanTxPduId) {
-  const CanIf_ConfigType *config = CANIF_CONFIG;
-  const CanIf_TxPduType *txPdu;
 
-  if (CanTxPduId < config->numOfTxPdus) {
-    txPdu = &config->txPdus[CanTxPduId];
-    txPdu->txConfirm(txPdu->txPduId, E_OK);
-  } else {
-    ASLOG(CANIFE, ("tx confirm with invalid TxPduId\n"));
+  if (NULL == rxPdu) {
+    for (i = 0; i < config->numOfRxMasks; i++) {
+      index = canIfFindMaskedRxPdu(&config->rxMasks[i], Mailbox);
+      if (index < first) {
+        first = index;
+      }
+    }
+    if (CANIF_RX_HASH_EMPTY != first) {
+      rxPdu = &config->rxPdus[first];
+    }
   }
-}
 
-void CanIf_RxIndication(const Can_HwType *Mailbox, const PduInfoType *PduInfoPtr) {
+  return rxPdu;
+}
+#else
+static const CanIf_RxPduType *canIfFindRxPdu(const Can_HwType *Mailbox) {
   const CanIf_ConfigType *config = CANIF_CONFIG;
   const CanIf_RxPduType *var;
   const CanIf_RxPduType *rxPdu = NULL;
@@ -127,6 +151,215 @@ void CanIf_RxIndication(const Can_HwType *Mailbox, const PduInfoType *PduInfoPtr
   }
 #endif
 
+  return rxPdu;
+}
+#endif
+
+static Std_ReturnType canIfWrite(PduIdType TxPduId, uint8_t *data, PduLengthType length) {
+  const CanIf_TxPduType *txPdu = &CANIF_CONFIG->txPdus[TxPduId];
+  Can_PduType canPdu;
+
+  canPdu.swPduHandle = TxPduId;
+  canPdu.length = length;
+  canPdu.sdu = data;
+  if (NULL != txPdu->p_canid) {
+    canPdu.id = *txPdu->p_canid;
+  } else {
+    canPdu.id = txPdu->canid;
+  }
+
+  return Can_Write(txPdu->hoh, &canPdu);
+}
+
+#ifdef CANIF_USE_TX_BUFFER
+/* write the pending PDU with the highest priority, must be called with the critical section
+ * entered */
+static void canIfTxBufferDrain(Can_HwHandleType hoh) {
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  const CanIf_TxHthType *hth = &config->txHths[hoh];
+  CanIf_TxBufferType *buffer;
+  PduIdType TxPduId;
+  uint16_t i;
+
+  for (i = 0; (0 == *hth->busy) && (i < hth->numOfTxPdus); i++) {
+    TxPduId = hth->txPdus[i];
+    buffer = config->txPdus[TxPduId].buffer;
+    if (TRUE == buffer->pending) {
+      if (E_OK == canIfWrite(TxPduId, buffer->data, buffer->length)) {
+        buffer->pending = FALSE;
+        *hth->busy = CANIF_TX_CONFIRM_TIMEOUT;
+      } else {
+        /* the HTH is still occupied, retry on the next Tx confirmation or main function */
+        canIfTxBufferWriteErrors++;
+        ASLOG(CANIF, ("[%d] write failed, %u errors\n", TxPduId, canIfTxBufferWriteErrors));
+        break;
+      }
+    }
+  }
+}
+
+static Std_ReturnType canIfTransmitBuffered(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
+  const CanIf_TxPduType *txPdu = &CANIF_CONFIG->txPdus[TxPduId];
+  CanIf_TxBufferType *buffer = txPdu->buffer;
+  Std_ReturnType ret = E_NOT_OK;
+
+  if (PduInfoPtr->SduLength <= buffer->size) {
+    EnterCritical();
+    memcpy(buffer->data, PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
+    buffer->length = PduInfoPtr->SduLength;
+    buffer->pending = TRUE;
+    canIfTxBufferDrain(txPdu->hoh);
+    ExitCritical();
+    ret = E_OK;
+  } else {
+    ASLOG(CANIFE, ("[%d] too long for the Tx buffer: %d > %d\n", TxPduId, PduInfoPtr->SduLength,
+                   buffer->size));
+  }
+
+  return ret;
+}
+
+/* the frames written or pending are gone with a stopped or bus-off controller, no Tx confirmation
+ * comes for them. The HTH of a controller has the same id as it in this stack. */
+static void canIfTxBufferReset(uint8_t ControllerId) {
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  const CanIf_TxHthType *hth;
+  uint16_t i;
+
+  if ((ControllerId < config->numOfTxHths) && (NULL != config->txHths[ControllerId].busy)) {
+    hth = &config->txHths[ControllerId];
+    EnterCritical();
+    for (i = 0; i < hth->numOfTxPdus; i++) {
+      config->txPdus[hth->txPdus[i]].buffer->pending = FALSE;
+    }
+    *hth->busy = 0;
+    ExitCritical();
+  }
+}
+#endif
+/* ================================ [ FUNCTIONS ] ============================================== */
+void CanIf_Init(const CanIf_ConfigType *ConfigPtr) {
+#ifdef CANIF_USE_TX_BUFFER
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  uint16_t i;
+
+  for (i = 0; i < config->numOfTxPdus; i++) {
+    if (NULL != config->txPdus[i].buffer) {
+      config->txPdus[i].buffer->pending = FALSE;
+    }
+  }
+
+  for (i = 0; i < config->numOfTxHths; i++) {
+    if (NULL != config->txHths[i].busy) {
+      *config->txHths[i].busy = 0;
+    }
+  }
+  canIfTxBufferWriteErrors = 0;
+  canIfTxConfirmTimeouts = 0;
+#endif
+}
+
+void CanIf_MainFunction(void) {
+#ifdef CANIF_USE_TX_BUFFER
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  uint16_t i;
+
+  /* nothing else retries the frames left pending by a failed Can_Write while the HTH is idle */
+  for (i = 0; i < config->numOfTxHths; i++) {
+    if (NULL != config->txHths[i].busy) {
+      EnterCritical();
+      if (*config->txHths[i].busy > 0) {
+        (*config->txHths[i].busy)--;
+        if (0 == *config->txHths[i].busy) {
+          canIfTxConfirmTimeouts++;
+          ASLOG(CANIFE, ("[%d] Tx confirm timeout, %u times\n", i, canIfTxConfirmTimeouts));
+        }
+      }
+      if (0 == *config->txHths[i].busy) {
+        canIfTxBufferDrain((Can_HwHandleType)i);
+      }
+      ExitCritical();
+    }
+  }
+#endif
+}
+
+Std_ReturnType CanIf_Transmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
+  Std_ReturnType ret = E_NOT_OK;
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+
+  if (TxPduId < config->numOfTxPdus) {
+#ifdef CANIF_USE_TX_BUFFER
+    if (NULL != config->txPdus[TxPduId].buffer) {
+      ret = canIfTransmitBuffered(TxPduId, PduInfoPtr);
+    } else
+#endif
+    {
+      ret = canIfWrite(TxPduId, PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
+    }
+  } else {
+    ASLOG(CANIFE, ("transmist with invalid TxPduId\n"));
+  }
+
+  return ret;
+}
+
+void CanIf_SetDynamicTxId(PduIdType CanIfTxSduId, Can_IdType CanId) {
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  const CanIf_TxPduType *txPdu;
+
+  if (CanIfTxSduId < config->numOfTxPdus) {
+    txPdu = &config->txPdus[CanIfTxSduId];
+    if (NULL != txPdu->p_canid) {
+      *txPdu->p_canid = CanId;
+    } else {
+      ASLOG(CANIFE, ("[%d] canid is constant\n", CanIfTxSduId));
+    }
+  } else {
+    ASLOG(CANIFE, ("set canid with invalid TxPduId\n"));
+  }
+}
+
+void CanIf_TxConfirmation(PduIdType CanTxPduId) {
+  const CanIf_ConfigType *config = CANIF_CONFIG;
+  const CanIf_TxPduType *txPdu;
+
+  if (CanTxPduId < config->numOfTxPdus) {
+    txPdu = &config->txPdus[CanTxPduId];
+#ifdef CANIF_USE_TX_BUFFER
+    if (NULL != txPdu->buffer) {
+      /* keep the bus busy before the upper layer gets the confirmation */
+      EnterCritical();
+      *config->txHths[txPdu->hoh].busy = 0;
+      canIfTxBufferDrain(txPdu->hoh);
+      ExitCritical();
+    }
+#endif
+    txPdu->txConfirm(txPdu->txPduId, E_OK);
+  } else {
+    ASLOG(CANIFE, ("tx confirm with invalid TxPduId\n"));
+  }
+}
+
+void CanIf_ControllerBusOff(uint8_t ControllerId) {
+  ASLOG(CANIFE, ("[%d] bus-off\n", ControllerId));
+#ifdef CANIF_USE_TX_BUFFER
+  canIfTxBufferReset(ControllerId);
+#endif
+}
+
+void CanIf_ControllerModeIndication(uint8_t ControllerId, Can_ControllerStateType ControllerMode) {
+  ASLOG(CANIF, ("[%d] mode %d\n", ControllerId, ControllerMode));
+#ifdef CANIF_USE_TX_BUFFER
+  /* a restarted controller drops the frames it held when it was stopped */
+  canIfTxBufferReset(ControllerId);
+#endif
+}
+
+void CanIf_RxIndication(const Can_HwType *Mailbox, const PduInfoType *PduInfoPtr) {
+  const CanIf_RxPduType *rxPdu;
+
+  rxPdu = canIfFindRxPdu(Mailbox);
   if (NULL != rxPdu) {
     if (NULL != rxPdu->rxInd) {
       rxPdu->rxInd(rxPdu->rxPduId, PduInfoPtr);
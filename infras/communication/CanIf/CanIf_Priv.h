@@ -9,7 +9,13 @@
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "ComStack_Types.h"
 #include "Can_GeneralTypes.h"
+#include "CanIf_Cfg.h"
 /* ================================ [ MACROS    ] ============================================== */
+#ifdef CANIF_USE_RX_HASH
+#define CANIF_RX_HASH_EMPTY 0xFFFF
+#define CANIF_RX_HASH_M1 0x9E3779B97F4A7C15ull
+#define CANIF_RX_HASH_M2 0xC2B2AE3D27D4EB4Full
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 typedef void (*CanIf_RxIndicationFncType)(PduIdType RxPduId, const PduInfoType *PduInfoPtr);
 typedef void (*CanIf_TxConfirmationFncType)(PduIdType TxPduId, Std_ReturnType result);
@@ -22,12 +28,40 @@ typedef struct {
   Can_HwHandleType hoh;
 } CanIf_RxPduType;
 
+#ifdef CANIF_USE_RX_HASH
+/* the Rx PDUs of a mask, sorted by hoh then canid, thus binary searched by (CanId & mask) */
+typedef struct {
+  const uint16_t *rxPdus; /* index of the rxPdus */
+  Can_IdType mask;
+  uint16_t numOfRxPdus;
+} CanIf_RxMaskType;
+#endif
+
+#ifdef CANIF_USE_TX_BUFFER
+/* one slot per Tx PDU, a new request overwrites the pending one */
+typedef struct {
+  uint8_t *data;
+  PduLengthType size;
+  PduLengthType length;
+  boolean pending;
+} CanIf_TxBufferType;
+
+typedef struct {
+  const PduIdType *txPdus; /* buffered Tx PDUs of the HTH, the lowest CAN ID first */
+  uint16_t *busy; /* cycles left to wait the Tx confirmation of the written frame, 0 if idle */
+  uint16_t numOfTxPdus;
+} CanIf_TxHthType;
+#endif
+
 typedef struct {
   CanIf_TxConfirmationFncType txConfirm;
   PduIdType txPduId;
   Can_IdType canid;
   Can_IdType *p_canid;
   Can_HwHandleType hoh;
+#ifdef CANIF_USE_TX_BUFFER
+  CanIf_TxBufferType *buffer; /* NULL if the HTH is not buffered */
+#endif
 } CanIf_TxPduType;
 
 struct CanIf_Config_s {
@@ -35,6 +69,25 @@ struct CanIf_Config_s {
   const CanIf_TxPduType *txPdus;
   uint16_t numOfRxPdus;
   uint16_t numOfTxPdus;
+#ifdef CANIF_USE_RX_HASH
+  /* perfect hash generated for the Rx PDUs with an exact CAN ID, with the 64 bits key
+   * (Hoh << 32) | CanId, thus unique for any CAN ID including its IDE/FD flag bits:
+   *   seed = rxHashSeeds[(key * CANIF_RX_HASH_M1) >> (64 - rxHashSeedBits)]
+   *   rxHash[((key ^ seed) * CANIF_RX_HASH_M2) >> (64 - rxHashBits)] is the index of the rxPdus
+   * or CANIF_RX_HASH_EMPTY */
+  const uint16_t *rxHashSeeds;
+  const uint16_t *rxHash;
+  /* the Rx PDUs with a mask grouped by mask, searched if the hash misses, the first one of the
+   * config wins if several masks match */
+  const CanIf_RxMaskType *rxMasks;
+  uint16_t numOfRxMasks;
+  uint8_t rxHashSeedBits;
+  uint8_t rxHashBits;
+#endif
+#ifdef CANIF_USE_TX_BUFFER
+  const CanIf_TxHthType *txHths; /* indexed by hoh */
+  uint16_t numOfTxHths;
+#endif
 };
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
@@ -18,6 +18,9 @@
 #include "Std_Debug.h"
 #include <string.h>
 #include "Std_Topic.h"
+#if defined(CANTP_CF_BURST) && defined(USE_SHELL)
+#include "shell.h"
+#endif
 /* ================================ [ MACROS    ] ============================================== */
 #define AS_LOG_CANTP 0
 #define AS_LOG_CANTPI 0
@@ -41,6 +44,18 @@
 
 #define N_PCI_SN 0x0F
 
+/* STmin 0xF1~0xF9 is 100~900 us, the reserved values shall be handled as 0x7F */
+#define N_STMIN_US_MIN 0xF1
+#define N_STMIN_US_MAX 0xF9
+#define N_STMIN_MS_MAX 0x7F
+
+/* more than 1 CF in flight only makes sense when the CanIf_Transmit is not trigger based */
+#if defined(CANTP_CF_BURST) && !defined(CANTP_USE_TRIGGER_TRANSMIT)
+#if CANTP_CF_BURST > 1
+#define CANTP_USE_CF_BURST
+#endif
+#endif
+
 #ifdef CANTP_FIX_LL_DL
 #define CanTp_GetDL(len, LL_DL) LL_DL
 #endif
@@ -53,6 +68,9 @@ static void CanTp_SendSF(PduIdType TxPduId);
 static void CanTp_SendFC(PduIdType TxPduId);
 #endif
 static void CanTp_SendCF(PduIdType TxPduId);
+#ifdef CANTP_USE_CF_BURST
+static void CanTp_SendCFBurst(PduIdType TxPduId);
+#endif
 /* ================================ [ DATAS     ] ============================================== */
 #ifndef CANTP_FIX_LL_DL
 static const PduLengthType lLL_DLs[] = {8, 12, 16, 20, 24, 32, 48};
@@ -62,6 +80,9 @@ static void CanTp_ResetToIdle(CanTp_ChannelContextType *context) {
   context->timer = 0;
   context->state = CANTP_IDLE;
   context->TpSduLength = 0;
+#ifdef CANTP_USE_CF_BURST
+  context->numOfPending = 0;
+#endif
 }
 
 #ifndef CANTP_FIX_LL_DL
@@ -79,6 +100,22 @@ static PduLengthType CanTp_GetDL(PduLengthType len, PduLengthType LL_DL) {
 }
 #endif
 
+#ifndef CANTP_USE_TRIGGER_TRANSMIT
+static uint32_t CanTp_GetSTminUs(uint8_t STmin) {
+  uint32_t us;
+
+  if (STmin <= N_STMIN_MS_MAX) {
+    us = (uint32_t)STmin * 1000;
+  } else if ((STmin >= N_STMIN_US_MIN) && (STmin <= N_STMIN_US_MAX)) {
+    us = (uint32_t)(STmin - 0xF0) * 100;
+  } else {
+    us = (uint32_t)N_STMIN_MS_MAX * 1000;
+  }
+
+  return us;
+}
+#endif
+
 static uint8_t CanTp_GetSFMaxLen(const CanTp_ChannelConfigType *config) {
   PduLengthType sfMaxLen;
   if (config->LL_DL > 8) {
@@ -150,51 +187,158 @@ static void CanTp_HandleSF(PduIdType RxPduId, uint8_t pci, uint8_t *data, uint8_
 }
 
 #ifndef CANTP_NO_FC
+/* the room the upper layer has for the next CFs, a CopyRxData of length 0 asks for it */
+static BufReq_ReturnType CanTp_GetRxBufferSize(const CanTp_ChannelConfigType *config,
+                                               PduLengthType *bufferSize) {
+  PduInfoType PduInfo;
+
+  PduInfo.SduDataPtr = NULL;
+  PduInfo.MetaDataPtr = NULL;
+  PduInfo.SduLength = 0;
+  *bufferSize = (PduLengthType)-1; /* no limit if the upper layer doesn't tell */
+
+  return PduR_CanTpCopyRxData(config->PduR_RxPduId, &PduInfo, bufferSize);
+}
+
+static PduLengthType CanTp_GetCFMaxLen(const CanTp_ChannelConfigType *config) {
+  PduLengthType cfMaxLen = config->LL_DL - 1;
+
+  if (CANTP_EXTENDED == config->AddressingFormat) {
+    cfMaxLen--;
+  }
+
+  return cfMaxLen;
+}
+
+/* the FC in context->PduInfo is sent, wait for the CFs of the block it allowed or, for a FC.WAIT,
+ * for the upper layer to free some room */
+static void CanTp_HandleFCTxCompleted(const CanTp_ChannelConfigType *config,
+                                      CanTp_ChannelContextType *context) {
+  uint8_t pos = 0;
+
+  if (CANTP_EXTENDED == config->AddressingFormat) {
+    pos++;
+  }
+
+  if (N_PCI_WT == (context->PduInfo.SduDataPtr[pos] & N_PCI_FS)) {
+    context->state = CANTP_WAIT_RX_BUFFER;
+    /* the next FC must be sent before the N_Bs of the sender expires */
+    context->timer = (config->N_Bs > 1) ? (config->N_Bs / 2) : 1;
+  } else {
+    context->state = CANTP_WAIT_CF;
+    context->timer = config->N_Cr;
+    context->BS = context->PduInfo.SduDataPtr[pos + 1];
+  }
+}
+
 static void CanTp_SendFC(PduIdType RxPduId) {
   const CanTp_ChannelConfigType *config;
   CanTp_ChannelContextType *context;
 #ifndef CANTP_USE_TRIGGER_TRANSMIT
   Std_ReturnType r;
 #endif
+  BufReq_ReturnType bufReq;
+  PduLengthType bufferSize;
+  PduLengthType numOfCFs;
+  uint8_t FS = N_PCI_CTS;
+  uint8_t BS;
   uint8_t *data;
   uint8_t pos = 0;
 
   context = &(CANTP_CONFIG->channelContexts[RxPduId]);
   config = &(CANTP_CONFIG->channelConfigs[RxPduId]);
 
-  data = config->data;
-
-  if (CANTP_EXTENDED == config->AddressingFormat) {
-    data[pos++] = config->N_TA;
+  /* a destination slower than this source, the PduR cut-through ring to another bus for example,
+   * is never overrun: no more CFs in a block than it has room for and FC.WAIT if not even one */
+  BS = config->BS;
+  bufReq = CanTp_GetRxBufferSize(config, &bufferSize);
+  if ((BUFREQ_OK == bufReq) && (bufferSize < context->TpSduLength)) {
+    numOfCFs = bufferSize / CanTp_GetCFMaxLen(config);
+    if (0 == numOfCFs) {
+      FS = N_PCI_WT;
+      BS = 0;
+    } else if ((0 == BS) || (numOfCFs < BS)) {
+      BS = (numOfCFs < 0xFF) ? (uint8_t)numOfCFs : 0xFF;
+    } else {
+      /* the configured BS fits */
+    }
   }
 
-  data[pos++] = N_PCI_FC | N_PCI_CTS;
-  data[pos++] = config->BS;
-  data[pos++] = config->STmin;
-  while (pos < 8) {
-    data[pos++] = config->padding;
-  }
-  ASLOG(CANTPI, ("[%d]TX data=[%02X,%02X,%02X,%02X,%02X,%02X,%02X,%02X]\n", RxPduId, data[0],
-                 data[1], data[2], data[3], data[4], data[5], data[6], data[7]));
-  context->PduInfo.SduDataPtr = data;
-  context->PduInfo.SduLength = 8;
+  if (BUFREQ_OK != bufReq) {
+    ASLOG(CANTPE, ("[%d]FC: no Rx buffer, status %d\n", RxPduId, bufReq));
+    CanTp_ResetToIdle(context);
+    PduR_CanTpRxIndication(config->PduR_RxPduId, E_NOT_OK);
+  } else if ((N_PCI_WT == FS) && (context->WftCounter >= config->CanTpRxWftMax)) {
+    ASLOG(CANTPE, ("[%d]FC: still no Rx buffer after %d FC.WAIT\n", RxPduId, context->WftCounter));
+    CanTp_ResetToIdle(context);
+    PduR_CanTpRxIndication(config->PduR_RxPduId, E_NOT_OK);
+  } else {
+    if (N_PCI_WT == FS) {
+      context->WftCounter++;
+    } else {
+      context->WftCounter = 0;
+    }
+
+    data = config->data;
+
+    if (CANTP_EXTENDED == config->AddressingFormat) {
+      data[pos++] = config->N_TA;
+    }
+
+    data[pos++] = N_PCI_FC | FS;
+    data[pos++] = BS;
+    data[pos++] = config->STmin;
+    while (pos < 8) {
+      data[pos++] = config->padding;
+    }
+    ASLOG(CANTPI, ("[%d]TX data=[%02X,%02X,%02X,%02X,%02X,%02X,%02X,%02X]\n", RxPduId, data[0],
+                   data[1], data[2], data[3], data[4], data[5], data[6], data[7]));
+    context->PduInfo.SduDataPtr = data;
+    context->PduInfo.SduLength = 8;
 
 #ifdef CANTP_USE_TRIGGER_TRANSMIT
-  context->timer = config->N_As;
-  context->state = CANTP_RESEND_FC;
-#else
-  r = CanIf_Transmit(config->CanIfTxPduId, &context->PduInfo);
-  if (E_OK == r) {
-    STD_TOPIC_ISOTP(RxPduId, FALSE, CanIf_CanTpGetTxCanId(config->CanIfTxPduId),
-                    context->PduInfo.SduLength, context->PduInfo.SduDataPtr);
-    context->state = CANTP_WAIT_CF;
-    context->timer = config->N_Cr;
-    context->BS = config->BS;
-  } else {
     context->timer = config->N_As;
     context->state = CANTP_RESEND_FC;
-  }
+#else
+    r = CanIf_Transmit(config->CanIfTxPduId, &context->PduInfo);
+    if (E_OK == r) {
+      STD_TOPIC_ISOTP(RxPduId, FALSE, CanIf_CanTpGetTxCanId(config->CanIfTxPduId),
+                      context->PduInfo.SduLength, context->PduInfo.SduDataPtr);
+      CanTp_HandleFCTxCompleted(config, context);
+    } else {
+      context->timer = config->N_As;
+      context->state = CANTP_RESEND_FC;
+    }
 #endif
+  }
+}
+
+/* after a FC.WAIT, the block goes on as soon as the upper layer has room for one CF */
+static void CanTp_WaitRxBuffer(PduIdType RxPduId) {
+  const CanTp_ChannelConfigType *config;
+  CanTp_ChannelContextType *context;
+  BufReq_ReturnType bufReq;
+  PduLengthType bufferSize;
+  PduLengthType cfMaxLen;
+
+  context = &(CANTP_CONFIG->channelContexts[RxPduId]);
+  config = &(CANTP_CONFIG->channelConfigs[RxPduId]);
+
+  cfMaxLen = CanTp_GetCFMaxLen(config);
+  if (cfMaxLen > context->TpSduLength) {
+    cfMaxLen = context->TpSduLength;
+  }
+
+  bufReq = CanTp_GetRxBufferSize(config, &bufferSize);
+  if (BUFREQ_OK != bufReq) {
+    ASLOG(CANTPE, ("[%d]wait Rx buffer failed with status %d\n", RxPduId, bufReq));
+    CanTp_ResetToIdle(context);
+    PduR_CanTpRxIndication(config->PduR_RxPduId, E_NOT_OK);
+  } else if (bufferSize >= cfMaxLen) {
+    CanTp_SendFC(RxPduId);
+  } else {
+    /* wait */
+  }
 }
 #endif
 
@@ -264,6 +408,7 @@ static void CanTp_HandleFF(PduIdType RxPduId, uint8_t pci, uint8_t *data, uint8_
       context->timer = config->N_Cr;
       context->BS = 0;
 #else
+      context->WftCounter = 0;
       CanTp_SendFC(RxPduId);
 #endif
     }
@@ -347,7 +492,14 @@ static void CanTp_HandleFC(PduIdType RxPduId, uint8_t pci, uint8_t *data, uint8_
         context->STmin = data[1];
       }
       context->BS = context->cfgBS;
-      CanTp_SendCF(RxPduId);
+#ifdef CANTP_USE_CF_BURST
+      if (0 == context->STmin) {
+        CanTp_SendCFBurst(RxPduId);
+      } else
+#endif
+      {
+        CanTp_SendCF(RxPduId);
+      }
       break;
     case N_PCI_WT:
       if (context->WftCounter < 0xFF) {
@@ -369,6 +521,16 @@ static void CanTp_HandleFC(PduIdType RxPduId, uint8_t pci, uint8_t *data, uint8_
 }
 #endif
 
+#ifdef CANTP_USE_CF_BURST
+static void CanTp_CFInFlight(CanTp_ChannelContextType *context) {
+  context->numOfPending++;
+  if (context->numOfPending > context->stats.maxPending) {
+    context->stats.maxPending = context->numOfPending;
+  }
+}
+
+#endif
+
 static void CanTp_SendSF(PduIdType TxPduId) {
   const CanTp_ChannelConfigType *config;
   CanTp_ChannelContextType *context;
@@ -476,6 +638,9 @@ static void CanTp_SendFF(PduIdType TxPduId) {
   bufReq = PduR_CanTpCopyTxData(config->PduR_TxPduId, &PduInfo, NULL, &bufferSize);
   if (BUFREQ_OK == bufReq) {
     context->TpSduLength -= PduInfo.SduLength;
+#ifdef CANTP_USE_CF_BURST
+    context->stats.numOfTxBytes += PduInfo.SduLength;
+#endif
     context->PduInfo.SduDataPtr = data;
     context->PduInfo.SduLength = config->LL_DL;
     context->SN = 1;
@@ -529,10 +694,6 @@ static void CanTp_SendCF(PduIdType TxPduId) {
   }
 
   data[pos++] = N_PCI_CF | context->SN;
-  context->SN++;
-  if (context->SN > 15) {
-    context->SN = 0;
-  }
 
   bufferSize = config->LL_DL - pos;
 
@@ -546,7 +707,18 @@ static void CanTp_SendCF(PduIdType TxPduId) {
 
   bufReq = PduR_CanTpCopyTxData(config->PduR_TxPduId, &PduInfo, NULL, &bufferSize);
   if (BUFREQ_OK == bufReq) {
+    context->SN++;
+    if (context->SN > 15) {
+      context->SN = 0;
+    }
     context->TpSduLength -= PduInfo.SduLength;
+#ifdef CANTP_USE_CF_BURST
+    /* the block is accounted when the CF is built as several CFs may be in flight */
+    if (context->BS > 0) {
+      context->BS--;
+    }
+    context->stats.numOfTxBytes += PduInfo.SduLength;
+#endif
     pos += PduInfo.SduLength;
     ll_dl = CanTp_GetDL(pos, config->LL_DL);
     while (pos < ll_dl) {
@@ -564,6 +736,9 @@ static void CanTp_SendCF(PduIdType TxPduId) {
     if (E_OK == r) {
       STD_TOPIC_ISOTP(TxPduId, FALSE, CanIf_CanTpGetTxCanId(config->CanIfTxPduId),
                       context->PduInfo.SduLength, context->PduInfo.SduDataPtr);
+#ifdef CANTP_USE_CF_BURST
+      CanTp_CFInFlight(context);
+#endif
       context->state = CANTP_WAIT_CF_TX_COMPLETED;
       context->timer = config->N_As;
     } else {
@@ -571,6 +746,13 @@ static void CanTp_SendCF(PduIdType TxPduId) {
       context->timer = config->N_As;
     }
 #endif
+  } else if (BUFREQ_E_BUSY == bufReq) {
+    /* data not available yet, e.g. a cut-through gateway still receiving, retry on next cycle
+     * but give up if nothing comes within N_Bs */
+    if (CANTP_WAIT_CF_DATA != context->state) {
+      context->state = CANTP_WAIT_CF_DATA;
+      context->timer = config->N_Bs;
+    }
   } else {
     ASLOG(CANTPE, ("[%d]CF: failed to provide TX data, reset to idle\n", TxPduId));
     CanTp_ResetToIdle(context);
@@ -578,6 +760,63 @@ static void CanTp_SendCF(PduIdType TxPduId) {
   }
 }
 
+#ifndef CANTP_USE_TRIGGER_TRANSMIT
+static void CanTp_StartSTmin(CanTp_ChannelContextType *context) {
+  context->state = CANTP_SEND_CF_DELAY;
+#ifdef CANTP_USE_STD_TIMER
+  context->deadline = Std_GetTime() + CanTp_GetSTminUs(context->STmin);
+  context->timer = 0;
+#else
+  /* rounded up to the main function period, at least 1 cycle for the us STmin */
+  context->timer = CANTP_CONVERT_MS_TO_MAIN_CYCLES((CanTp_GetSTminUs(context->STmin) + 999) / 1000);
+#endif
+}
+#endif
+
+#ifdef CANTP_USE_CF_BURST
+/* queue CFs back to back as long as the block, the burst depth and the lower layer allow it,
+ * the caller ensures the STmin is 0 */
+static void CanTp_SendCFBurst(PduIdType TxPduId) {
+  CanTp_ChannelContextType *context;
+  context = &(CANTP_CONFIG->channelContexts[TxPduId]);
+
+  do {
+    CanTp_SendCF(TxPduId);
+  } while ((CANTP_WAIT_CF_TX_COMPLETED == context->state) && (context->TpSduLength > 0) &&
+           (context->numOfPending < CANTP_CF_BURST) &&
+           ((0 == context->cfgBS) || (context->BS > 0)));
+}
+
+static void CanTp_HandleCFTxCompleted(PduIdType TxPduId) {
+  const CanTp_ChannelConfigType *config;
+  CanTp_ChannelContextType *context;
+  context = &(CANTP_CONFIG->channelContexts[TxPduId]);
+  config = &(CANTP_CONFIG->channelConfigs[TxPduId]);
+
+  if (context->numOfPending > 0) {
+    context->numOfPending--;
+  }
+
+  if ((context->TpSduLength > 0) && ((0 == context->cfgBS) || (context->BS > 0))) {
+    if (context->STmin > 0) {
+      CanTp_StartSTmin(context);
+    } else {
+      CanTp_SendCFBurst(TxPduId);
+    }
+  } else if (context->numOfPending > 0) {
+    /* the rest of the burst is still in flight */
+    context->timer = config->N_As;
+  } else if (context->TpSduLength > 0) {
+    context->BS = context->cfgBS;
+    context->state = CANTP_WAIT_FC;
+    context->WftCounter = 0;
+    context->timer = config->N_Bs;
+  } else {
+    CanTp_ResetToIdle(context);
+    PduR_CanTpTxConfirmation(config->PduR_TxPduId, E_OK);
+  }
+}
+#else
 static void CanTp_HandleCFTxCompleted(PduIdType TxPduId) {
   const CanTp_ChannelConfigType *config;
   CanTp_ChannelContextType *context;
@@ -601,8 +840,7 @@ static void CanTp_HandleCFTxCompleted(PduIdType TxPduId) {
       CanTp_SendCF(TxPduId);
 #else
       if (context->STmin > 0) {
-        context->state = CANTP_SEND_CF_DELAY;
-        context->timer = CANTP_CONVERT_MS_TO_MAIN_CYCLES(context->STmin);
+        CanTp_StartSTmin(context);
       } else {
         CanTp_SendCF(TxPduId);
       }
@@ -613,6 +851,7 @@ static void CanTp_HandleCFTxCompleted(PduIdType TxPduId) {
     PduR_CanTpTxConfirmation(config->PduR_TxPduId, E_OK);
   }
 }
+#endif
 
 #ifdef CANTP_USE_TRIGGER_TRANSMIT
 Std_ReturnType CanTp_ReSend(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
@@ -652,6 +891,9 @@ static void CanTp_ReSend(PduIdType TxPduId) {
     } else if (CANTP_RESEND_FC == context->state) {
       context->state = CANTP_WAIT_FC_TX_COMPLETED;
     } else if (CANTP_RESEND_CF == context->state) {
+#ifdef CANTP_USE_CF_BURST
+      CanTp_CFInFlight(context);
+#endif
       context->state = CANTP_WAIT_CF_TX_COMPLETED;
     } else {
       ASLOG(CANTPE, ("[%d]resend in wrong state %d, impossible case", TxPduId, context->state));
@@ -669,13 +911,17 @@ static void CanTp_ReSend(PduIdType TxPduId) {
       context->WftCounter = 0;
       context->timer = config->N_Bs;
 #endif
+#ifndef CANTP_NO_FC
     } else if (CANTP_RESEND_FC == context->state) {
-      context->state = CANTP_WAIT_CF;
-      context->timer = config->N_Cr;
+      CanTp_HandleFCTxCompleted(config, context);
+#endif
     } else if (CANTP_RESEND_CF == context->state) {
 #ifdef CANTP_USE_TRIGGER_TRANSMIT
       CanTp_HandleCFTxCompleted(TxPduId);
 #else
+#ifdef CANTP_USE_CF_BURST
+      CanTp_CFInFlight(context);
+#endif
       context->state = CANTP_WAIT_CF_TX_COMPLETED;
       context->timer = config->N_As;
 #endif
@@ -713,6 +959,10 @@ void CanTp_InitChannel(uint8_t Channel) {
   context->STmin = 0;
   context->PduInfo.MetaDataPtr = NULL;
   context->TpSduLength = 0;
+#ifdef CANTP_USE_CF_BURST
+  context->numOfPending = 0;
+  memset(&context->stats, 0, sizeof(context->stats));
+#endif
 }
 
 void CanTp_Init(const CanTp_ConfigType *CfgPtr) {
@@ -815,13 +1065,18 @@ void CanTp_TxConfirmation(PduIdType TxPduId, Std_ReturnType result) {
       context->timer = config->N_Bs;
       break;
 #endif
-#ifdef CANTP_USE_TX_CONFIRMATION
+#if defined(CANTP_USE_TX_CONFIRMATION) && !defined(CANTP_NO_FC)
     case CANTP_WAIT_FC_TX_COMPLETED:
-      context->state = CANTP_WAIT_CF;
-      context->timer = config->N_Cr;
+      CanTp_HandleFCTxCompleted(config, context);
       break;
 #endif
     default:
+#ifdef CANTP_USE_CF_BURST
+      /* a CF of the burst confirmed while waiting to resend another or for more data */
+      if (context->numOfPending > 0) {
+        context->numOfPending--;
+      }
+#endif
       break;
     }
   }
@@ -850,6 +1105,33 @@ void CanTp_MainFunction_Channel(uint8_t Channel) {
   CanTp_ChannelContextType *context;
   context = &(CANTP_CONFIG->channelContexts[Channel]);
   config = &(CANTP_CONFIG->channelConfigs[Channel]);
+  if (CANTP_WAIT_CF_DATA == context->state) {
+    CanTp_SendCF((PduIdType)Channel);
+  }
+#ifndef CANTP_NO_FC
+  if (CANTP_WAIT_RX_BUFFER == context->state) {
+    CanTp_WaitRxBuffer((PduIdType)Channel);
+  }
+#endif
+#ifdef CANTP_USE_CF_BURST
+  switch (context->state) {
+  case CANTP_WAIT_FIRST_FC:
+  case CANTP_WAIT_FC:
+  case CANTP_SEND_CF_DELAY:
+  case CANTP_RESEND_FF:
+  case CANTP_RESEND_CF:
+  case CANTP_WAIT_FF_TX_COMPLETED:
+  case CANTP_WAIT_CF_TX_COMPLETED:
+  case CANTP_WAIT_CF_DATA:
+    context->stats.numOfTxCycles++;
+    break;
+  default:
+    break;
+  }
+#endif
+#ifdef CANTP_USE_STD_TIMER
+  (void)CanTp_MainFunction_SeparationTime(Channel);
+#endif
 #ifndef CANTP_USE_TRIGGER_TRANSMIT
   switch (context->state) {
   case CANTP_RESEND_SF:
@@ -866,7 +1148,7 @@ void CanTp_MainFunction_Channel(uint8_t Channel) {
   if (context->timer > 0) {
     context->timer--;
     if (0 == context->timer) {
-      if (CANTP_SEND_CF_DELAY != context->state) {
+      if ((CANTP_SEND_CF_DELAY != context->state) && (CANTP_WAIT_RX_BUFFER != context->state)) {
         ASLOG(CANTPE, ("[%d] timer timeout in state %d\n", Channel, context->state));
       }
 
@@ -881,6 +1163,12 @@ void CanTp_MainFunction_Channel(uint8_t Channel) {
       case CANTP_SEND_CF_DELAY:
         CanTp_SendCF((PduIdType)Channel);
         break;
+#ifndef CANTP_NO_FC
+      case CANTP_WAIT_RX_BUFFER:
+        /* still no room, FC.WAIT again to keep the sender waiting */
+        CanTp_SendFC((PduIdType)Channel);
+        break;
+#endif
       default:
         CanTp_ResetToIdle(context);
         PduR_CanTpTxConfirmation(config->PduR_TxPduId, E_NOT_OK);
@@ -890,6 +1178,26 @@ void CanTp_MainFunction_Channel(uint8_t Channel) {
   }
 }
 
+#ifdef CANTP_USE_STD_TIMER
+std_time_t CanTp_MainFunction_SeparationTime(uint8_t Channel) {
+  CanTp_ChannelContextType *context;
+  std_time_t now;
+  std_time_t left = 0;
+
+  context = &(CANTP_CONFIG->channelContexts[Channel]);
+  if (CANTP_SEND_CF_DELAY == context->state) {
+    now = Std_GetTime();
+    if (STD_TIME_IS_REACHED(now, context->deadline)) {
+      CanTp_SendCF((PduIdType)Channel);
+    } else {
+      left = context->deadline - now;
+    }
+  }
+
+  return left;
+}
+#endif
+
 void CanTp_MainFunction(void) {
   uint8_t i;
   for (i = 0; i < CANTP_CONFIG->numOfChannels; i++) {
@@ -897,6 +1205,24 @@ void CanTp_MainFunction(void) {
   }
 }
 
+#if defined(CANTP_USE_CF_BURST) && defined(USE_SHELL)
+static int cmdCanTpFunc(int argc, const char *argv[]) {
+  const CanTp_ChannelStatisticsType *stats;
+  uint32_t ms;
+  uint8_t i;
+
+  for (i = 0; i < CANTP_CONFIG->numOfChannels; i++) {
+    stats = &CANTP_CONFIG->channelContexts[i].stats;
+    ms = stats->numOfTxCycles * CANTP_MAIN_FUNCTION_PERIOD;
+    PRINTF("%d: TX %u bytes in %u ms, %u B/s, max %u CFs in flight\n", i, stats->numOfTxBytes, ms,
+           (ms > 0) ? (uint32_t)(((uint64_t)stats->numOfTxBytes * 1000) / ms) : 0,
+           stats->maxPending);
+  }
+  return 0;
+}
+SHELL_REGISTER(cantp, "cantp - show the TX throughput of each CanTp channel\n", cmdCanTpFunc);
+#endif
+
 #ifdef CANTP_USE_TRIGGER_TRANSMIT
 PduLengthType CanTp_GetTxPacketLength(PduIdType TxPduId) {
   PduLengthType ret = 0;
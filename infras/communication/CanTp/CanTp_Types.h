@@ -8,6 +8,9 @@
 #define CANTP_TYPES_H
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "ComStack_Types.h"
+#ifdef CANTP_USE_STD_TIMER
+#include "Std_Timer.h"
+#endif
 /* ================================ [ MACROS    ] ============================================== */
 /* ================================ [ TYPES     ] ============================================== */
 /* @ECUC_CanTp_00281 */
@@ -58,8 +61,18 @@ enum
   CANTP_WAIT_FF_TX_COMPLETED,
   CANTP_WAIT_CF_TX_COMPLETED,
   CANTP_WAIT_FC_TX_COMPLETED,
+  CANTP_WAIT_CF_DATA,
+  CANTP_WAIT_RX_BUFFER, /* FC.WAIT sent, until the upper layer has room for the next CF */
 };
 
+#ifdef CANTP_CF_BURST
+typedef struct {
+  uint32_t numOfTxBytes;  /* payload bytes sent by FF and CFs */
+  uint32_t numOfTxCycles; /* main cycles spent sending a segmented message */
+  uint8_t maxPending;     /* the max number of CFs in flight */
+} CanTp_ChannelStatisticsType;
+#endif
+
 typedef struct {
   PduInfoType PduInfo;
   uint16_t timer;
@@ -70,6 +83,13 @@ typedef struct {
   uint8_t STmin;
   uint8_t WftCounter;
   uint8_t state;
+#ifdef CANTP_CF_BURST
+  CanTp_ChannelStatisticsType stats;
+  uint8_t numOfPending; /* CFs given to CanIf but not confirmed yet */
+#endif
+#ifdef CANTP_USE_STD_TIMER
+  std_time_t deadline; /* when the next CF is allowed to be sent in state CANTP_SEND_CF_DELAY */
+#endif
 } CanTp_ChannelContextType;
 
 struct CanTp_Config_s {
@@ -11,12 +11,19 @@
 #include "PduR_Com.h"
 #include "Std_Bit.h"
 #include <string.h>
+#ifdef COM_USE_RX_SEQLOCK
+#include "Std_Critical.h"
+#endif
 #ifdef USE_SHELL
 #include "Std_Debug.h"
 #include "shell.h"
 #endif
 /* ================================ [ MACROS    ] ============================================== */
 #define COM_CONFIG (&Com_Config)
+
+#ifndef COM_RX_SEQLOCK_RETRIES
+#define COM_RX_SEQLOCK_RETRIES 4
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 /* ================================ [ DECLARES  ] ============================================== */
 extern const Com_ConfigType Com_Config;
@@ -120,20 +127,60 @@ Std_ReturnType comSendSignalLittle(const Com_SignalConfigType *signal, const voi
   return ret;
 }
 
-Std_ReturnType comReceiveSignal(const Com_SignalConfigType *signal, void *SignalDataPtr) {
+#ifdef COM_USE_RX_SEQLOCK
+/* The Rx IPdu buffer is protected by a sequence lock: writers are serialized by the critical
+ * section and make the sequence odd while updating, readers retry the read if the sequence was
+ * odd or has been changed, up to COM_RX_SEQLOCK_RETRIES times before reading it in the critical
+ * section, so a reader never spins on a preempted writer. */
+static void comSeqWriteBegin(Com_IPduRxContextType *context) {
+  __atomic_store_n(&context->seq, context->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static void comSeqWriteEnd(Com_IPduRxContextType *context) {
+  __atomic_store_n(&context->seq, context->seq + 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t comSeqReadBegin(const Com_IPduRxContextType *context) {
+  return __atomic_load_n(&context->seq, __ATOMIC_ACQUIRE);
+}
+
+static boolean comSeqReadRetry(const Com_IPduRxContextType *context, uint32_t seq) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return ((seq & 1) || (seq != __atomic_load_n(&context->seq, __ATOMIC_RELAXED)));
+}
+
+static boolean comRxUpdateBitUsed(const Com_SignalConfigType *signal) {
+  boolean used = FALSE;
+#ifdef COM_USE_SIGNAL_UPDATE_BIT
+  used = (signal->UpdateBit != COM_UPDATE_BIT_NOT_USED);
+#endif
+  return used;
+}
+#endif
+
+static void comClearRxUpdateBit(const Com_SignalConfigType *signal) {
+#ifdef COM_USE_SIGNAL_UPDATE_BIT
+  if (signal->UpdateBit != COM_UPDATE_BIT_NOT_USED) {
+    Std_BitClear(signal->ptr, signal->UpdateBit);
+  }
+#else
+  (void)signal;
+#endif
+}
+
+/* read the signal without consuming its update bit, E_NOT_OK if it has not been updated */
+Std_ReturnType comReadSignal(const Com_SignalConfigType *signal, void *SignalDataPtr) {
   Std_ReturnType ret = E_NOT_OK;
+  boolean isUpdated = TRUE;
 #ifdef COM_USE_SIGNAL_UPDATE_BIT
-  boolean isUpdated;
   if (signal->UpdateBit != COM_UPDATE_BIT_NOT_USED) {
     isUpdated = Std_BitGet(signal->ptr, signal->UpdateBit);
-    if (FALSE == isUpdated) {
-      return E_NOT_OK;
-    } else {
-      Std_BitClear(signal->ptr, signal->UpdateBit);
-    }
   }
 #endif
-  if ((COM_UINT8N == signal->type) || (OPAQUE == signal->Endianness)) {
+  if (FALSE == isUpdated) {
+    /* not updated since the last read */
+  } else if ((COM_UINT8N == signal->type) || (OPAQUE == signal->Endianness)) {
     /* @SWS_Com_00472 */
     memcpy(SignalDataPtr, signal->ptr, (signal->BitSize >> 3));
     ret = E_OK;
@@ -152,6 +199,42 @@ Std_ReturnType comReceiveSignal(const Com_SignalConfigType *signal, void *Signal
   return ret;
 }
 
+Std_ReturnType comReceiveSignal(const Com_SignalConfigType *signal, void *SignalDataPtr) {
+  Std_ReturnType ret = E_NOT_OK;
+#ifdef COM_USE_RX_SEQLOCK
+  Com_IPduRxContextType *context = signal->rxContext;
+  boolean consistent = FALSE;
+  uint32_t seq = 0;
+  int retry;
+  if (NULL != context) {
+    for (retry = 0; (retry < COM_RX_SEQLOCK_RETRIES) && (FALSE == consistent); retry++) {
+      seq = comSeqReadBegin(context);
+      ret = comReadSignal(signal, SignalDataPtr);
+      consistent = (FALSE == comSeqReadRetry(context, seq));
+    }
+    if ((FALSE == consistent) || ((E_OK == ret) && comRxUpdateBitUsed(signal))) {
+      /* with the writers locked out, read again if the retries are exhausted or the IPdu has been
+       * written since the read, so the update bit is only cleared for the value returned */
+      EnterCritical();
+      if ((FALSE == consistent) || (seq != __atomic_load_n(&context->seq, __ATOMIC_RELAXED))) {
+        ret = comReadSignal(signal, SignalDataPtr);
+      }
+      if (E_OK == ret) {
+        comClearRxUpdateBit(signal);
+      }
+      ExitCritical();
+    }
+  } else
+#endif
+  {
+    ret = comReadSignal(signal, SignalDataPtr);
+    if (E_OK == ret) {
+      comClearRxUpdateBit(signal);
+    }
+  }
+  return ret;
+}
+
 Std_ReturnType comSendSignal(const Com_SignalConfigType *signal, const void *SignalDataPtr) {
   Std_ReturnType ret = E_NOT_OK;
   if ((COM_UINT8N == signal->type) || (OPAQUE == signal->Endianness)) {
@@ -177,12 +260,29 @@ Std_ReturnType comSendSignal(const Com_SignalConfigType *signal, const void *Sig
 #endif
   return ret;
 }
+
+void comWriteRxSignal(const Com_SignalConfigType *signal, const void *SignalDataPtr) {
+#ifdef COM_USE_RX_SEQLOCK
+  Com_IPduRxContextType *context = signal->rxContext;
+  if (NULL != context) {
+    EnterCritical();
+    comSeqWriteBegin(context);
+    (void)comSendSignal(signal, SignalDataPtr);
+    comSeqWriteEnd(context);
+    ExitCritical();
+  } else
+#endif
+  {
+    (void)comSendSignal(signal, SignalDataPtr);
+  }
+}
+
 void comIPduDataInit(const Com_IPduConfigType *IPduConfig) {
   const Com_SignalConfigType *signal;
   int i;
   for (i = 0; i < IPduConfig->numOfSignals; i++) {
     signal = IPduConfig->signals[i];
-    comSendSignal(signal, signal->initPtr);
+    comWriteRxSignal(signal, signal->initPtr);
   }
 }
 #ifdef COM_USE_SIGNAL_UPDATE_BIT
@@ -198,6 +298,71 @@ void comTxClearUpdateBit(const Com_IPduConfigType *IPduConfig) {
 }
 #endif
 
+#ifdef COM_USE_GATEWAY
+static boolean comGwRouteSignal(const Com_GwMappingType *mapping) {
+  const Com_SignalConfigType *src = mapping->SrcSignal;
+  const Com_SignalConfigType *dst = mapping->DstSignal;
+  boolean changed = FALSE;
+  uint32_t sigV;
+#ifdef COM_USE_SIGNAL_UPDATE_BIT
+  if (src->UpdateBit != COM_UPDATE_BIT_NOT_USED) {
+    if (FALSE == Std_BitGet(src->ptr, src->UpdateBit)) {
+      return FALSE;
+    }
+  }
+#endif
+  if ((COM_UINT8N == src->type) || (OPAQUE == src->Endianness)) {
+    /* byte aligned signal or signal group: copy the raw bytes, no bit packing */
+    if (0 != memcmp(dst->ptr, src->ptr, (src->BitSize >> 3))) {
+      memcpy(dst->ptr, src->ptr, (src->BitSize >> 3));
+      changed = TRUE;
+    }
+  } else {
+    if (BIG == src->Endianness) {
+      sigV = Std_BitGetBigEndian(src->ptr, src->BitPosition, src->BitSize);
+    } else {
+      sigV = Std_BitGetLittleEndian(src->ptr, src->BitPosition, src->BitSize);
+    }
+    if (BIG == dst->Endianness) {
+      if (sigV != Std_BitGetBigEndian(dst->ptr, dst->BitPosition, dst->BitSize)) {
+        Std_BitSetBigEndian(dst->ptr, sigV, dst->BitPosition, dst->BitSize);
+        changed = TRUE;
+      }
+    } else {
+      if (sigV != Std_BitGetLittleEndian(dst->ptr, dst->BitPosition, dst->BitSize)) {
+        Std_BitSetLittleEndian(dst->ptr, sigV, dst->BitPosition, dst->BitSize);
+        changed = TRUE;
+      }
+    }
+  }
+#ifdef COM_USE_SIGNAL_UPDATE_BIT
+  if (changed && (dst->UpdateBit != COM_UPDATE_BIT_NOT_USED)) {
+    Std_BitSet(dst->ptr, dst->UpdateBit);
+  }
+#endif
+  return changed;
+}
+
+static void comGwRxIndication(const Com_IPduRxConfigType *rxConfig) {
+  const Com_GwMappingType *mapping;
+  boolean changed = FALSE;
+  uint16_t i;
+
+  for (i = 0; i < rxConfig->numOfGwMappings; i++) {
+    mapping = &rxConfig->GwMappings[i];
+    if (comGwRouteSignal(mapping)) {
+      changed = TRUE;
+    }
+    /* mappings are sorted by DstPduId, trigger each changed Tx IPdu once */
+    if (changed && (((i + 1) == rxConfig->numOfGwMappings) ||
+                    (mapping->DstPduId != rxConfig->GwMappings[i + 1].DstPduId))) {
+      (void)Com_TriggerIPDUSend(mapping->DstPduId);
+      changed = FALSE;
+    }
+  }
+}
+#endif
+
 #ifdef USE_SHELL
 static int cmdComLsSgFunc(int argc, const char *argv[]) {
   union {
@@ -419,11 +584,32 @@ Std_ReturnType Com_SendSignalGroup(Com_SignalGroupIdType SignalGroupId) {
 Std_ReturnType Com_ReceiveSignalGroup(Com_SignalGroupIdType SignalGroupId) {
   Std_ReturnType ret = E_NOT_OK;
   const Com_SignalConfigType *signal;
+#ifdef COM_USE_RX_SEQLOCK
+  boolean consistent = FALSE;
+  uint32_t seq;
+  int retry;
+#endif
 
   if (SignalGroupId < COM_CONFIG->numOfSignals) {
     signal = &COM_CONFIG->SignalConfigs[SignalGroupId];
     if (COM_UINT8N == signal->type) {
-      memcpy((void *)signal->initPtr, signal->ptr, (signal->BitSize >> 3));
+#ifdef COM_USE_RX_SEQLOCK
+      if (NULL != signal->rxContext) {
+        for (retry = 0; (retry < COM_RX_SEQLOCK_RETRIES) && (FALSE == consistent); retry++) {
+          seq = comSeqReadBegin(signal->rxContext);
+          memcpy((void *)signal->initPtr, signal->ptr, (signal->BitSize >> 3));
+          consistent = (FALSE == comSeqReadRetry(signal->rxContext, seq));
+        }
+        if (FALSE == consistent) {
+          EnterCritical();
+          memcpy((void *)signal->initPtr, signal->ptr, (signal->BitSize >> 3));
+          ExitCritical();
+        }
+      } else
+#endif
+      {
+        memcpy((void *)signal->initPtr, signal->ptr, (signal->BitSize >> 3));
+      }
       ret = E_OK;
     }
   }
@@ -431,7 +617,6 @@ Std_ReturnType Com_ReceiveSignalGroup(Com_SignalGroupIdType SignalGroupId) {
   return ret;
 }
 
-#if defined(COM_USE_CAN)
 Std_ReturnType Com_TriggerIPDUSend(PduIdType PduId) {
   Std_ReturnType ret = E_NOT_OK;
   const Com_IPduConfigType *IPduConfig;
@@ -454,7 +639,6 @@ Std_ReturnType Com_TriggerIPDUSend(PduIdType PduId) {
 
   return ret;
 }
-#endif
 
 void Com_RxIndication(PduIdType RxPduId, const PduInfoType *PduInfoPtr) {
   const Com_IPduConfigType *IPduConfig;
@@ -466,8 +650,19 @@ void Com_RxIndication(PduIdType RxPduId, const PduInfoType *PduInfoPtr) {
     IPduConfig = &COM_CONFIG->IPduConfigs[RxPduId];
     if (IPduConfig->rxConfig && (COM_CONFIG->context->GroupStatus & IPduConfig->GroupRefMask)) {
       if (IPduConfig->length <= PduInfoPtr->SduLength) {
+#ifdef COM_USE_RX_SEQLOCK
+        EnterCritical();
+        comSeqWriteBegin(IPduConfig->rxConfig->context);
+#endif
         memcpy(IPduConfig->ptr, PduInfoPtr->SduDataPtr, IPduConfig->length);
+#ifdef COM_USE_RX_SEQLOCK
+        comSeqWriteEnd(IPduConfig->rxConfig->context);
+        ExitCritical();
+#endif
         IPduConfig->rxConfig->context->timer = IPduConfig->rxConfig->Timeout;
+#ifdef COM_USE_GATEWAY
+        comGwRxIndication(IPduConfig->rxConfig);
+#endif
         if (IPduConfig->rxConfig->RxNotification) {
           IPduConfig->rxConfig->RxNotification();
         }
@@ -568,10 +763,10 @@ void Com_MainFunctionRx(void) {
             if (0 == signal->rxConfig->context->timer) {
               switch (signal->rxConfig->RxDataTimeoutAction) {
               case COM_ACTION_REPLACE:
-                comSendSignal(signal, signal->initPtr);
+                comWriteRxSignal(signal, signal->initPtr);
                 break;
               case COM_ACTION_SUBSTITUTE:
-                comSendSignal(signal, signal->rxConfig->TimeoutSubstitutionValue);
+                comWriteRxSignal(signal, signal->rxConfig->TimeoutSubstitutionValue);
                 break;
               default:
                 break;
@@ -90,6 +90,14 @@ typedef enum
   COM_UINT8N,
 } Com_SignalTypeType;
 
+typedef struct {
+  uint16_t timer;
+#ifdef COM_USE_RX_SEQLOCK
+  /* odd while Com is updating the IPdu buffer, readers retry if it changed during the read */
+  uint32_t seq;
+#endif
+} Com_IPduRxContextType;
+
 /* @ECUC_Com_00344 */
 typedef struct {
   void *ptr;
@@ -106,20 +114,32 @@ typedef struct {
   const Com_SignalRxConfigType *rxConfig;
   const Com_SignalTxConfigType *txConfig;
 #endif
+#ifdef COM_USE_RX_SEQLOCK
+  Com_IPduRxContextType *rxContext; /* context of the Rx IPdu that holds ptr, else NULL */
+#endif
 #ifdef USE_SHELL
   char *name;
   bool isGroupSignal;
 #endif
 } Com_SignalConfigType;
 
+#ifdef COM_USE_GATEWAY
+/* signal gateway: the SrcSignal is copied to the DstSignal in the Rx indication path */
 typedef struct {
-  uint16_t timer;
-} Com_IPduRxContextType;
+  const Com_SignalConfigType *SrcSignal;
+  const Com_SignalConfigType *DstSignal;
+  PduIdType DstPduId; /* the Com Tx IPdu which contains the DstSignal */
+} Com_GwMappingType;
+#endif
 
 typedef struct {
   Com_IPduRxContextType *context;
   Com_CbkRxAckFncType RxNotification;
   Com_CbkRxTOutFncType RxTOut;
+#ifdef COM_USE_GATEWAY
+  const Com_GwMappingType *GwMappings; /* sorted by DstPduId */
+  uint16_t numOfGwMappings;
+#endif
   uint16_t FirstTimeout;
   uint16_t Timeout;
 } Com_IPduRxConfigType;
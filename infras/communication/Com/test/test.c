@@ -0,0 +1,85 @@
+/**
+ * SSAS - Simple Smart Automotive Software
+ * Copyright (C) 2021 Parai Wang <parai@foxmail.com>
+ *
+ * test of the signal gateway: the signals of the CAN0 Rx IPdus of test/config/Com.json are routed
+ * to the CAN1 Tx IPdu, referenced by bus, PDU and signal name in its "gateways" list, with the
+ * endianness changed on the way.
+ */
+/* ================================ [ INCLUDES  ] ============================================== */
+#include "Com.h"
+#include "Com_Cfg.h"
+#include "PduR_Com.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+/* ================================ [ MACROS    ] ============================================== */
+#define TEST_ASSERT(cond)                                                                          \
+  if (!(cond)) {                                                                                   \
+    printf(" FAIL at line %d: %s\n", __LINE__, #cond);                                             \
+    exit(-1);                                                                                      \
+  }
+/* ================================ [ TYPES     ] ============================================== */
+/* ================================ [ DECLARES  ] ============================================== */
+/* ================================ [ DATAS     ] ============================================== */
+static int lTxCalls = 0;
+static PduIdType lTxPduId = (PduIdType)-1;
+static uint8_t lTxData[8];
+/* ================================ [ LOCALS    ] ============================================== */
+static void receive(PduIdType RxPduId, const uint8_t *data) {
+  PduInfoType info;
+
+  info.SduDataPtr = (uint8_t *)data;
+  info.MetaDataPtr = NULL;
+  info.SduLength = 8;
+  lTxCalls = 0;
+  Com_RxIndication(RxPduId, &info);
+}
+
+static void TestRouteSignals(void) {
+  /* VehicleSpeed 0x1234 and Gear 3, both big endian */
+  const uint8_t vehicle[8] = {0x12, 0x34, 0x03, 0, 0, 0, 0, 0};
+  const uint8_t expected[8] = {0x34, 0x12, 0x03, 0, 0, 0, 0, 0};
+  printf("Test route signals:");
+  receive(COM_CAN0_RX_VEHICLE, vehicle);
+  TEST_ASSERT(1 == lTxCalls);
+  TEST_ASSERT((COM_ECUC_PDUID_OFFSET + COM_CAN1_TX_VEHICLE_GW) == lTxPduId);
+  TEST_ASSERT(0 == memcmp(expected, lTxData, sizeof(expected)));
+  printf(" PASS\n");
+}
+
+static void TestUnchangedNotTriggered(void) {
+  const uint8_t vehicle[8] = {0x12, 0x34, 0x03, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  printf("Test unchanged signals not triggered:");
+  receive(COM_CAN0_RX_VEHICLE, vehicle);
+  TEST_ASSERT(0 == lTxCalls);
+  printf(" PASS\n");
+}
+
+static void TestRouteAnotherPdu(void) {
+  const uint8_t body[8] = {0x01, 0, 0, 0, 0, 0, 0, 0};
+  const uint8_t expected[8] = {0x34, 0x12, 0x03, 0x01, 0, 0, 0, 0};
+  printf("Test route a signal of another Rx IPdu:");
+  receive(COM_CAN0_RX_BODY, body);
+  TEST_ASSERT(1 == lTxCalls);
+  TEST_ASSERT(0 == memcmp(expected, lTxData, sizeof(expected)));
+  printf(" PASS\n");
+}
+/* ================================ [ FUNCTIONS ] ============================================== */
+Std_ReturnType PduR_ComTransmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
+  lTxCalls++;
+  lTxPduId = TxPduId;
+  TEST_ASSERT(PduInfoPtr->SduLength == sizeof(lTxData));
+  memcpy(lTxData, PduInfoPtr->SduDataPtr, sizeof(lTxData));
+  return E_OK;
+}
+
+int main(int argc, char *argv[]) {
+  Com_Init(NULL);
+  Com_IpduGroupStart(COM_GROUP_ID_CAN0, TRUE);
+  Com_IpduGroupStart(COM_GROUP_ID_CAN1, TRUE);
+  TestRouteSignals();
+  TestUnchangedNotTriggered();
+  TestRouteAnotherPdu();
+  return 0;
+}
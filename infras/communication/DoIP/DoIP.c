@@ -27,6 +27,12 @@
 #define DOIP_SHORT_MSG_LOCAL_BUFFER_SIZE (DOIP_HEADER_LENGTH + 40)
 #endif
 
+/* the most read from TCP as the begin of a message, the room of the destination is not known
+ * until the target of a diagnostic message is, but any other message fits */
+#ifndef DOIP_TCP_RX_FIRST_SIZE
+#define DOIP_TCP_RX_FIRST_SIZE (DOIP_HEADER_LENGTH + 40)
+#endif
+
 /* return this when negative response buffer set */
 #define DOIP_E_NOT_OK ((Std_ReturnType)200)
 
@@ -43,6 +49,7 @@ typedef struct {
 
 typedef struct {
   DoIP_ActivationLineType ActivationLineState;
+  uint16_t TxRoundRobin; /* the tester connection to be serviced first */
 } DoIP_ContextType;
 /* ================================ [ DECLARES  ] ============================================== */
 extern const DoIP_ConfigType DoIP_Config;
@@ -583,58 +590,70 @@ doipFindTargetAddress(const DoIP_TesterType *tester, const DoIP_TesterConnection
   return TargetAddressRef;
 }
 
+static boolean doipHasAckBuffer(const DoIP_TesterConnectionType *connection) {
+  return (NULL != connection->AckBuffer) &&
+         (connection->AckBufferSize >= (DOIP_HEADER_LENGTH + 5));
+}
+
+/* the number of the request payload bytes echoed after the SA/TA and the ack code */
+static PduLengthType doipGetDiagMsgEchoSize(const DoIP_TesterConnectionType *connection) {
+  PduLengthType echoSize = 0;
+
+  if (doipHasAckBuffer(connection)) {
+    echoSize = connection->AckBufferSize - (DOIP_HEADER_LENGTH + 5);
+    if (NULL != connection->context->TesterRef) {
+      if (echoSize > connection->context->TesterRef->NumByteDiagAckNack) {
+        echoSize = connection->context->TesterRef->NumByteDiagAckNack;
+      }
+    }
+  }
+
+  return echoSize;
+}
+
 static void doipRememberDiagMsg(const DoIP_TesterConnectionType *connection, DoIP_MsgType *msg) {
+  PduLengthType echoSize = doipGetDiagMsgEchoSize(connection);
   PduLengthType bufferSize;
+
+  /* Only the first NumByteDiagAckNack bytes are kept for the ack/nack echo, the request itself is
+   * streamed through PduR_DoIPCopyRxData, so nothing is allocated or buffered per request. */
   if (DOIP_MSG_IDLE == connection->context->msg.state) {
-    bufferSize = msg->payloadLength - 4;
-    if (bufferSize > connection->context->TesterRef->NumByteDiagAckNack) {
-      bufferSize = connection->context->TesterRef->NumByteDiagAckNack;
-    }
-    bufferSize += DOIP_HEADER_LENGTH + 5; /* for header */
-    if (NULL != connection->context->msg.req) {
-      Net_MemFree(connection->context->msg.req);
-    }
-    connection->context->msg.req = Net_MemAlloc(bufferSize);
-    if (NULL != connection->context->msg.req) {
-      /* save sa&ta and uds message */
-      memcpy(&(connection->context->msg.req[DOIP_HEADER_LENGTH]), msg->req, 4);
-      memcpy(&(connection->context->msg.req[DOIP_HEADER_LENGTH + 5]), &msg->req[4],
-             msg->reqLen - 4);
+    if (doipHasAckBuffer(connection)) {
+      /* save sa&ta, the ack/nack has them even if no uds message is echoed */
+      memcpy(&connection->AckBuffer[DOIP_HEADER_LENGTH], msg->req, 4);
+    }
+    if (echoSize > 0) {
+      /* save uds message */
+      bufferSize = msg->reqLen - 4;
+      if (bufferSize > echoSize) {
+        bufferSize = echoSize;
+      }
+      memcpy(&connection->AckBuffer[DOIP_HEADER_LENGTH + 5], &msg->req[4], bufferSize);
     }
+    connection->context->msg.index = msg->reqLen - 4;
   } else {
-    if (NULL != connection->context->msg.req) {
-      if (connection->context->msg.index < connection->context->TesterRef->NumByteDiagAckNack) {
-        bufferSize =
-          connection->context->TesterRef->NumByteDiagAckNack - connection->context->msg.index;
-        if (bufferSize > msg->reqLen) {
-          bufferSize = msg->reqLen;
-        }
-        memcpy(
-          &(connection->context->msg.req[DOIP_HEADER_LENGTH + 5 + connection->context->msg.index]),
-          msg->req, bufferSize);
+    if (connection->context->msg.index < echoSize) {
+      bufferSize = echoSize - connection->context->msg.index;
+      if (bufferSize > msg->reqLen) {
+        bufferSize = msg->reqLen;
       }
+      memcpy(&connection->AckBuffer[DOIP_HEADER_LENGTH + 5 + connection->context->msg.index],
+             msg->req, bufferSize);
     }
   }
 }
 
-static void doipForgetDiagMsg(const DoIP_TesterConnectionType *connection) {
-  if (NULL != connection->context->msg.req) {
-    /* @SWS_DoIP_00138 */
-    Net_MemFree(connection->context->msg.req);
-    connection->context->msg.req = NULL;
-  }
-}
-
 static void doipReplyDiagMsg(const DoIP_TesterConnectionType *connection, DoIP_MsgType *msg,
                              uint8_t resCode) {
   PduLengthType resLen = 5;
   uint16_t payloadType = DOIP_DIAGNOSTIC_MESSAGE_POSITIVE_ACK;
-  if (NULL != connection->context->msg.req) {
+  PduLengthType echoSize = doipGetDiagMsgEchoSize(connection);
+  if (doipHasAckBuffer(connection)) {
     /* @SWS_DoIP_00138 */
-    msg->res = connection->context->msg.req;
+    msg->res = connection->AckBuffer;
     resLen = connection->context->msg.index;
-    if (resLen > connection->context->TesterRef->NumByteDiagAckNack) {
-      resLen = connection->context->TesterRef->NumByteDiagAckNack;
+    if (resLen > echoSize) {
+      resLen = echoSize;
     }
     resLen += 5;
   }
@@ -864,6 +883,30 @@ static Std_ReturnType doipTpCopyRxData(PduIdType RxPduId, DoIP_MsgType *msg, uin
   return ret;
 }
 
+/* how much SoAd may read from the socket: in the middle of a diagnostic message no more than its
+ * destination has room for, the rest stays in TCP and its flow control holds the tester back */
+static void doipTpGetRxBufferSize(const DoIP_TesterConnectionType *connection,
+                                  PduLengthType *bufferSizePtr) {
+  DoIP_MessageContextType *msg = &connection->context->msg;
+  PduLengthType left;
+  PduInfoType pduInfo;
+  BufReq_ReturnType bufReq;
+
+  if ((DOIP_MSG_RX == msg->state) && (NULL != msg->TargetAddressRef)) {
+    left = msg->TpSduLength - msg->index;
+    pduInfo.SduDataPtr = NULL;
+    pduInfo.MetaDataPtr = NULL;
+    pduInfo.SduLength = 0;
+    bufReq = PduR_DoIPCopyRxData(msg->TargetAddressRef->RxPduId, &pduInfo, bufferSizePtr);
+    if ((BUFREQ_OK != bufReq) || (*bufferSizePtr > left)) {
+      /* a broken destination is nacked when the data comes */
+      *bufferSizePtr = left;
+    }
+  } else {
+    *bufferSizePtr = DOIP_TCP_RX_FIRST_SIZE;
+  }
+}
+
 static void doipHandleInactivityTimer(void) {
   const DoIP_ConfigType *config = DOIP_CONFIG;
   const DoIP_TesterConnectionType *connection;
@@ -877,7 +920,6 @@ static void doipHandleInactivityTimer(void) {
         if (0 == connection->context->InactivityTimer) {
           ASLOG(DOIP, ("Tester SoCon %d InactivityTimer timeout\n", i));
           SoAd_CloseSoCon(connection->SoConId, TRUE);
-          doipForgetDiagMsg(connection);
           memset(connection->context, 0, sizeof(DoIP_TesterConnectionContextType));
         }
       }
@@ -933,66 +975,84 @@ static void doipHandleVehicleAnnouncement(void) {
   }
 }
 
-static void doipHandleDiagMsgResponse(void) {
-  Std_ReturnType ret = E_NOT_OK;
+static PduLengthType doipSendDiagMsgChunk(const DoIP_TesterConnectionType *connection,
+                                          uint32_t budget) {
+  Std_ReturnType ret;
   BufReq_ReturnType bret;
   PduInfoType PduInfo;
   PduLengthType left;
+  PduLengthType sent = 0;
   PduIdType TxPduId;
-  const DoIP_TargetAddressType *TargetAddressRef;
-  const DoIP_ConfigType *config = DOIP_CONFIG;
-  const DoIP_TesterConnectionType *connection = NULL;
-  int i;
-  uint8_t *res;
-  uint32_t resLen;
+  DoIP_MessageContextType *msg = &connection->context->msg;
 
-  for (i = 0; i < (NULL == connection) && (config->MaxTesterConnections); i++) {
-    connection = &config->testerConnections[i];
-    if (DOIP_CON_CLOSED != connection->context->state) {
-      TargetAddressRef = connection->context->msg.TargetAddressRef;
-      if (NULL != TargetAddressRef) {
-        if (DOIP_MSG_TX == connection->context->msg.state) {
-          TxPduId = TargetAddressRef->TxPduId;
-          connection = &config->testerConnections[i];
-          resLen = connection->context->msg.TpSduLength - connection->context->msg.index;
-          res = Net_MemGet(&resLen);
-          if (NULL != res) {
-            ret = E_OK;
-          }
-        }
-      }
+  if ((DOIP_CON_CLOSED != connection->context->state) && (NULL != msg->TargetAddressRef) &&
+      (DOIP_MSG_TX == msg->state) && (NULL != connection->TxBuffer)) {
+    TxPduId = msg->TargetAddressRef->TxPduId;
+    PduInfo.SduDataPtr = connection->TxBuffer;
+    PduInfo.MetaDataPtr = NULL;
+    PduInfo.SduLength = msg->TpSduLength - msg->index;
+    if (PduInfo.SduLength > connection->TxBufferSize) {
+      PduInfo.SduLength = connection->TxBufferSize;
     }
-  }
-
-  if (E_OK == ret) {
-    PduInfo.SduDataPtr = res;
-    PduInfo.SduLength = resLen;
-    if (PduInfo.SduLength >
-        (connection->context->msg.TpSduLength - connection->context->msg.index)) {
-      PduInfo.SduLength = connection->context->msg.TpSduLength - connection->context->msg.index;
+    if (PduInfo.SduLength > budget) {
+      PduInfo.SduLength = (PduLengthType)budget;
     }
     bret = PduR_DoIPCopyTxData(TxPduId, &PduInfo, NULL, &left);
     if (BUFREQ_OK == bret) {
       ret = doipTpSendResponse(connection->SoAdTxPdu, PduInfo.SduDataPtr, PduInfo.SduLength);
-      if (E_OK != ret) {
-        connection->context->msg.state = DOIP_MSG_IDLE;
+      if (E_OK == ret) {
+        sent = PduInfo.SduLength;
+        msg->index += PduInfo.SduLength;
+        if (msg->index >= msg->TpSduLength) {
+          msg->state = DOIP_MSG_IDLE;
+          PduR_DoIPTxConfirmation(TxPduId, E_OK);
+          ASLOG(DOIP, ("[%d] send UDS response done\n", TxPduId));
+        } else {
+          ASLOG(DOIP, ("[%d] send UDS response on going, %d/%d\n", TxPduId, msg->index,
+                       msg->TpSduLength));
+        }
+      } else {
+        msg->state = DOIP_MSG_IDLE;
         PduR_DoIPTxConfirmation(TxPduId, E_NOT_OK);
       }
+    } else if (BUFREQ_E_NOT_OK == bret) {
+      /* the upper layer gave up the response, BUFREQ_E_BUSY is retried in the next cycle */
+      ASLOG(DOIPE, ("[%d] copy UDS response failed at %d\n", TxPduId, msg->index));
+      msg->state = DOIP_MSG_IDLE;
+      PduR_DoIPTxConfirmation(TxPduId, E_NOT_OK);
     } else {
-      ret = E_NOT_OK;
+      /* busy */
     }
+  }
 
-    if (E_OK == ret) {
-      if (PduInfo.SduLength >= connection->context->msg.TpSduLength) {
-        connection->context->msg.state = DOIP_MSG_IDLE;
-        PduR_DoIPTxConfirmation(TxPduId, E_OK);
-        ASLOG(DOIP, ("[%d] send UDS response done\n", TxPduId));
-      } else {
-        ASLOG(DOIP, ("[%d] send UDS response on going\n", TxPduId));
+  return sent;
+}
+
+static void doipHandleDiagMsgResponse(void) {
+  const DoIP_ConfigType *config = DOIP_CONFIG;
+  DoIP_ContextType *context = &DoIP_Context;
+  uint32_t budget = config->TxBudgetPerCycle;
+  PduLengthType sent;
+  boolean progress = TRUE;
+  int start;
+  int index;
+  int i;
+
+  /* Pass over all tester connections one chunk each, starting after the one serviced last, until
+   * nothing is left to send or the byte budget of this cycle is spent. So parallel testers all
+   * progress each cycle and none of them can starve the others with a large response. */
+  while (progress && (budget > 0)) {
+    progress = FALSE;
+    start = context->TxRoundRobin;
+    for (i = 0; (i < config->MaxTesterConnections) && (budget > 0); i++) {
+      index = (start + i) % config->MaxTesterConnections;
+      sent = doipSendDiagMsgChunk(&config->testerConnections[index], budget);
+      if (sent > 0) {
+        budget -= sent;
+        progress = TRUE;
+        context->TxRoundRobin = (uint16_t)((index + 1) % config->MaxTesterConnections);
       }
     }
-
-    Net_MemFree(res);
   }
 }
 /* ================================ [ FUNCTIONS ] ============================================== */
@@ -1226,7 +1286,10 @@ BufReq_ReturnType DoIP_SoAdTpCopyRxData(PduIdType RxPduId, const PduInfoType *Pd
   }
 
   if (E_OK == r) {
-    if (DOIP_MSG_IDLE == connection->context->msg.state) {
+    if (0 == PduInfoPtr->SduLength) {
+      doipTpGetRxBufferSize(connection, bufferSizePtr);
+      r = DOIP_E_NOT_OK_SILENT; /* just a query, nothing to reply */
+    } else if (DOIP_MSG_IDLE == connection->context->msg.state) {
       r = doipDecodeMsg(PduInfoPtr, &msg);
       if (E_OK == r) {
         r = doipTpStartOfReception(RxPduId, &msg, &nack);
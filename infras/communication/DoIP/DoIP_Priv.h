@@ -92,7 +92,6 @@ typedef struct {
   PduLengthType TpSduLength;
   PduLengthType index;
   const DoIP_TargetAddressType *TargetAddressRef;
-  uint8_t *req; /* len = NumByteDiagAckNack */
 } DoIP_MessageContextType;
 
 typedef struct DoIP_Tester_s DoIP_TesterType;
@@ -139,6 +138,13 @@ typedef struct {
   DoIP_TesterConnectionContextType *context;
   SoAd_SoConIdType SoConId;
   PduIdType SoAdTxPdu;
+  /* persistent buffer that the pending diagnostic response is streamed through */
+  uint8_t *TxBuffer;
+  uint16_t TxBufferSize;
+  /* fixed buffer keeping SA/TA and the first request bytes for the diagnostic ack/nack echo,
+   * size = DOIP_HEADER_LENGTH + 5 + NumByteDiagAckNack */
+  uint8_t *AckBuffer;
+  uint16_t AckBufferSize;
 } DoIP_TesterConnectionType;
 
 /* @ECUC_DoIP_00031 */
@@ -226,6 +232,9 @@ struct DoIP_Config_s {
 
   const uint16_t *RxPduIdToConnectionMap;
   uint16_t numOfRxPduIds;
+
+  /* bytes of diagnostic responses sent per main cycle, shared by all tester connections */
+  uint32_t TxBudgetPerCycle;
 };
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
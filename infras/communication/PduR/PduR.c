@@ -9,6 +9,12 @@
 #include "PduR_Priv.h"
 #include "Std_Debug.h"
 #include <string.h>
+#ifdef PDUR_USE_IF_GATEWAY
+#include "Std_Critical.h"
+#ifdef USE_SHELL
+#include "shell.h"
+#endif
+#endif
 /* ================================ [ MACROS    ] ============================================== */
 #define AS_LOG_PDUR 0
 #define AS_LOG_PDURI 2
@@ -17,8 +23,246 @@
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
 /* ================================ [ LOCALS    ] ============================================== */
+#ifdef PDUR_USE_IF_GATEWAY
+static void pdurQueuePut(const PduR_QueueType *queue, const PduInfoType *PduInfoPtr) {
+  PduR_QueueContextType *context = queue->context;
+  uint16_t index;
+
+  if (PduInfoPtr->SduLength > queue->size) {
+    ASLOG(PDURE, ("IF gateway frame too long: %d > %d\n", PduInfoPtr->SduLength, queue->size));
+    context->stats.numOfOverflow++;
+    return;
+  }
+
+  if (context->count >= queue->depth) {
+    context->stats.numOfOverflow++;
+    switch (queue->policy) {
+    case PDUR_QUEUE_DROP_OLDEST:
+      context->head = (context->head + 1) % queue->depth;
+      context->count--;
+      break;
+    case PDUR_QUEUE_FLUSH:
+      context->count = 0;
+      break;
+    default:
+      return;
+    }
+  }
+
+  index = (context->head + context->count) % queue->depth;
+  memcpy(&queue->data[index * queue->size], PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
+  queue->lengths[index] = PduInfoPtr->SduLength;
+  context->count++;
+  context->stats.numOfQueued++;
+  if (context->count > context->stats.maxCount) {
+    context->stats.maxCount = context->count;
+  }
+}
+
+/* transmit the oldest queued frame, must be called with the critical section entered. The
+ * generator allows only one destination for an IF gateway path. */
+static void pdurQueueTransmit(const PduR_RoutingPathType *RoutingPath) {
+  const PduR_QueueType *queue = RoutingPath->DestTxQueueRef;
+  const PduR_PduType *DestPduRef = &RoutingPath->DestPduRef[0];
+  PduR_QueueContextType *context = queue->context;
+  PduInfoType PduInfo;
+  Std_ReturnType ret;
+
+  if ((PDUR_QUEUE_IDLE == context->state) && (context->count > 0)) {
+    PduInfo.SduDataPtr = &queue->data[context->head * queue->size];
+    PduInfo.SduLength = queue->lengths[context->head];
+    PduInfo.MetaDataPtr = NULL;
+    context->state = PDUR_QUEUE_IN_FLIGHT;
+    context->timer = queue->timeout;
+    ret = DestPduRef->api->Transmit(DestPduRef->PduHandleId, &PduInfo);
+    if (E_OK == ret) {
+      context->head = (context->head + 1) % queue->depth;
+      context->count--;
+    } else {
+      context->state = PDUR_QUEUE_IDLE;
+    }
+  }
+}
+
+#ifdef USE_SHELL
+static int cmdPduRGwFunc(int argc, const char *argv[]) {
+  const PduR_ConfigType *config = PDUR_CONFIG;
+  const PduR_QueueType *queue;
+  uint16_t i;
+
+  for (i = 0; i < config->numOfRoutingPaths; i++) {
+    queue = config->RoutingPaths[i].DestTxQueueRef;
+    if (NULL != queue) {
+      PRINTF("%d: depth %d count %d max %d, direct %u queued %u overflow %u timeout %u late %u\n",
+             i, queue->depth, queue->context->count, queue->context->stats.maxCount,
+             queue->context->stats.numOfDirect, queue->context->stats.numOfQueued,
+             queue->context->stats.numOfOverflow, queue->context->stats.numOfTimeout,
+             queue->context->stats.numOfLate);
+    }
+  }
+  return 0;
+}
+SHELL_REGISTER(pdurgw, "pdurgw - show the FIFO statistics of the IF gateway\n", cmdPduRGwFunc);
+#endif
+#endif
+#ifdef PDUR_USE_TP_CUT_THROUGH
+static Std_ReturnType pdurCutThroughTransmit(const PduR_RoutingPathType *RoutingPath) {
+  PduR_BufferType *buffer = RoutingPath->DestTxBufferRef;
+  const PduR_PduType *DestPduRef = &RoutingPath->DestPduRef[0];
+  PduInfoType PduInfo;
+  Std_ReturnType ret = E_NOT_OK;
+
+  if (NULL != DestPduRef->api->Transmit) {
+    /* only the length matters, the data is pulled by the destination through CopyTxData */
+    PduInfo.SduDataPtr = buffer->data;
+    PduInfo.SduLength = buffer->TpSduLength;
+    PduInfo.MetaDataPtr = NULL;
+    ret = DestPduRef->api->Transmit(DestPduRef->PduHandleId, &PduInfo);
+  } else {
+    ASLOG(PDURE, ("null Transmit\n"));
+  }
+
+  return ret;
+}
+
+static BufReq_ReturnType pdurCutThroughStartOfReception(PduR_BufferType *buffer,
+                                                        PduLengthType TpSduLength,
+                                                        PduLengthType *bufferSizePtr) {
+  BufReq_ReturnType ret = BUFREQ_E_NOT_OK;
+  PduLengthType size = buffer->ringSize;
+
+  if (size > TpSduLength) {
+    size = TpSduLength;
+  }
+  buffer->data = PduR_MemAlloc(size);
+  if (NULL != buffer->data) {
+    buffer->size = size;
+    buffer->index = 0;
+    buffer->TpSduLength = TpSduLength;
+    buffer->rxIndex = 0;
+    buffer->txIndex = 0;
+    buffer->state = PDUR_GW_RX;
+    *bufferSizePtr = size;
+    ret = BUFREQ_OK;
+  }
+
+  return ret;
+}
+
+static BufReq_ReturnType pdurCutThroughCopyRxData(const PduR_RoutingPathType *RoutingPath,
+                                                  const PduInfoType *info,
+                                                  PduLengthType *bufferSizePtr) {
+  PduR_BufferType *buffer = RoutingPath->DestTxBufferRef;
+  BufReq_ReturnType ret = BUFREQ_E_NOT_OK;
+  PduLengthType offset;
+  PduLengthType len;
+
+  if ((PDUR_GW_RX == buffer->state) || (PDUR_GW_STREAMING == buffer->state)) {
+    if ((info->SduLength <= (buffer->size - (buffer->rxIndex - buffer->txIndex))) &&
+        (info->SduLength <= (buffer->TpSduLength - buffer->rxIndex))) {
+      if (info->SduLength > 0) {
+        offset = buffer->rxIndex % buffer->size;
+        len = buffer->size - offset;
+        if (len > info->SduLength) {
+          len = info->SduLength;
+        }
+        memcpy(&buffer->data[offset], info->SduDataPtr, len);
+        memcpy(buffer->data, &info->SduDataPtr[len], info->SduLength - len);
+        buffer->rxIndex += info->SduLength;
+      }
+      ret = BUFREQ_OK;
+      if ((PDUR_GW_RX == buffer->state) && (buffer->rxIndex >= buffer->threshold) &&
+          (buffer->rxIndex < buffer->TpSduLength)) {
+        buffer->state = PDUR_GW_STREAMING;
+        if (E_OK != pdurCutThroughTransmit(RoutingPath)) {
+          buffer->state = PDUR_GW_RX;
+          ret = BUFREQ_E_NOT_OK;
+        }
+      }
+    } else {
+      ASLOG(PDURE, ("Ring Overflow: %d > %d\n", info->SduLength,
+                    buffer->size - (buffer->rxIndex - buffer->txIndex)));
+      ret = BUFREQ_E_OVFL;
+    }
+    /* the free room of the ring, the source paces itself with it: CanTp by the BS or a FC.WAIT
+     * and DoIP by leaving the data in the TCP socket. A CopyRxData of length 0 just asks for it */
+    *bufferSizePtr = buffer->size - (buffer->rxIndex - buffer->txIndex);
+  }
+
+  return ret;
+}
+
+static BufReq_ReturnType pdurCutThroughCopyTxData(PduR_BufferType *buffer, const PduInfoType *info,
+                                                  PduLengthType *availableDataPtr) {
+  BufReq_ReturnType ret = BUFREQ_E_NOT_OK;
+  PduLengthType offset;
+  PduLengthType len;
+
+  if ((PDUR_GW_STREAMING == buffer->state) || (PDUR_GW_RX_DONE == buffer->state)) {
+    if (info->SduLength <= (buffer->rxIndex - buffer->txIndex)) {
+      offset = buffer->txIndex % buffer->size;
+      len = buffer->size - offset;
+      if (len > info->SduLength) {
+        len = info->SduLength;
+      }
+      memcpy(info->SduDataPtr, &buffer->data[offset], len);
+      memcpy(&info->SduDataPtr[len], buffer->data, info->SduLength - len);
+      buffer->txIndex += info->SduLength;
+      *availableDataPtr = buffer->rxIndex - buffer->txIndex;
+      ret = BUFREQ_OK;
+    } else {
+      /* the source is slower than the destination, let it try again later */
+      ret = BUFREQ_E_BUSY;
+    }
+  }
+
+  return ret;
+}
+
+static void pdurCutThroughRxIndication(const PduR_RoutingPathType *RoutingPath,
+                                       Std_ReturnType result) {
+  PduR_BufferType *buffer = RoutingPath->DestTxBufferRef;
+  Std_ReturnType ret = E_OK;
+
+  if (PDUR_GW_RX == buffer->state) {
+    if (E_OK == result) {
+      /* the whole message fits within the threshold, transmit it as store and forward */
+      buffer->state = PDUR_GW_RX_DONE;
+      ret = pdurCutThroughTransmit(RoutingPath);
+    } else {
+      ret = E_NOT_OK;
+    }
+  } else if (PDUR_GW_STREAMING == buffer->state) {
+    if (E_OK == result) {
+      buffer->state = PDUR_GW_RX_DONE;
+    } else {
+      /* the buffer is released on the Tx confirmation of the aborted transmission */
+      buffer->state = PDUR_GW_ABORTED;
+    }
+  } else {
+    /* do nothing */
+  }
+
+  if (E_OK != ret) {
+    PduR_MemFree(buffer->data);
+    buffer->data = NULL;
+  }
+}
+#endif
 /* ================================ [ FUNCTIONS ] ============================================== */
 void PduR_Init(const PduR_ConfigType *ConfigPtr) {
+#ifdef PDUR_USE_IF_GATEWAY
+  const PduR_ConfigType *config = PDUR_CONFIG;
+  const PduR_QueueType *queue;
+  uint16_t i;
+
+  for (i = 0; i < config->numOfRoutingPaths; i++) {
+    queue = config->RoutingPaths[i].DestTxQueueRef;
+    if (NULL != queue) {
+      memset(queue->context, 0, sizeof(PduR_QueueContextType));
+    }
+  }
+#endif
 #if defined(PDUR_USE_MEMPOOL)
   PduR_MemInit();
 #endif
@@ -81,6 +325,13 @@ void PduR_RxIndication(PduIdType pathId, const PduInfoType *PduInfoPtr) {
   uint16_t i;
 
   ASLOG(PDUR, ("%s %d\n", __func__, pathId));
+#ifdef PDUR_USE_IF_GATEWAY
+  if ((pathId < config->numOfRoutingPaths) &&
+      (NULL != config->RoutingPaths[pathId].DestTxQueueRef)) {
+    PduR_GwIfRxIndication(pathId, PduInfoPtr);
+    return;
+  }
+#endif
   if (pathId < config->numOfRoutingPaths) {
     for (i = 0; i < config->RoutingPaths[pathId].numOfDestPdus; i++) {
       DestPduRef = &config->RoutingPaths[pathId].DestPduRef[i];
@@ -132,6 +383,12 @@ void PduR_TxConfirmation(PduIdType pathId, Std_ReturnType result) {
   ASLOG(PDUR, ("%s %d\n", __func__, pathId));
   if (pathId < config->numOfRoutingPaths) {
     RoutingPath = &config->RoutingPaths[pathId];
+#ifdef PDUR_USE_IF_GATEWAY
+    if (NULL != RoutingPath->DestTxQueueRef) {
+      PduR_GwIfTxConfirmation(pathId, result);
+      return;
+    }
+#endif
     if (NULL != RoutingPath->DestTxBufferRef) {
       PduHandleId = pathId;
     } else {
@@ -228,15 +485,110 @@ BufReq_ReturnType PduR_GwCopyTxData(PduIdType pathId, const PduInfoType *info,
       (NULL != config->RoutingPaths[pathId].DestTxBufferRef)) {
     buffer = config->RoutingPaths[pathId].DestTxBufferRef;
     if (NULL != buffer->data) {
-      memcpy(info->SduDataPtr, &buffer->data[buffer->index], info->SduLength);
-      buffer->index += info->SduLength;
-      *availableDataPtr = buffer->size - buffer->index;
-      ret = BUFREQ_OK;
+#ifdef PDUR_USE_TP_CUT_THROUGH
+      if (buffer->threshold > 0) {
+        ret = pdurCutThroughCopyTxData(buffer, info, availableDataPtr);
+      } else
+#endif
+      {
+        memcpy(info->SduDataPtr, &buffer->data[buffer->index], info->SduLength);
+        buffer->index += info->SduLength;
+        *availableDataPtr = buffer->size - buffer->index;
+        ret = BUFREQ_OK;
+      }
     }
   }
   return ret;
 }
 
+#ifdef PDUR_USE_IF_GATEWAY
+void PduR_GwIfRxIndication(PduIdType pathId, const PduInfoType *PduInfoPtr) {
+  const PduR_RoutingPathType *RoutingPath = &PDUR_CONFIG->RoutingPaths[pathId];
+  const PduR_QueueType *queue = RoutingPath->DestTxQueueRef;
+  const PduR_PduType *DestPduRef = &RoutingPath->DestPduRef[0];
+  PduR_QueueContextType *context = queue->context;
+  Std_ReturnType ret = E_NOT_OK;
+
+  ASLOG(PDUR, ("%s %d\n", __func__, pathId));
+  EnterCritical();
+  if ((PDUR_QUEUE_IDLE == context->state) && (0 == context->count)) {
+    context->state = PDUR_QUEUE_IN_FLIGHT;
+    context->timer = queue->timeout;
+    ret = DestPduRef->api->Transmit(DestPduRef->PduHandleId, PduInfoPtr);
+    if (E_OK == ret) {
+      context->stats.numOfDirect++;
+    } else {
+      context->state = PDUR_QUEUE_IDLE;
+    }
+  }
+  if (E_OK != ret) {
+    /* the destination is busy or frames are pending, keep the order */
+    pdurQueuePut(queue, PduInfoPtr);
+    pdurQueueTransmit(RoutingPath);
+  }
+  ExitCritical();
+}
+
+void PduR_GwIfTxConfirmation(PduIdType pathId, Std_ReturnType result) {
+  const PduR_RoutingPathType *RoutingPath = &PDUR_CONFIG->RoutingPaths[pathId];
+  PduR_QueueContextType *context = RoutingPath->DestTxQueueRef->context;
+
+  ASLOG(PDUR, ("%s %d %d\n", __func__, pathId, result));
+  EnterCritical();
+  if (PDUR_QUEUE_IN_FLIGHT == context->state) {
+    context->state = PDUR_QUEUE_IDLE;
+    pdurQueueTransmit(RoutingPath);
+  } else if (PDUR_QUEUE_LOST == context->state) {
+    /* the late one of the timed out frame, nothing else was transmitted since */
+    context->stats.numOfLate++;
+    context->state = PDUR_QUEUE_IDLE;
+    pdurQueueTransmit(RoutingPath);
+  } else {
+    ASLOG(PDURE, ("IF gateway path %d unexpected Tx confirmation\n", pathId));
+  }
+  ExitCritical();
+}
+
+#endif
+
+void PduR_MainFunction(void) {
+#ifdef PDUR_USE_IF_GATEWAY
+  const PduR_ConfigType *config = PDUR_CONFIG;
+  const PduR_RoutingPathType *RoutingPath;
+  PduR_QueueContextType *context;
+  uint16_t i;
+
+  /* release the paths whose Tx confirmation was lost, such as the frame being aborted by a bus
+   * off, one timeout after the Tx confirmation timeout, and retry the FIFOs whose destination
+   * rejected the last transmit request */
+  for (i = 0; i < config->numOfRoutingPaths; i++) {
+    RoutingPath = &config->RoutingPaths[i];
+    if (NULL != RoutingPath->DestTxQueueRef) {
+      context = RoutingPath->DestTxQueueRef->context;
+      EnterCritical();
+      if (PDUR_QUEUE_IDLE != context->state) {
+        if (context->timer > 0) {
+          context->timer--;
+        }
+        if (0 == context->timer) {
+          if (PDUR_QUEUE_IN_FLIGHT == context->state) {
+            ASLOG(PDURE, ("IF gateway path %d Tx confirmation timeout\n", i));
+            context->stats.numOfTimeout++;
+            context->state = PDUR_QUEUE_LOST;
+            context->timer = RoutingPath->DestTxQueueRef->timeout;
+          } else {
+            /* the destination dropped the frame, no confirmation can be mistaken any more */
+            context->state = PDUR_QUEUE_IDLE;
+          }
+        }
+      }
+      pdurQueueTransmit(RoutingPath);
+      ExitCritical();
+    }
+  }
+#endif
+}
+
 #if defined(PDUR_USE_MEMPOOL)
 void PduR_GwTxConfirmation(PduIdType pathId, Std_ReturnType result) {
   const PduR_ConfigType *config = PDUR_CONFIG;
@@ -263,15 +615,24 @@ BufReq_ReturnType PduR_GwStartOfReception(PduIdType pathId, const PduInfoType *i
   if ((pathId < config->numOfRoutingPaths) &&
       (NULL != config->RoutingPaths[pathId].DestTxBufferRef)) {
     buffer = config->RoutingPaths[pathId].DestTxBufferRef;
-    if (buffer->data != NULL) {
-      PduR_MemFree(buffer->data);
-    }
-    buffer->data = PduR_MemAlloc(TpSduLength);
     if (NULL != buffer->data) {
-      buffer->size = TpSduLength;
-      buffer->index = 0;
-      *bufferSizePtr = TpSduLength;
-      ret = BUFREQ_OK;
+      /* the last message is still received or read by the destination, the buffer is freed by
+       * the RxIndication of a failed reception or by the Tx confirmation */
+      ASLOG(PDURE, ("[%d] gateway busy, reject the reception\n", pathId));
+    } else
+#ifdef PDUR_USE_TP_CUT_THROUGH
+      if (buffer->threshold > 0) {
+      ret = pdurCutThroughStartOfReception(buffer, TpSduLength, bufferSizePtr);
+    } else
+#endif
+    {
+      buffer->data = PduR_MemAlloc(TpSduLength);
+      if (NULL != buffer->data) {
+        buffer->size = TpSduLength;
+        buffer->index = 0;
+        *bufferSizePtr = TpSduLength;
+        ret = BUFREQ_OK;
+      }
     }
   }
   return ret;
@@ -288,14 +649,22 @@ BufReq_ReturnType PduR_GwCopyRxData(PduIdType pathId, const PduInfoType *info,
       (NULL != config->RoutingPaths[pathId].DestTxBufferRef)) {
     buffer = config->RoutingPaths[pathId].DestTxBufferRef;
     if (NULL != buffer->data) {
-      if ((buffer->index < buffer->size) && (info->SduLength <= (buffer->size - buffer->index))) {
-        memcpy(&buffer->data[buffer->index], info->SduDataPtr, info->SduLength);
-        buffer->index += info->SduLength;
-        *bufferSizePtr = buffer->size - buffer->index;
-        ret = BUFREQ_OK;
-      } else {
-        ASLOG(PDURE, ("Buffer Overflow\n"));
-        ret = BUFREQ_E_OVFL;
+#ifdef PDUR_USE_TP_CUT_THROUGH
+      if (buffer->threshold > 0) {
+        ret = pdurCutThroughCopyRxData(&config->RoutingPaths[pathId], info, bufferSizePtr);
+      } else
+#endif
+      {
+        if ((buffer->index < buffer->size) &&
+            (info->SduLength <= (buffer->size - buffer->index))) {
+          memcpy(&buffer->data[buffer->index], info->SduDataPtr, info->SduLength);
+          buffer->index += info->SduLength;
+          *bufferSizePtr = buffer->size - buffer->index;
+          ret = BUFREQ_OK;
+        } else {
+          ASLOG(PDURE, ("Buffer Overflow\n"));
+          ret = BUFREQ_E_OVFL;
+        }
       }
     }
   }
@@ -314,15 +683,25 @@ void PduR_GwRxIndication(PduIdType pathId, Std_ReturnType result) {
       (NULL != config->RoutingPaths[pathId].DestTxBufferRef)) {
     DestPduRef = &config->RoutingPaths[pathId].DestPduRef[0];
     buffer = config->RoutingPaths[pathId].DestTxBufferRef;
-    if ((E_OK == result) && (NULL != buffer->data)) {
-      if (NULL != DestPduRef->api->Transmit) {
-        PduInfo.SduDataPtr = buffer->data;
-        PduInfo.SduLength = buffer->size;
-        PduInfo.MetaDataPtr = NULL;
-        buffer->index = 0;
-        ret = DestPduRef->api->Transmit(DestPduRef->PduHandleId, &PduInfo);
-      } else {
-        ASLOG(PDURE, ("null Transmit\n"));
+#ifdef PDUR_USE_TP_CUT_THROUGH
+    if (buffer->threshold > 0) {
+      if (NULL != buffer->data) {
+        pdurCutThroughRxIndication(&config->RoutingPaths[pathId], result);
+      }
+      ret = E_OK; /* the buffer is managed by the cut-through state machine */
+    } else
+#endif
+    {
+      if ((E_OK == result) && (NULL != buffer->data)) {
+        if (NULL != DestPduRef->api->Transmit) {
+          PduInfo.SduDataPtr = buffer->data;
+          PduInfo.SduLength = buffer->size;
+          PduInfo.MetaDataPtr = NULL;
+          buffer->index = 0;
+          ret = DestPduRef->api->Transmit(DestPduRef->PduHandleId, &PduInfo);
+        } else {
+          ASLOG(PDURE, ("null Transmit\n"));
+        }
       }
     }
     if (E_NOT_OK == ret) {
@@ -14,6 +14,10 @@
 #endif
 /* ================================ [ MACROS    ] ============================================== */
 #define PDUR_CONFIG (&PduR_Config)
+
+#if defined(PDUR_USE_TP_CUT_THROUGH) && !defined(PDUR_USE_MEMPOOL)
+#error "the cut-through TP gateway allocates its ring from the PduR memory pool"
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 typedef enum {
   PDUR_MODULE_CANIF,
@@ -57,18 +61,85 @@ typedef struct {
   const PduR_ApiType *api;
 } PduR_PduType;
 
+#ifdef PDUR_USE_TP_CUT_THROUGH
+typedef enum {
+  PDUR_GW_RX,        /* receiving, the transmission is not started yet */
+  PDUR_GW_STREAMING, /* receiving and transmitting */
+  PDUR_GW_RX_DONE,   /* reception completed, transmitting */
+  PDUR_GW_ABORTED,   /* reception failed, waiting the transmission to be aborted */
+} PduR_GwStateType;
+#endif
+
 typedef struct {
   uint8_t *data;
   PduLengthType size;
   PduLengthType index;
+#ifdef PDUR_USE_TP_CUT_THROUGH
+  /* start the transmission once threshold bytes are received and stream the message through a
+   * ring of ringSize bytes, threshold 0 means store and forward */
+  PduLengthType threshold;
+  PduLengthType ringSize;
+  PduLengthType TpSduLength;
+  PduLengthType rxIndex; /* bytes received */
+  PduLengthType txIndex; /* bytes transmitted */
+  PduR_GwStateType state;
+#endif
 } PduR_BufferType;
 
+#ifdef PDUR_USE_IF_GATEWAY
+/* what to do when a frame is received while the FIFO of the IF gateway is full */
+typedef enum {
+  PDUR_QUEUE_DROP_NEWEST, /* discard the received frame */
+  PDUR_QUEUE_DROP_OLDEST, /* discard the oldest queued frame */
+  PDUR_QUEUE_FLUSH,       /* flush the FIFO, then queue the received frame */
+} PduR_QueueOverflowPolicyType;
+
+/* the Tx confirmation carries no frame identity, so the timed out frame stays tagged as lost for
+ * one more timeout, a confirmation seen meanwhile is its late one and not the next frame's */
+typedef enum {
+  PDUR_QUEUE_IDLE,      /* nothing in transmission */
+  PDUR_QUEUE_IN_FLIGHT, /* waiting the Tx confirmation of the transmitted frame */
+  PDUR_QUEUE_LOST,      /* the Tx confirmation timed out, waiting a late one before the next */
+} PduR_QueueStateType;
+
+typedef struct {
+  uint32_t numOfDirect;   /* frames transmitted at reception without being queued */
+  uint32_t numOfQueued;   /* frames queued as the destination was busy */
+  uint32_t numOfOverflow; /* frames lost as the FIFO was full or the frame was too long */
+  uint32_t numOfTimeout;  /* Tx confirmations which never came */
+  uint32_t numOfLate;     /* Tx confirmations which came after the timeout */
+  uint16_t maxCount;      /* high-water mark of the FIFO */
+} PduR_QueueStatisticsType;
+
+typedef struct {
+  PduR_QueueStatisticsType stats;
+  uint16_t head;
+  uint16_t count;
+  uint16_t timer; /* main cycles left in the in flight or lost state */
+  PduR_QueueStateType state;
+} PduR_QueueContextType;
+
+/* FIFO of an IF gateway routing path */
+typedef struct {
+  PduR_QueueContextType *context;
+  uint8_t *data;          /* depth * size bytes */
+  PduLengthType *lengths; /* depth */
+  PduLengthType size;     /* maximum length of each queued frame */
+  uint16_t depth;
+  uint16_t timeout; /* main cycles to wait the Tx confirmation */
+  PduR_QueueOverflowPolicyType policy;
+} PduR_QueueType;
+#endif
+
 /* @ECUC_PduR_00248 */
 typedef struct {
   const PduR_PduType *SrcPduRef;
   const PduR_PduType *DestPduRef; /* @ECUC_PduR_00354 */
   uint16_t numOfDestPdus;
   PduR_BufferType *DestTxBufferRef; /* @ECUC_PduR_00304 */
+#ifdef PDUR_USE_IF_GATEWAY
+  const PduR_QueueType *DestTxQueueRef;
+#endif
 } PduR_RoutingPathType;
 
 struct PduR_Config_s {
@@ -194,6 +265,11 @@ BufReq_ReturnType PduR_LinTpGwCopyRxData(PduIdType id, const PduInfoType *info,
                                          PduLengthType *bufferSizePtr);
 void PduR_LinTpGwRxIndication(PduIdType id, Std_ReturnType result);
 
+#ifdef PDUR_USE_IF_GATEWAY
+void PduR_GwIfRxIndication(PduIdType pathId, const PduInfoType *PduInfoPtr);
+void PduR_GwIfTxConfirmation(PduIdType pathId, Std_ReturnType result);
+#endif
+
 void PduR_MemInit(void);
 uint8_t *PduR_MemAlloc(uint32_t size);
 uint8_t *PduR_MemGet(uint32_t *size);
@@ -102,10 +102,36 @@
 #define PCAP_TRACE(data, length, RemoteAddr, isRx)
 #endif
 
+#if (defined(_WIN32) || defined(linux)) && !defined(USE_LWIP)
+/* NOTE: this is a workaroud for case that server and client on the same host, the subscribe and
+ * its ack are sent by multicast */
+#define SD_USE_MULTICAST_FOR_UNICAST
+#endif
+
+/* IPv4 endpoint and multicast options */
+#define SD_OPTION_SIZE 12
+#ifndef SD_MAX_OPTIONS
+#define SD_MAX_OPTIONS 32
+#endif
+
+/* entries in one message, their pending flags are restored if the message is not sent */
+#ifndef SD_MSG_MAX_ENTRIES
+#define SD_MSG_MAX_ENTRIES 32
+#endif
+
 #ifndef SD_EVENT_HANDLER_SUBSCRIBER_POOL_SIZE
 #define SD_EVENT_HANDLER_SUBSCRIBER_POOL_SIZE 32
 #endif
 
+/* buckets of the subscriber hash, must be power of 2 */
+#ifndef SD_SUBSCRIBER_HASH_SIZE
+#define SD_SUBSCRIBER_HASH_SIZE 64
+#endif
+
+#define SD_ANY_INSTANCE_ID 0xFFFFu
+
+#define SD_SERVICE_KEY(serviceId, instanceId) (((uint32_t)(serviceId) << 16) | (instanceId))
+
 /* SQP: SD Queue and Pool */
 #define DEF_SQP(T, size)                                                                           \
   static Sd_##T##Type sd##T##Slots[size];                                                          \
@@ -242,6 +268,21 @@ typedef struct {
   TcpIp_ProtocolType ProtocolType;
   TcpIp_SockAddrType Addr;
 } Sd_OptionIPv4Type;
+
+/* the SD message being packed in the buffer of the instance, the options are kept aside in
+ * sdOptionBuffer until the message is sent as they follow all the entries */
+typedef struct {
+  TcpIp_SockAddrType RemoteAddr;
+  /* the flags and the pending bits each entry of the message was built from */
+  uint8_t *pendingFlags[SD_MSG_MAX_ENTRIES];
+  uint8_t pendingMasks[SD_MSG_MAX_ENTRIES];
+  uint32_t lengthOfEntries;
+  uint16_t numOfEntriesTotal;
+  PduIdType TxPduId;
+  uint8_t numOfOptions;
+  boolean isMulticast;
+  boolean failed; /* a message was not sent */
+} Sd_MsgType;
 /* ================================ [ DECLARES  ] ============================================== */
 extern const Sd_ConfigType Sd_Config;
 
@@ -252,9 +293,115 @@ extern Std_ReturnType SomeIp_ResolveSubscriber(uint16_t ServiceId,
                                                Sd_EventHandlerSubscriberType *sub);
 /* ================================ [ DATAS     ] ============================================== */
 DEF_SQP(EventHandlerSubscriber, SD_EVENT_HANDLER_SUBSCRIBER_POOL_SIZE)
+/* all the subscribers in the event handler lists, keyed by HandleId and RemoteAddr */
+static Sd_EventHandlerSubscriberType *sdSubscriberHash[SD_SUBSCRIBER_HASH_SIZE];
+static uint8_t sdOptionBuffer[SD_OPTION_SIZE * SD_MAX_OPTIONS];
 
 static const Sd_ConfigType *sdConfigPtr = NULL;
 /* ================================ [ LOCALS    ] ============================================== */
+/* binary search the generated index for the first one whose key matches under mask */
+static Std_ReturnType Sd_IndexLookup(const Sd_IndexType *index, uint16_t num, uint32_t key,
+                                     uint32_t mask, uint16_t *pos) {
+  Std_ReturnType ret = E_NOT_OK;
+  uint16_t low = 0;
+  uint16_t high = num;
+  uint16_t mid;
+
+  key &= mask;
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    if ((index[mid].key & mask) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  if ((low < num) && ((index[low].key & mask) == key)) {
+    *pos = index[low].index;
+    ret = E_OK;
+  }
+
+  return ret;
+}
+
+static const Sd_ServerServiceType *Sd_LookupServerService(const Sd_InstanceType *Instance,
+                                                          uint16_t serviceId,
+                                                          uint16_t instanceId) {
+  const Sd_ServerServiceType *config = NULL;
+  uint32_t mask = 0xFFFFFFFFu;
+  uint16_t pos;
+
+  if (SD_ANY_INSTANCE_ID == instanceId) {
+    mask = 0xFFFF0000u;
+  }
+
+  if (E_OK == Sd_IndexLookup(Instance->ServerServicesIndex, Instance->numOfServerServices,
+                             SD_SERVICE_KEY(serviceId, instanceId), mask, &pos)) {
+    config = &Instance->ServerServices[pos];
+  }
+
+  return config;
+}
+
+static const Sd_ClientServiceType *Sd_LookupClientService(const Sd_InstanceType *Instance,
+                                                          uint16_t serviceId,
+                                                          uint16_t instanceId) {
+  const Sd_ClientServiceType *config = NULL;
+  uint16_t pos;
+
+  if (E_OK == Sd_IndexLookup(Instance->ClientServicesIndex, Instance->numOfClientServices,
+                             SD_SERVICE_KEY(serviceId, instanceId), 0xFFFFFFFFu, &pos)) {
+    config = &Instance->ClientServices[pos];
+  }
+
+  return config;
+}
+
+static uint16_t Sd_SubscriberHash(uint16_t HandleId, const TcpIp_SockAddrType *RemoteAddr) {
+  uint32_t hash = HandleId;
+
+  hash = hash * 31u + RemoteAddr->addr[0];
+  hash = hash * 31u + RemoteAddr->addr[1];
+  hash = hash * 31u + RemoteAddr->addr[2];
+  hash = hash * 31u + RemoteAddr->addr[3];
+  hash = hash * 31u + RemoteAddr->port;
+
+  return (uint16_t)(hash & (SD_SUBSCRIBER_HASH_SIZE - 1));
+}
+
+static void Sd_SubscriberHashAdd(const Sd_EventHandlerType *EventHandler,
+                                 Sd_EventHandlerSubscriberType *sub) {
+  uint16_t hash = Sd_SubscriberHash(EventHandler->HandleId, &sub->RemoteAddr);
+
+  sub->HandleId = EventHandler->HandleId;
+  EnterCritical();
+  sub->hnext = sdSubscriberHash[hash];
+  sdSubscriberHash[hash] = sub;
+  ExitCritical();
+}
+
+static void Sd_SubscriberHashRemove(Sd_EventHandlerSubscriberType *sub) {
+  Sd_EventHandlerSubscriberType **pp;
+
+  EnterCritical();
+  pp = &sdSubscriberHash[Sd_SubscriberHash(sub->HandleId, &sub->RemoteAddr)];
+  while ((NULL != *pp) && (*pp != sub)) {
+    pp = &(*pp)->hnext;
+  }
+  if (NULL != *pp) {
+    *pp = sub->hnext;
+  }
+  ExitCritical();
+}
+
+/* remove the subscriber from both the event handler list and the hash and free it */
+#define SD_SUB_CRM_AND_FREE(var)                                                                   \
+  do {                                                                                             \
+    Sd_SubscriberHashRemove(var);                                                                  \
+    SQP_CRM_AND_FREE(EventHandlerSubscriber, var);                                                 \
+  } while (0)
+
 static uint16_t Sd_RandTime(uint16_t min, uint16_t max) {
   uint16_t ret;
   int range = max - min + 1;
@@ -616,18 +763,14 @@ static Std_ReturnType Sd_HandleFindService(const Sd_InstanceType *Instance,
                                            const Sd_HeaderType *header,
                                            const Sd_EntryType1Type *entry1) {
   Std_ReturnType ret = E_NOT_OK;
-  uint16_t i;
   TcpIp_SockAddrType LocalAddr;
   const Sd_ServerServiceType *config;
   Sd_ServerServiceContextType *context;
 
-  for (i = 0; i < Instance->numOfServerServices; i++) {
-    config = &Instance->ServerServices[i];
+  config = Sd_LookupServerService(Instance, entry1->serviceId, entry1->instanceId);
+  if (NULL != config) {
     context = config->context;
-    if ((config->ServiceId == entry1->serviceId) || (config->InstanceId == entry1->instanceId)) {
-      ret = E_OK;
-      break;
-    }
+    ret = E_OK;
   }
 
   if (E_OK == ret) {
@@ -678,17 +821,13 @@ static Std_ReturnType Sd_HandleOfferService(const Sd_InstanceType *Instance,
                                             const Sd_EntryType1Type *entry1,
                                             const Sd_OptionIPv4Type *ipv4Opt) {
   Std_ReturnType ret = E_NOT_OK;
-  uint16_t i;
-
   const Sd_ClientServiceType *config;
   Sd_ClientServiceContextType *context;
-  for (i = 0; i < Instance->numOfClientServices; i++) {
-    config = &Instance->ClientServices[i];
+
+  config = Sd_LookupClientService(Instance, entry1->serviceId, entry1->instanceId);
+  if (NULL != config) {
     context = config->context;
-    if ((config->ServiceId == entry1->serviceId) || (config->InstanceId == entry1->instanceId)) {
-      ret = E_OK;
-      break;
-    }
+    ret = E_OK;
   }
 
   if (E_OK == ret) {
@@ -766,35 +905,125 @@ static Std_ReturnType Sd_HandleOfferService(const Sd_InstanceType *Instance,
   return ret;
 }
 
-static Std_ReturnType Sd_ResponseSubscribeEventGroup(const Sd_InstanceType *Instance,
-                                                     const Sd_ServerServiceType *config,
-                                                     const Sd_EventHandlerType *EventHandler,
-                                                     Sd_EventHandlerSubscriberType *sub) {
-  uint32_t lengthOfOptions = 0;
-  Sd_BuildEntryType2(&Instance->buffer[24], SD_SUBSCRIBE_EVENT_GROUP_ACK, 0, 0, 1, 0,
-                     config->ServiceId, config->InstanceId, config->MajorVersion, 0,
-                     EventHandler->EventGroupId, config->ServerTimer->TTL);
-  if (sub->TxPduId == EventHandler->MulticastTxPduId) {
-    Sd_BuildOptionIPv4Multicast(&Instance->buffer[44], &EventHandler->MulticastEventAddr,
-                                TCPIP_IPPROTO_UDP);
-    lengthOfOptions = 12;
-  }
-  Sd_BuildHeader(Instance->buffer, Instance->context->flags, Instance->context->multicastSessionId,
-                 16, lengthOfOptions);
-  Instance->context->multicastSessionId++;
-  if (0 == Instance->context->multicastSessionId) {
-    Instance->context->multicastSessionId = 1;
-    Instance->context->flags &= ~SD_REBOOT_FLAG;
+static void Sd_MsgStart(Sd_MsgType *msg, PduIdType TxPduId, const TcpIp_SockAddrType *RemoteAddr) {
+  msg->TxPduId = TxPduId;
+  if (NULL != RemoteAddr) {
+    msg->RemoteAddr = *RemoteAddr;
+    msg->isMulticast = FALSE;
+  } else {
+    memset(&msg->RemoteAddr, 0, sizeof(msg->RemoteAddr));
+    msg->isMulticast = TRUE;
+  }
+  msg->lengthOfEntries = 0;
+  msg->numOfOptions = 0;
+  msg->numOfEntriesTotal = 0;
+  msg->failed = FALSE;
+}
+
+static boolean Sd_MsgIsFor(const Sd_MsgType *msg, const TcpIp_SockAddrType *RemoteAddr) {
+  boolean r = TRUE;
+
+  if (FALSE == msg->isMulticast) {
+    if ((0 != memcmp(msg->RemoteAddr.addr, RemoteAddr->addr, sizeof(RemoteAddr->addr))) ||
+        (msg->RemoteAddr.port != RemoteAddr->port)) {
+      r = FALSE;
+    }
+  }
+
+  return r;
+}
+
+static void Sd_MsgFlush(const Sd_InstanceType *Instance, Sd_MsgType *msg) {
+  uint32_t lengthOfOptions = SD_OPTION_SIZE * (uint32_t)msg->numOfOptions;
+  Std_ReturnType ret;
+  uint32_t i;
+
+  if (msg->lengthOfEntries > 0) {
+    memcpy(&Instance->buffer[28 + msg->lengthOfEntries], sdOptionBuffer, lengthOfOptions);
+    Sd_BuildHeader(Instance->buffer, Instance->context->flags,
+                   Instance->context->multicastSessionId, msg->lengthOfEntries, lengthOfOptions);
+    Instance->context->multicastSessionId++;
+    if (0 == Instance->context->multicastSessionId) {
+      Instance->context->multicastSessionId = 1;
+      Instance->context->flags &= ~SD_REBOOT_FLAG;
+    }
+    ret = Sd_Transmit(msg->TxPduId, Instance->buffer, 28 + msg->lengthOfEntries + lengthOfOptions,
+                      (msg->isMulticast) ? NULL : &msg->RemoteAddr);
+    if (E_OK != ret) {
+      /* make the entries pending again, they are built again in the next main cycle */
+      ASLOG(SDE, ("[%s] failed to send %d entries\n", Instance->Hostname,
+                  msg->lengthOfEntries / 16));
+      for (i = 0; i < (msg->lengthOfEntries / 16); i++) {
+        SD_SET(*msg->pendingFlags[i], msg->pendingMasks[i]);
+      }
+      msg->failed = TRUE;
+    }
+    msg->lengthOfEntries = 0;
+    msg->numOfOptions = 0;
   }
-#if (defined(_WIN32) || defined(linux)) && !defined(USE_LWIP)
-  return Sd_Transmit(Instance->TxPdu.MulticastTxPduId, Instance->buffer, 44 + lengthOfOptions,
-                     NULL);
-#else
-  RemoteAddr = sub->RemoteAddr;
-  RemoteAddr.port = sub->port;
-  return Sd_Transmit(Instance->TxPdu.UnicastTxPduId, Instance->buffer, 44 + lengthOfOptions,
-                     &RemoteAddr);
-#endif
+}
+
+/* get the index of the option in the message, or SD_MAX_OPTIONS if not there */
+static uint8_t Sd_MsgFindOption(const Sd_MsgType *msg, const uint8_t *option) {
+  uint8_t i;
+
+  for (i = 0; i < msg->numOfOptions; i++) {
+    if (0 == memcmp(&sdOptionBuffer[SD_OPTION_SIZE * i], option, SD_OPTION_SIZE)) {
+      break;
+    }
+  }
+
+  if (i >= msg->numOfOptions) {
+    i = SD_MAX_OPTIONS;
+  }
+
+  return i;
+}
+
+/* reserve one entry in the message, and also its option if not NULL. The same option is shared by
+ * the entries in the message. The message is sent out first if no space left. The pending bits
+ * mask of flags just cleared for this entry are set back if the message can't be sent. */
+static uint8_t *Sd_MsgAddEntry(const Sd_InstanceType *Instance, Sd_MsgType *msg,
+                               const uint8_t *option, uint8_t *indexOfOption, uint8_t *flags,
+                               uint8_t mask) {
+  uint8_t *entry;
+  uint8_t index = SD_MAX_OPTIONS;
+  uint32_t numOfNewOptions = 0;
+
+  if (NULL != option) {
+    index = Sd_MsgFindOption(msg, option);
+    if (SD_MAX_OPTIONS == index) {
+      numOfNewOptions = 1;
+    }
+  }
+
+  if (((28 + msg->lengthOfEntries + 16 +
+        SD_OPTION_SIZE * ((uint32_t)msg->numOfOptions + numOfNewOptions)) > Instance->bufLen) ||
+      (((uint32_t)msg->numOfOptions + numOfNewOptions) > SD_MAX_OPTIONS) ||
+      ((msg->lengthOfEntries / 16) >= SD_MSG_MAX_ENTRIES)) {
+    Sd_MsgFlush(Instance, msg);
+    if (NULL != option) {
+      numOfNewOptions = 1;
+    }
+  }
+
+  if (numOfNewOptions > 0) {
+    index = msg->numOfOptions;
+    memcpy(&sdOptionBuffer[SD_OPTION_SIZE * index], option, SD_OPTION_SIZE);
+    msg->numOfOptions++;
+  }
+
+  if (NULL != indexOfOption) {
+    *indexOfOption = index;
+  }
+
+  msg->pendingFlags[msg->lengthOfEntries / 16] = flags;
+  msg->pendingMasks[msg->lengthOfEntries / 16] = mask;
+  entry = &Instance->buffer[24 + msg->lengthOfEntries];
+  msg->lengthOfEntries += 16;
+  msg->numOfEntriesTotal++;
+
+  return entry;
 }
 
 static uint16_t Sd_NumberOfSubscribes(const Sd_EventHandlerType *EventHandler) {
@@ -812,15 +1041,19 @@ static uint16_t Sd_NumberOfSubscribes(const Sd_EventHandlerType *EventHandler) {
 static Sd_EventHandlerSubscriberType *Sd_LookupSubscribe(const Sd_EventHandlerType *EventHandler,
                                                          const TcpIp_SockAddrType *RemoteAddr) {
   Sd_EventHandlerSubscriberType *sub = NULL;
-  Sd_EventHandlerContextType *context = EventHandler->context;
-  DEC_SQP(EventHandlerSubscriber);
-  SQP_WHILE(EventHandlerSubscriber) {
-    if (0 == memcmp(&var->RemoteAddr, RemoteAddr, sizeof(TcpIp_SockAddrType))) {
+  Sd_EventHandlerSubscriberType *var;
+
+  EnterCritical();
+  var = sdSubscriberHash[Sd_SubscriberHash(EventHandler->HandleId, RemoteAddr)];
+  while (NULL != var) {
+    if ((var->HandleId == EventHandler->HandleId) &&
+        (0 == memcmp(&var->RemoteAddr, RemoteAddr, sizeof(TcpIp_SockAddrType)))) {
       sub = var;
       break;
     }
+    var = var->hnext;
   }
-  SQP_WHILE_END()
+  ExitCritical();
 
   if (NULL == sub) {
     sub = SQP_ALLOC(EventHandlerSubscriber);
@@ -844,24 +1077,15 @@ static Std_ReturnType Sd_HandleSubscribeEventGroup(const Sd_InstanceType *Instan
   Sd_EventHandlerContextType *context = NULL;
   uint16_t numOfSubscribers;
 
-  for (i = 0; i < Instance->numOfServerServices; i++) {
-    config = &Instance->ServerServices[i];
-    if ((config->ServiceId == entry2->serviceId) || (config->InstanceId == entry2->instanceId)) {
-      ret = E_OK;
-      break;
-    }
+  config = Sd_LookupServerService(Instance, entry2->serviceId, entry2->instanceId);
+  if ((NULL != config) && (SD_ANY_INSTANCE_ID != entry2->instanceId)) {
+    ret = Sd_IndexLookup(config->EventHandlersIndex, config->numOfEventHandlers,
+                         entry2->eventGroupId, 0xFFFFFFFFu, &i);
   }
 
   if (E_OK == ret) {
-    ret = E_NOT_OK;
-    for (i = 0; i < config->numOfEventHandlers; i++) {
-      EventHandler = &config->EventHandlers[i];
-      if (EventHandler->EventGroupId == entry2->eventGroupId) {
-        context = EventHandler->context;
-        ret = E_OK;
-        break;
-      }
-    }
+    EventHandler = &config->EventHandlers[i];
+    context = EventHandler->context;
   }
 
   if (E_OK == ret) {
@@ -903,7 +1127,7 @@ static Std_ReturnType Sd_HandleSubscribeEventGroup(const Sd_InstanceType *Instan
                       sub->RemoteAddr.port));
           if (SD_FLG_EVENT_GROUP_UNSUBSCRIBED != sub->flags) {
             EventHandler->onSubscribe(FALSE, &sub->RemoteAddr);
-            SQP_CRM_AND_FREE(EventHandlerSubscriber, sub);
+            SD_SUB_CRM_AND_FREE(sub);
           } else {
             SQP_FREE(EventHandlerSubscriber, sub);
           }
@@ -928,12 +1152,11 @@ static Std_ReturnType Sd_HandleSubscribeEventGroup(const Sd_InstanceType *Instan
         } else {
           SQP_CAPPEND(EventHandlerSubscriber, sub);
         }
+        Sd_SubscriberHashAdd(EventHandler, sub);
         EventHandler->onSubscribe(TRUE, &sub->RemoteAddr);
       }
-      ret = Sd_ResponseSubscribeEventGroup(Instance, config, EventHandler, sub);
-      if (E_OK != ret) { /* retry next time */
-        SD_SET(sub->flags, SD_FLG_PENDING_EVENT_GROUP_ACK);
-      }
+      /* acked by Sd_MainFunction together with the other entries for the same destination */
+      SD_SET(sub->flags, SD_FLG_PENDING_EVENT_GROUP_ACK);
       if (DEFAULT_TTL != entry2->TTL) {
         sub->TTL = SD_CONVERT_MS_TO_MAIN_CYCLES(entry2->TTL * 1000);
       }
@@ -946,7 +1169,7 @@ static Std_ReturnType Sd_HandleSubscribeEventGroup(const Sd_InstanceType *Instan
   if ((E_OK != ret) && (NULL != sub)) {
     if (SD_FLG_EVENT_GROUP_UNSUBSCRIBED != sub->flags) {
       EventHandler->onSubscribe(FALSE, &sub->RemoteAddr);
-      SQP_CRM_AND_FREE(EventHandlerSubscriber, sub);
+      SD_SUB_CRM_AND_FREE(sub);
     } else {
       SQP_FREE(EventHandlerSubscriber, sub);
     }
@@ -964,23 +1187,14 @@ static Std_ReturnType Sd_HandleSubscribeEventGroupAck(const Sd_InstanceType *Ins
   const Sd_ClientServiceType *config;
   const Sd_ConsumedEventGroupType *ConsumedEventGroup;
 
-  for (i = 0; i < Instance->numOfClientServices; i++) {
-    config = &Instance->ClientServices[i];
-    if ((config->ServiceId == entry2->serviceId) || (config->InstanceId == entry2->instanceId)) {
-      ret = E_OK;
-      break;
-    }
+  config = Sd_LookupClientService(Instance, entry2->serviceId, entry2->instanceId);
+  if (NULL != config) {
+    ret = Sd_IndexLookup(config->ConsumedEventGroupsIndex, config->numOfConsumedEventGroups,
+                         entry2->eventGroupId, 0xFFFFFFFFu, &i);
   }
 
   if (E_OK == ret) {
-    ret = E_NOT_OK;
-    for (i = 0; i < config->numOfConsumedEventGroups; i++) {
-      ConsumedEventGroup = &config->ConsumedEventGroups[i];
-      if (ConsumedEventGroup->EventGroupId == entry2->eventGroupId) {
-        ret = E_OK;
-        break;
-      }
-    }
+    ConsumedEventGroup = &config->ConsumedEventGroups[i];
   }
 
   if (E_OK == ret) {
@@ -1079,7 +1293,6 @@ static void Sd_InitServerServiceEventHandlers(const Sd_ServerServiceType *config
   for (i = 0; i < config->numOfEventHandlers; i++) {
     EventHandler = &config->EventHandlers[i];
     memset(EventHandler->context, 0, sizeof(Sd_EventHandlerContextType));
-    SQP_INIT(EventHandlerSubscriber);
     STAILQ_INIT(&EventHandler->context->listEventHandlerSubscribers);
   }
 }
@@ -1097,7 +1310,7 @@ static void Sd_ReInitServerServiceEventHandlers(const Sd_ServerServiceType *conf
       if (SD_FLG_EVENT_GROUP_UNSUBSCRIBED != var->flags) {
         EventHandler->onSubscribe(FALSE, &var->RemoteAddr);
       }
-      SQP_CRM_AND_FREE(EventHandlerSubscriber, var);
+      SD_SUB_CRM_AND_FREE(var);
     }
     SQP_WHILE_END()
     if (context->isMulticastOpened) {
@@ -1450,109 +1663,57 @@ static void Sd_ClientServiceMain_Main(const Sd_InstanceType *Instance,
   }
 }
 
-static void Sd_ServerServiceOfferCheck(const Sd_InstanceType *Instance, uint32_t *lengthOfEntries,
-                                       uint32_t *lengthOfOptions, uint8_t *numOfOptions) {
-  uint16_t i;
-  const Sd_ServerServiceType *config;
-  Sd_ServerServiceContextType *context;
-
-  for (i = 0; i < Instance->numOfServerServices; i++) {
-    config = &Instance->ServerServices[i];
-    context = config->context;
-    if (context->flags & (SD_FLG_PENDING_OFFER | SD_FLG_PENDING_STOP_OFFER)) {
-      if (((28 + *lengthOfEntries + *lengthOfOptions) < (Instance->bufLen - 28)) &&
-          (*numOfOptions < 255)) {
-        /* @SWS_SD_00160 */
-        *lengthOfEntries += 16;
-        *lengthOfOptions += 12;
-        *numOfOptions += 1;
-      } else {
-        break;
-      }
-    }
-  }
-}
-
-static void Sd_ClientServiceFindCheck(const Sd_InstanceType *Instance, uint32_t *lengthOfEntries,
-                                      uint32_t lengthOfOptions) {
-  uint16_t i;
-  const Sd_ClientServiceType *config;
-  Sd_ClientServiceContextType *context;
-
-  for (i = 0; i < Instance->numOfClientServices; i++) {
-    config = &Instance->ClientServices[i];
-    context = config->context;
-    if (context->flags & SD_FLG_PENDING_FIND) {
-      if ((28 + *lengthOfEntries + lengthOfOptions) < (Instance->bufLen - 16)) {
-        *lengthOfEntries += 16;
-      } else {
-        break;
-      }
-    }
-  }
-}
-
-static void Sd_ServerServiceOfferBuild(const Sd_InstanceType *Instance, uint32_t *offsetOfEntries,
-                                       uint32_t *offsetOfOptions, uint8_t *numOfOptions,
-                                       uint32_t *freeSpace) {
+static void Sd_ServerServiceOfferBuild(const Sd_InstanceType *Instance, Sd_MsgType *msg) {
   uint16_t i;
   const Sd_ServerServiceType *config;
   Sd_ServerServiceContextType *context;
   TcpIp_SockAddrType LocalAddr;
+  uint8_t option[SD_OPTION_SIZE];
+  uint8_t indexOfOption;
+  uint8_t *entry;
   uint32_t TTL;
+  uint8_t mask;
   Std_ReturnType ret;
 
   for (i = 0; i < Instance->numOfServerServices; i++) {
     config = &Instance->ServerServices[i];
     context = config->context;
     if (context->flags & (SD_FLG_PENDING_OFFER | SD_FLG_PENDING_STOP_OFFER)) {
-      if (*freeSpace >= 28) {
-        /* @SWS_SD_00416 */
-        ret = SoAd_GetLocalAddr(config->SoConId, &LocalAddr, NULL, NULL);
-        if (E_OK == ret) {
-          if (context->flags & SD_FLG_PENDING_STOP_OFFER) {
-            TTL = 0;
-          } else {
-            TTL = config->ServerTimer->TTL;
-          }
-          SD_CLEAR(context->flags, SD_FLG_PENDING_OFFER | SD_FLG_PENDING_STOP_OFFER);
-          Sd_BuildEntryType1(&Instance->buffer[*offsetOfEntries], SD_OFFER_SERVICE, *numOfOptions,
-                             0, 1, 0, config->ServiceId, config->InstanceId, config->MajorVersion,
-                             config->MinorVersion, TTL);
-          Sd_BuildOptionIPv4Endpoint(&Instance->buffer[*offsetOfOptions], &LocalAddr,
-                                     config->ProtocolType);
-          *offsetOfEntries += 16;
-          *offsetOfOptions += 12;
-          *numOfOptions += 1;
-          *freeSpace -= 28;
+      /* @SWS_SD_00416 */
+      ret = SoAd_GetLocalAddr(config->SoConId, &LocalAddr, NULL, NULL);
+      if (E_OK == ret) {
+        if (context->flags & SD_FLG_PENDING_STOP_OFFER) {
+          TTL = 0;
+        } else {
+          TTL = config->ServerTimer->TTL;
         }
-      } else {
-        break;
+        mask = context->flags & (SD_FLG_PENDING_OFFER | SD_FLG_PENDING_STOP_OFFER);
+        SD_CLEAR(context->flags, SD_FLG_PENDING_OFFER | SD_FLG_PENDING_STOP_OFFER);
+        /* @SWS_SD_00160 */
+        Sd_BuildOptionIPv4Endpoint(option, &LocalAddr, config->ProtocolType);
+        entry = Sd_MsgAddEntry(Instance, msg, option, &indexOfOption, &context->flags, mask);
+        Sd_BuildEntryType1(entry, SD_OFFER_SERVICE, indexOfOption, 0, 1, 0, config->ServiceId,
+                           config->InstanceId, config->MajorVersion, config->MinorVersion, TTL);
       }
     }
   }
 }
 
-static void Sd_ClientServiceFindBuild(const Sd_InstanceType *Instance, uint32_t *offsetOfEntries,
-                                      uint32_t *freeSpace) {
+static void Sd_ClientServiceFindBuild(const Sd_InstanceType *Instance, Sd_MsgType *msg) {
   uint16_t i;
   const Sd_ClientServiceType *config;
   Sd_ClientServiceContextType *context;
+  uint8_t *entry;
 
   for (i = 0; i < Instance->numOfClientServices; i++) {
     config = &Instance->ClientServices[i];
     context = config->context;
     if (context->flags & SD_FLG_PENDING_FIND) {
-      if (*freeSpace >= 16) {
-        SD_CLEAR(context->flags, SD_FLG_PENDING_FIND);
-        Sd_BuildEntryType1(&Instance->buffer[*offsetOfEntries], SD_FIND_SERVICE, 0, 0, 0, 0,
-                           config->ServiceId, config->InstanceId, config->MajorVersion,
-                           config->MinorVersion, config->ClientTimer->TTL);
-        *offsetOfEntries += 16;
-        *freeSpace -= 16;
-      } else {
-        break;
-      }
+      SD_CLEAR(context->flags, SD_FLG_PENDING_FIND);
+      entry = Sd_MsgAddEntry(Instance, msg, NULL, NULL, &context->flags, SD_FLG_PENDING_FIND);
+      Sd_BuildEntryType1(entry, SD_FIND_SERVICE, 0, 0, 0, 0, config->ServiceId,
+                         config->InstanceId, config->MajorVersion, config->MinorVersion,
+                         config->ClientTimer->TTL);
     }
   }
 }
@@ -1572,7 +1733,7 @@ static void Sd_ServerServiceMain_TTL(const Sd_ServerServiceType *config) {
           var->TTL--;
           if (0 == var->TTL) {
             EventHandler->onSubscribe(FALSE, &var->RemoteAddr);
-            SQP_CRM_AND_FREE(EventHandlerSubscriber, var);
+            SD_SUB_CRM_AND_FREE(var);
           }
         }
       }
@@ -1668,147 +1829,171 @@ static void Sd_ClientServiceMain(const Sd_InstanceType *Instance) {
   }
 }
 
-static boolean Sd_ServerServiceEventGroupAckCheck(const Sd_InstanceType *Instance) {
+static void Sd_ServerServiceEventGroupAckBuild(const Sd_InstanceType *Instance, Sd_MsgType *msg) {
   uint16_t i, j;
   const Sd_ServerServiceType *config;
   const Sd_EventHandlerType *EventHandler;
   Sd_EventHandlerContextType *context;
   DEC_SQP(EventHandlerSubscriber);
-  boolean TxOne = FALSE;
-  Std_ReturnType ret = E_OK;
+  TcpIp_SockAddrType RemoteAddr;
+  uint8_t option[SD_OPTION_SIZE];
+  uint8_t indexOfOption;
+  uint8_t *entry;
 
-  for (i = 0; (i < Instance->numOfServerServices) && (FALSE == TxOne); i++) {
+  for (i = 0; i < Instance->numOfServerServices; i++) {
     config = &Instance->ServerServices[i];
     for (j = 0; j < config->numOfEventHandlers; j++) {
       EventHandler = &config->EventHandlers[j];
       context = EventHandler->context;
       SQP_WHILE(EventHandlerSubscriber) {
-        if (var->flags & SD_FLG_PENDING_EVENT_GROUP_ACK) {
-          ret = Sd_ResponseSubscribeEventGroup(Instance, config, EventHandler, var);
-          if (E_OK == ret) {
-            SD_CLEAR(var->flags, SD_FLG_PENDING_EVENT_GROUP_ACK);
-            TxOne = TRUE;
-            break;
+        RemoteAddr = var->RemoteAddr;
+        RemoteAddr.port = var->port;
+        if ((var->flags & SD_FLG_PENDING_EVENT_GROUP_ACK) &&
+            (TRUE == Sd_MsgIsFor(msg, &RemoteAddr))) {
+          SD_CLEAR(var->flags, SD_FLG_PENDING_EVENT_GROUP_ACK);
+          if (var->TxPduId == EventHandler->MulticastTxPduId) {
+            Sd_BuildOptionIPv4Multicast(option, &EventHandler->MulticastEventAddr,
+                                        TCPIP_IPPROTO_UDP);
+            entry = Sd_MsgAddEntry(Instance, msg, option, &indexOfOption, &var->flags,
+                                   SD_FLG_PENDING_EVENT_GROUP_ACK);
+            Sd_BuildEntryType2(entry, SD_SUBSCRIBE_EVENT_GROUP_ACK, indexOfOption, 0, 1, 0,
+                               config->ServiceId, config->InstanceId, config->MajorVersion, 0,
+                               EventHandler->EventGroupId, config->ServerTimer->TTL);
           } else {
-            ASLOG(SDE, ("Sending Subscribe Event Group Ack Failed\n"));
+            entry = Sd_MsgAddEntry(Instance, msg, NULL, NULL, &var->flags,
+                                   SD_FLG_PENDING_EVENT_GROUP_ACK);
+            Sd_BuildEntryType2(entry, SD_SUBSCRIBE_EVENT_GROUP_ACK, 0, 0, 0, 0, config->ServiceId,
+                               config->InstanceId, config->MajorVersion, 0,
+                               EventHandler->EventGroupId, config->ServerTimer->TTL);
           }
         }
       }
       SQP_WHILE_END()
     }
   }
-
-  return TxOne;
 }
 
-static Std_ReturnType
-Sd_SendSubscribeEventGroup(const Sd_InstanceType *Instance, const Sd_ClientServiceType *config,
-                           const Sd_ConsumedEventGroupType *ConsumedEventGroup) {
-  Std_ReturnType ret = E_OK;
-  TcpIp_SockAddrType LocalAddr;
-  uint32_t TTL = 0;
-
-  if (0 == (ConsumedEventGroup->context->flags & SD_FLG_PENDING_STOP_SUBSCRIBE)) {
-    TTL = config->ClientTimer->TTL;
-  } else {
-    /* send stop */
-  }
-
-  Sd_BuildEntryType2(&Instance->buffer[24], SD_SUBSCRIBE_EVENT_GROUP, 0, 0, 1, 0, config->ServiceId,
-                     config->InstanceId, config->MajorVersion, 0, ConsumedEventGroup->EventGroupId,
-                     TTL);
-  ret = SoAd_GetLocalAddr(config->SoConId, &LocalAddr, NULL, NULL);
-  if (E_OK == ret) {
-    Sd_BuildOptionIPv4Endpoint(&Instance->buffer[44], &LocalAddr, config->ProtocolType);
-    Sd_BuildHeader(Instance->buffer, Instance->context->flags,
-                   Instance->context->multicastSessionId, 16, 12);
-    Instance->context->multicastSessionId++;
-    if (0 == Instance->context->multicastSessionId) {
-      Instance->context->multicastSessionId = 1;
-      Instance->context->flags &= ~SD_REBOOT_FLAG;
-    }
-#if (defined(_WIN32) || defined(linux)) && !defined(USE_LWIP)
-    /* NOTE: this is a workaroud for case that server and client on the same host */
-    ret = Sd_Transmit(Instance->TxPdu.MulticastTxPduId, Instance->buffer, 56, NULL);
-#else
-    memcpy(LocalAddr.addr, config->context->RemoteAddr.addr, 4);
-    LocalAddr.port = config->context->port;
-    ret = Sd_Transmit(Instance->TxPdu.UnicastTxPduId, Instance->buffer, 56, &LocalAddr);
-#endif
-    if (E_OK != ret) {
-      ASLOG(SDE, ("Sending Subscribe Event Group Ack Failed\n"));
-    }
-  }
-
-  return ret;
-}
-
-static boolean Sd_ClientServiceSubscribeEventGroupCheck(const Sd_InstanceType *Instance) {
+static void Sd_ClientServiceSubscribeEventGroupBuild(const Sd_InstanceType *Instance,
+                                                     Sd_MsgType *msg) {
   uint16_t i, j;
   const Sd_ClientServiceType *config;
   const Sd_ConsumedEventGroupType *ConsumedEventGroup;
-  boolean TxOne = FALSE;
+  TcpIp_SockAddrType LocalAddr;
+  TcpIp_SockAddrType RemoteAddr;
+  uint8_t option[SD_OPTION_SIZE];
+  uint8_t indexOfOption;
+  uint8_t *entry;
+  uint32_t TTL;
+  uint8_t mask;
   Std_ReturnType ret;
 
-  for (i = 0; (i < Instance->numOfClientServices) && (FALSE == TxOne); i++) {
+  for (i = 0; i < Instance->numOfClientServices; i++) {
     config = &Instance->ClientServices[i];
-    for (j = 0; (j < config->numOfConsumedEventGroups) && (FALSE == TxOne); j++) {
-      ConsumedEventGroup = &config->ConsumedEventGroups[j];
-      if (ConsumedEventGroup->context->flags &
-          (SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE)) {
-        ret = Sd_SendSubscribeEventGroup(Instance, config, ConsumedEventGroup);
-        if (E_OK == ret) {
-          SD_CLEAR(ConsumedEventGroup->context->flags,
-                   SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE);
-          TxOne = TRUE;
+    RemoteAddr = config->context->RemoteAddr;
+    RemoteAddr.port = config->context->port;
+    if (TRUE == Sd_MsgIsFor(msg, &RemoteAddr)) {
+      for (j = 0; j < config->numOfConsumedEventGroups; j++) {
+        ConsumedEventGroup = &config->ConsumedEventGroups[j];
+        if (ConsumedEventGroup->context->flags &
+            (SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE)) {
+          ret = SoAd_GetLocalAddr(config->SoConId, &LocalAddr, NULL, NULL);
+          if (E_OK == ret) {
+            if (0 == (ConsumedEventGroup->context->flags & SD_FLG_PENDING_STOP_SUBSCRIBE)) {
+              TTL = config->ClientTimer->TTL;
+            } else {
+              TTL = 0; /* send stop */
+            }
+            mask = ConsumedEventGroup->context->flags &
+                   (SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE);
+            SD_CLEAR(ConsumedEventGroup->context->flags,
+                     SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE);
+            Sd_BuildOptionIPv4Endpoint(option, &LocalAddr, config->ProtocolType);
+            entry = Sd_MsgAddEntry(Instance, msg, option, &indexOfOption,
+                                   &ConsumedEventGroup->context->flags, mask);
+            Sd_BuildEntryType2(entry, SD_SUBSCRIBE_EVENT_GROUP, indexOfOption, 0, 1, 0,
+                               config->ServiceId, config->InstanceId, config->MajorVersion, 0,
+                               ConsumedEventGroup->EventGroupId, TTL);
+          }
         }
       }
     }
   }
-
-  return TxOne;
 }
 
-static void Sd_ServerClientServiceMain(const Sd_InstanceType *Instance) {
-  uint32_t lengthOfEntries = 0;
-  uint32_t lengthOfOptions = 0;
-  uint32_t offsetOfEntries = 24;
-  uint8_t numOfOptions = 0;
-  uint32_t offsetOfOptions;
-  uint32_t freeSpace;
-  boolean TxOne = FALSE;
-  Std_ReturnType ret;
-
-  Sd_ClientServiceFindCheck(Instance, &lengthOfEntries, lengthOfOptions);
-  Sd_ServerServiceOfferCheck(Instance, &lengthOfEntries, &lengthOfOptions, &numOfOptions);
+#ifndef SD_USE_MULTICAST_FOR_UNICAST
+/* get the destination of the first pending unicast entry */
+static boolean Sd_NextUnicastDestination(const Sd_InstanceType *Instance,
+                                         TcpIp_SockAddrType *RemoteAddr) {
+  uint16_t i, j;
+  const Sd_ServerServiceType *sconfig;
+  const Sd_ClientServiceType *cconfig;
+  const Sd_EventHandlerType *EventHandler;
+  Sd_EventHandlerContextType *context;
+  DEC_SQP(EventHandlerSubscriber);
+  TcpIp_SockAddrType LocalAddr;
+  boolean found = FALSE;
 
-  if (lengthOfEntries > 0) {
-    offsetOfOptions = offsetOfEntries + lengthOfEntries + 4;
-    freeSpace = lengthOfEntries + lengthOfOptions;
-    numOfOptions = 0;
-    Sd_ClientServiceFindBuild(Instance, &offsetOfEntries, &freeSpace);
-    Sd_ServerServiceOfferBuild(Instance, &offsetOfEntries, &offsetOfOptions, &numOfOptions,
-                               &freeSpace);
-    Sd_BuildHeader(Instance->buffer, Instance->context->flags,
-                   Instance->context->multicastSessionId, lengthOfEntries, lengthOfOptions);
-    Instance->context->multicastSessionId++;
-    if (0 == Instance->context->multicastSessionId) {
-      Instance->context->multicastSessionId = 1;
-      Instance->context->flags &= ~SD_REBOOT_FLAG;
+  for (i = 0; (i < Instance->numOfServerServices) && (FALSE == found); i++) {
+    sconfig = &Instance->ServerServices[i];
+    for (j = 0; (j < sconfig->numOfEventHandlers) && (FALSE == found); j++) {
+      EventHandler = &sconfig->EventHandlers[j];
+      context = EventHandler->context;
+      SQP_WHILE(EventHandlerSubscriber) {
+        if (var->flags & SD_FLG_PENDING_EVENT_GROUP_ACK) {
+          *RemoteAddr = var->RemoteAddr;
+          RemoteAddr->port = var->port;
+          found = TRUE;
+          break;
+        }
+      }
+      SQP_WHILE_END()
     }
+  }
 
-    ret = Sd_Transmit(Instance->TxPdu.MulticastTxPduId, Instance->buffer,
-                      28 + lengthOfEntries + lengthOfOptions, NULL);
-    if (E_OK == ret) {
-      TxOne = TRUE;
+  for (i = 0; (i < Instance->numOfClientServices) && (FALSE == found); i++) {
+    cconfig = &Instance->ClientServices[i];
+    for (j = 0; (j < cconfig->numOfConsumedEventGroups) && (FALSE == found); j++) {
+      /* skip the one not able to be built now, it will be retried next time */
+      if ((cconfig->ConsumedEventGroups[j].context->flags &
+           (SD_FLG_PENDING_SUBSCRIBE | SD_FLG_PENDING_STOP_SUBSCRIBE)) &&
+          (E_OK == SoAd_GetLocalAddr(cconfig->SoConId, &LocalAddr, NULL, NULL))) {
+        *RemoteAddr = cconfig->context->RemoteAddr;
+        RemoteAddr->port = cconfig->context->port;
+        found = TRUE;
+      }
     }
   }
-  if (FALSE == TxOne) {
-    TxOne = Sd_ServerServiceEventGroupAckCheck(Instance);
-  }
-  if (FALSE == TxOne) {
-    TxOne = Sd_ClientServiceSubscribeEventGroupCheck(Instance);
+
+  return found;
+}
+#endif
+
+static void Sd_ServerClientServiceMain(const Sd_InstanceType *Instance) {
+  Sd_MsgType msg;
+#ifndef SD_USE_MULTICAST_FOR_UNICAST
+  TcpIp_SockAddrType RemoteAddr;
+  boolean progress = TRUE;
+#endif
+
+  Sd_MsgStart(&msg, Instance->TxPdu.MulticastTxPduId, NULL);
+  Sd_ClientServiceFindBuild(Instance, &msg);
+  Sd_ServerServiceOfferBuild(Instance, &msg);
+#ifdef SD_USE_MULTICAST_FOR_UNICAST
+  Sd_ServerServiceEventGroupAckBuild(Instance, &msg);
+  Sd_ClientServiceSubscribeEventGroupBuild(Instance, &msg);
+  Sd_MsgFlush(Instance, &msg);
+#else
+  Sd_MsgFlush(Instance, &msg);
+  /* one destination after another, each one packed into as few messages as possible */
+  while ((TRUE == progress) && (TRUE == Sd_NextUnicastDestination(Instance, &RemoteAddr))) {
+    Sd_MsgStart(&msg, Instance->TxPdu.UnicastTxPduId, &RemoteAddr);
+    Sd_ServerServiceEventGroupAckBuild(Instance, &msg);
+    Sd_ClientServiceSubscribeEventGroupBuild(Instance, &msg);
+    Sd_MsgFlush(Instance, &msg);
+    /* stop on a failure, the restored entries would be found again and again */
+    progress = ((msg.numOfEntriesTotal > 0) && (FALSE == msg.failed)) ? TRUE : FALSE;
   }
+#endif
 }
 /* ================================ [ FUNCTIONS ] ============================================== */
 void Sd_Init(const Sd_ConfigType *ConfigPtr) {
@@ -1822,6 +2007,9 @@ void Sd_Init(const Sd_ConfigType *ConfigPtr) {
     sdConfigPtr = &Sd_Config;
   }
 
+  SQP_INIT(EventHandlerSubscriber);
+  memset(sdSubscriberHash, 0, sizeof(sdSubscriberHash));
+
   for (i = 0; i < SD_CONFIG->numOfInstances; i++) {
     Instance = &SD_CONFIG->Instances[i];
     Instance->context->flags = SD_REBOOT_FLAG | SD_UNICAST_FLAG;
@@ -2061,7 +2249,7 @@ void Sd_RemoveSubscriber(uint16_t EventHandlerId, PduIdType TxPduId) {
     SQP_WHILE(EventHandlerSubscriber) {
       if (var->TxPduId == TxPduId) {
         EventHandler->onSubscribe(FALSE, &var->RemoteAddr);
-        SQP_CRM_AND_FREE(EventHandlerSubscriber, var);
+        SD_SUB_CRM_AND_FREE(var);
       }
     }
     SQP_WHILE_END()
@@ -53,6 +53,12 @@ typedef boolean (*Sd_CapabilityRecordMatchCalloutFncType)(
   uint32_t minorVersion, const Sd_ConfigOptionStringType *receivedConfigOptionPtrArray,
   const Sd_ConfigOptionStringType *configuredConfigOptionPtrArray);
 
+/* generated index sorted by key for binary search */
+typedef struct {
+  uint32_t key; /* ServiceId << 16 | InstanceId, or EventGroupId */
+  uint16_t index;
+} Sd_IndexType;
+
 typedef struct {
   uint32_t TTL; /* TTL to do resubscribe before timeout */
   boolean isSubscribed;
@@ -117,6 +123,7 @@ typedef struct {
   uint8_t InstanceIndex;
   const Sd_EventHandlerType *EventHandlers;
   uint16_t numOfEventHandlers;
+  const Sd_IndexType *EventHandlersIndex;
   uint16_t SomeIpServiceId;
 } Sd_ServerServiceType;
 
@@ -149,6 +156,7 @@ typedef struct {
   uint8_t InstanceIndex;
   const Sd_ConsumedEventGroupType *ConsumedEventGroups;
   uint16_t numOfConsumedEventGroups;
+  const Sd_IndexType *ConsumedEventGroupsIndex;
 } Sd_ClientServiceType;
 
 typedef struct {
@@ -182,8 +190,10 @@ typedef struct {
 
   const Sd_ServerServiceType *ServerServices;
   uint16_t numOfServerServices;
+  const Sd_IndexType *ServerServicesIndex;
   const Sd_ClientServiceType *ClientServices;
   uint16_t numOfClientServices;
+  const Sd_IndexType *ClientServicesIndex;
   uint8_t *buffer;
   PduLengthType bufLen;
   Sd_InstanceContextType *context;
@@ -6,6 +6,7 @@
  */
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "SoAd.h"
+#include "SoAd_Cfg.h"
 #include "SoAd_Priv.h"
 #include "Std_Debug.h"
 #include <string.h>
@@ -18,13 +19,30 @@
 #define IS_CON_TYPE_OF(con, mask) (0 != ((con)->SoConType & (mask)))
 
 #define SOAD_TX_ON_GOING 0x01
+/* unwatched as the TP upper layer is full, watched again once it has room */
+#define SOAD_RX_THROTTLED 0x02
 
 #define SOAD_CONFIG (soAdConfigPtr)
+
+#ifndef SOAD_EPOLL_EVENTS_MAX
+#define SOAD_EPOLL_EVENTS_MAX 16
+#endif
+
+#if defined(SOAD_UDP_RX_BATCH) && !defined(SOAD_UDP_RX_BUFFER_SIZE)
+/* the largest Net buffer, the longest datagram the read one by one can receive too, so the
+ * batch drops no datagram that would be accepted without it. The longer ones are dropped. */
+#define SOAD_UDP_RX_BUFFER_SIZE MEMPOOL_NET_MAX_SIZE
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 /* ================================ [ DECLARES  ] ============================================== */
 extern const SoAd_ConfigType SoAd_Config;
 /* ================================ [ DATAS     ] ============================================== */
 static const SoAd_ConfigType *soAdConfigPtr = NULL;
+#ifdef SOAD_UDP_RX_BATCH
+/* shared by all the UDP sockets as they are only read by SoAd_MainFunction one by one */
+static uint8_t soAdUdpRxBuffers[SOAD_UDP_RX_BATCH][SOAD_UDP_RX_BUFFER_SIZE];
+static TcpIp_RecvMsgType soAdUdpRxMsgs[SOAD_UDP_RX_BATCH];
+#endif
 /* ================================ [ LOCALS    ] ============================================== */
 static void soAdCreateSocket(SoAd_SoConIdType SoConId) {
   const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
@@ -70,6 +88,10 @@ static void soAdCreateSocket(SoAd_SoConIdType SoConId) {
       context->state = SOAD_SOCKET_READY;
     }
     context->sock = sockId;
+#ifdef USE_TCPIP_EPOLL
+    (void)TcpIp_Watch(sockId, SoConId);
+    context->flag &= ~SOAD_RX_THROTTLED;
+#endif
     if (conG->SoConModeChgNotification) {
       conG->SoConModeChgNotification(SoConId, SOAD_SOCON_ONLINE);
     }
@@ -111,6 +133,29 @@ static void soAdSocketTpRxNotify(SoAd_SocketContextType *context,
   }
 }
 
+/* no more than the TP upper layer has room for is read, the rest is left in the socket, so the
+ * TCP flow control slows the peer down instead of the upper layer dropping what doesn't fit */
+static uint32_t soAdSocketTpRxLimit(const SoAd_SocketConnectionType *connection, uint32_t rxLen) {
+  const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+  const SoAd_TpInterfaceType *IF = (const SoAd_TpInterfaceType *)conG->Interface;
+  PduInfoType PduInfo;
+  PduLengthType bufferSize;
+  BufReq_ReturnType bufReq;
+
+  if ((rxLen > 0) && (NULL != IF->TpCopyRxData)) {
+    PduInfo.SduDataPtr = NULL;
+    PduInfo.MetaDataPtr = NULL;
+    PduInfo.SduLength = 0;
+    bufferSize = (PduLengthType)-1; /* no limit if the upper layer doesn't tell */
+    bufReq = IF->TpCopyRxData(connection->RxPduId, &PduInfo, &bufferSize);
+    if ((BUFREQ_OK == bufReq) && (bufferSize < rxLen)) {
+      rxLen = bufferSize;
+    }
+  }
+
+  return rxLen;
+}
+
 static Std_ReturnType soAdSocketUdpReadyMain(SoAd_SoConIdType SoConId, uint8_t *dataIn,
                                              uint32_t length) {
   const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
@@ -158,6 +203,113 @@ static Std_ReturnType soAdSocketUdpReadyMain(SoAd_SoConIdType SoConId, uint8_t *
   return ret;
 }
 
+#ifdef SOAD_UDP_RX_BATCH
+static Std_ReturnType soAdSocketUdpBatchMain(SoAd_SoConIdType SoConId) {
+  const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
+  const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+  SoAd_SocketContextType *context = &SOAD_CONFIG->Contexts[SoConId];
+  Std_ReturnType ret;
+  uint16_t num = SOAD_UDP_RX_BATCH;
+  uint16_t i;
+
+  for (i = 0; i < num; i++) {
+    soAdUdpRxMsgs[i].BufPtr = soAdUdpRxBuffers[i];
+    soAdUdpRxMsgs[i].Length = SOAD_UDP_RX_BUFFER_SIZE;
+  }
+
+  ret = TcpIp_RecvFromMulti(context->sock, soAdUdpRxMsgs, &num);
+  if (E_OK == ret) {
+    ASLOG(SOAD, ("[%d] UDP read %d datagrams\n", SoConId, num));
+    for (i = 0; i < num; i++) {
+      if (soAdUdpRxMsgs[i].Length > 0) {
+        context->RemoteAddr = soAdUdpRxMsgs[i].RemoteAddr;
+        if (conG->IsTP) {
+          soAdSocketTpRxNotify(context, connection, soAdUdpRxMsgs[i].BufPtr,
+                               soAdUdpRxMsgs[i].Length);
+        } else {
+          soAdSocketIfRxNotify(context, connection, soAdUdpRxMsgs[i].BufPtr,
+                               soAdUdpRxMsgs[i].Length);
+        }
+      }
+    }
+    if (num < SOAD_UDP_RX_BATCH) {
+      ret = E_NOT_OK; /* drained */
+    }
+  } else {
+    ASLOG(SOADE, ("[%d] UDP read failed\n", SoConId));
+  }
+
+  return ret;
+}
+#endif
+
+static void soAdSocketTcpClose(SoAd_SoConIdType SoConId);
+
+#ifdef USE_LWIP
+/* hand the pbuf payload of lwIP to the upper layer directly, no copy to a Net_MemAlloc buffer */
+static Std_ReturnType soAdSocketZeroCopyMain(SoAd_SoConIdType SoConId) {
+  const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
+  const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+  SoAd_SocketContextType *context = &SOAD_CONFIG->Contexts[SoConId];
+  TcpIp_RecvBufferType *buffer = &context->rxBuffer;
+  Std_ReturnType ret = E_OK;
+  uint32_t rxLen;
+
+  if (NULL == buffer->BufPtr) {
+    context->rxOffset = 0;
+    ret = TcpIp_RecvBuffer(context->sock, buffer);
+  }
+  if (E_OK == ret) {
+    if (buffer->Length > 0) {
+      rxLen = buffer->Length - context->rxOffset;
+      if (conG->IsTP && (TCPIP_IPPROTO_TCP == conG->ProtocolType)) {
+        /* the rest is kept lent, so the TCP window is not opened before it is taken */
+        rxLen = soAdSocketTpRxLimit(connection, rxLen);
+      }
+      ASLOG(SOAD, ("[%d] read %d bytes\n", SoConId, rxLen));
+      if (TCPIP_IPPROTO_UDP == conG->ProtocolType) {
+        context->RemoteAddr = buffer->RemoteAddr;
+      }
+      if (0 == rxLen) {
+        ret = E_NOT_OK; /* the upper layer is full, retry in the next main function */
+      } else if (conG->IsTP) {
+        soAdSocketTpRxNotify(context, connection, &buffer->BufPtr[context->rxOffset], rxLen);
+      } else {
+        soAdSocketIfRxNotify(context, connection, buffer->BufPtr, rxLen);
+      }
+      context->rxOffset += rxLen;
+      if (context->rxOffset >= buffer->Length) {
+        TcpIp_ReleaseBuffer(buffer);
+      }
+    } else {
+      ret = E_NOT_OK; /* drained */
+    }
+  } else if (TCPIP_IPPROTO_TCP == conG->ProtocolType) {
+    soAdSocketTcpClose(SoConId);
+  } else {
+    ASLOG(SOADE, ("[%d] UDP read failed\n", SoConId));
+  }
+
+  return ret;
+}
+#endif
+
+static void soAdSocketTcpClose(SoAd_SoConIdType SoConId) {
+  const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
+  const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+  SoAd_SocketContextType *context = &SOAD_CONFIG->Contexts[SoConId];
+
+  TcpIp_Close(context->sock, TRUE);
+#ifdef USE_LWIP
+  TcpIp_ReleaseBuffer(&context->rxBuffer);
+#endif
+  if (conG->SoConModeChgNotification) {
+    conG->SoConModeChgNotification(SoConId, SOAD_SOCON_OFFLINE);
+  }
+  context->state = SOAD_SOCKET_CLOSED;
+  ASLOG(SOADE, ("[%d] close, goto accept\n", SoConId));
+}
+
 static Std_ReturnType soAdSocketTcpReadyMain(SoAd_SoConIdType SoConId, uint8_t *dataIn,
                                              uint32_t length) {
   const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
@@ -171,6 +323,17 @@ static Std_ReturnType soAdSocketTcpReadyMain(SoAd_SoConIdType SoConId, uint8_t *
   if (E_OK == ret) {
     if (NULL == dataIn) {
       rxLen = TcpIp_Tell(context->sock);
+      if (conG->IsTP && (rxLen > 0)) {
+        rxLen = soAdSocketTpRxLimit(connection, rxLen);
+#ifdef USE_TCPIP_EPOLL
+        if (0 == rxLen) {
+          /* the wait is level-triggered, a watched socket left unread would spin the main loop */
+          (void)TcpIp_Unwatch(context->sock);
+          context->flag |= SOAD_RX_THROTTLED;
+          ASLOG(SOAD, ("[%d] upper layer full, stop watching\n", SoConId));
+        }
+#endif
+      }
       if (rxLen > 0) {
         data = Net_MemAlloc((uint32_t)rxLen);
         if (NULL == data) {
@@ -203,12 +366,7 @@ static Std_ReturnType soAdSocketTcpReadyMain(SoAd_SoConIdType SoConId, uint8_t *
       }
     }
   } else {
-    TcpIp_Close(context->sock, TRUE);
-    if (conG->SoConModeChgNotification) {
-      conG->SoConModeChgNotification(SoConId, SOAD_SOCON_OFFLINE);
-    }
-    context->state = SOAD_SOCKET_CLOSED;
-    ASLOG(SOADE, ("[%d] close, goto accept\n", SoConId));
+    soAdSocketTcpClose(SoConId);
   }
 
   return ret;
@@ -239,6 +397,10 @@ static void soAdSocketAcceptMain(SoAd_SoConIdType SoConId) {
           actCtx->sock = SocketId;
           actCtx->RemoteAddr = RemoteAddr;
           actCtx->state = SOAD_SOCKET_READY;
+#ifdef USE_TCPIP_EPOLL
+          (void)TcpIp_Watch(SocketId, i + conG->SoConId);
+          actCtx->flag &= ~SOAD_RX_THROTTLED;
+#endif
           ret = E_OK;
           break;
         }
@@ -266,13 +428,12 @@ static void soAdSocketAcceptMain(SoAd_SoConIdType SoConId) {
   }
 }
 
-static void soAdSocketReadyMain(SoAd_SoConIdType SoConId) {
+static void soAdSocketTxConfirmMain(SoAd_SoConIdType SoConId) {
   const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
   const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
   const SoAd_TpInterfaceType *tpIF = (const SoAd_TpInterfaceType *)conG->Interface;
   const SoAd_IfInterfaceType *ifIF = (const SoAd_IfInterfaceType *)conG->Interface;
   SoAd_SocketContextType *context = &SOAD_CONFIG->Contexts[SoConId];
-  Std_ReturnType ret = E_OK;
 
   if (context->flag & SOAD_TX_ON_GOING) {
     if (conG->IsTP) {
@@ -286,15 +447,79 @@ static void soAdSocketReadyMain(SoAd_SoConIdType SoConId) {
     }
     context->flag &= ~SOAD_TX_ON_GOING;
   }
+}
+
+static void soAdSocketRxMain(SoAd_SoConIdType SoConId) {
+#ifndef USE_LWIP
+  const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
+  const SoAd_SocketConnectionGroupType *conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+#endif
+  Std_ReturnType ret = E_OK;
 
   while (E_OK == ret) {
+#ifdef USE_LWIP
+    ret = soAdSocketZeroCopyMain(SoConId);
+#else
     if (TCPIP_IPPROTO_TCP == conG->ProtocolType) {
       ret = soAdSocketTcpReadyMain(SoConId, NULL, 0);
     } else {
+#ifdef SOAD_UDP_RX_BATCH
+      ret = soAdSocketUdpBatchMain(SoConId);
+#else
       ret = soAdSocketUdpReadyMain(SoConId, NULL, 0);
+#endif
+    }
+#endif
+  }
+}
+
+#ifndef USE_TCPIP_EPOLL
+static void soAdSocketReadyMain(SoAd_SoConIdType SoConId) {
+  soAdSocketTxConfirmMain(SoConId);
+  soAdSocketRxMain(SoConId);
+}
+#else
+/* the pending data is reported by the next wait once the socket is watched again */
+static void soAdSocketRxResume(SoAd_SoConIdType SoConId) {
+  const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
+  SoAd_SocketContextType *context = &SOAD_CONFIG->Contexts[SoConId];
+
+  if (soAdSocketTpRxLimit(connection, 1) > 0) {
+    if (E_OK == TcpIp_Watch(context->sock, SoConId)) {
+      context->flag &= ~SOAD_RX_THROTTLED;
+      ASLOG(SOAD, ("[%d] upper layer has room, watch again\n", SoConId));
+    }
+  }
+}
+
+static void soAdSocketEventMain(const TcpIp_SocketEventType *event) {
+  SoAd_SoConIdType SoConId = (SoAd_SoConIdType)event->cookie;
+  const SoAd_SocketConnectionType *connection;
+  const SoAd_SocketConnectionGroupType *conG;
+  SoAd_SocketContextType *context;
+
+  if (SoConId < SOAD_CONFIG->numOfConnections) {
+    connection = &SOAD_CONFIG->Connections[SoConId];
+    conG = &SOAD_CONFIG->ConnectionGroups[connection->GID];
+    context = &SOAD_CONFIG->Contexts[SoConId];
+    /* the socket may be closed and its fd reused by another one in this round */
+    if (context->sock == event->SocketId) {
+      if (SOAD_SOCKET_ACCEPT == context->state) {
+        soAdSocketAcceptMain(SoConId);
+      } else if (SOAD_SOCKET_READY == context->state) {
+        soAdSocketRxMain(SoConId);
+        /* all the data has been read out, the peer is gone */
+        if ((SOAD_SOCKET_READY == context->state) && (event->events & TCPIP_EVENT_HANGUP) &&
+            (TCPIP_IPPROTO_TCP == conG->ProtocolType)) {
+          soAdSocketTcpClose(SoConId);
+        }
+      } else {
+        /* taken control or closed, do nothing */
+      }
     }
   }
 }
+#endif
 /* ================================ [ FUNCTIONS ] ============================================== */
 void SoAd_Init(const SoAd_ConfigType *ConfigPtr) {
   int i;
@@ -333,6 +558,10 @@ void SoAd_Init(const SoAd_ConfigType *ConfigPtr) {
 void SoAd_MainFunction(void) {
   int i;
   SoAd_SocketContextType *context;
+#ifdef USE_TCPIP_EPOLL
+  TcpIp_SocketEventType events[SOAD_EPOLL_EVENTS_MAX];
+  int numOfEvents;
+#endif
 
   for (i = 0; i < SOAD_CONFIG->numOfConnections; i++) {
     context = &SOAD_CONFIG->Contexts[i];
@@ -340,16 +569,33 @@ void SoAd_MainFunction(void) {
     case SOAD_SOCKET_CREATE:
       soAdCreateSocket(i);
       break;
+#ifndef USE_TCPIP_EPOLL
     case SOAD_SOCKET_ACCEPT:
       soAdSocketAcceptMain(i);
       break;
     case SOAD_SOCKET_READY:
       soAdSocketReadyMain(i);
       break;
+#else
+    case SOAD_SOCKET_READY:
+      soAdSocketTxConfirmMain(i);
+      if (context->flag & SOAD_RX_THROTTLED) {
+        soAdSocketRxResume(i);
+      }
+      break;
+#endif
     default:
       break;
     }
   }
+
+#ifdef USE_TCPIP_EPOLL
+  /* only the sockets that are readable or hung up are serviced */
+  numOfEvents = TcpIp_WaitEvents(events, SOAD_EPOLL_EVENTS_MAX, 0);
+  for (i = 0; i < numOfEvents; i++) {
+    soAdSocketEventMain(&events[i]);
+  }
+#endif
 }
 
 Std_ReturnType SoAd_IfTransmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
@@ -376,10 +622,12 @@ Std_ReturnType SoAd_IfTransmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr)
     if (TCPIP_IPPROTO_UDP == conG->ProtocolType) {
       if (PduInfoPtr->MetaDataPtr != NULL) {
         addr = *(const TcpIp_SockAddrType *)PduInfoPtr->MetaDataPtr;
-        ret = TcpIp_SendTo(context->sock, &addr, PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
+        ret = TcpIp_SendToQueued(context->sock, &addr, PduInfoPtr->SduDataPtr,
+                                 PduInfoPtr->SduLength);
       } else {
         TcpIp_SetupAddrFrom(&addr, conG->Remote, conG->Port);
-        ret = TcpIp_SendTo(context->sock, &addr, PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
+        ret = TcpIp_SendToQueued(context->sock, &addr, PduInfoPtr->SduDataPtr,
+                                 PduInfoPtr->SduLength);
       }
     } else {
       ret = TcpIp_Send(context->sock, PduInfoPtr->SduDataPtr, PduInfoPtr->SduLength);
@@ -542,6 +790,9 @@ Std_ReturnType SoAd_CloseSoCon(SoAd_SoConIdType SoConId, boolean abort) {
       }
       ret = TcpIp_Close(context->sock, abort);
       if (E_OK == ret) {
+#ifdef USE_LWIP
+        TcpIp_ReleaseBuffer(&context->rxBuffer);
+#endif
         context->state = SOAD_SOCKET_CLOSED;
         TcpIp_SetupAddrFrom(&context->RemoteAddr, conG->Remote, conG->Port);
       } else {
@@ -573,6 +824,10 @@ Std_ReturnType SoAd_TakeControl(SoAd_SoConIdType SoConId) {
     context = &SOAD_CONFIG->Contexts[SoConId];
     if (SOAD_SOCKET_READY <= context->state) {
       context->state = SOAD_SOCKET_TAKEN_CONTROL;
+#ifdef USE_TCPIP_EPOLL
+      /* the owner reads it by SoAd_ControlRx, don't let it wake up the main loop */
+      (void)TcpIp_Unwatch(context->sock);
+#endif
       ret = E_OK;
     }
   }
@@ -611,6 +866,21 @@ Std_ReturnType SoAd_SetTimeout(SoAd_SoConIdType SoConId, uint32_t timeoutMs) {
   return ret;
 }
 
+Std_ReturnType SoAd_GetSocket(SoAd_SoConIdType SoConId, TcpIp_SocketIdType *SocketIdPtr) {
+  Std_ReturnType ret = E_NOT_OK;
+  SoAd_SocketContextType *context;
+
+  if (SoConId < SOAD_CONFIG->numOfConnections) {
+    context = &SOAD_CONFIG->Contexts[SoConId];
+    if (SOAD_SOCKET_TAKEN_CONTROL == context->state) {
+      *SocketIdPtr = context->sock;
+      ret = E_OK;
+    }
+  }
+
+  return ret;
+}
+
 Std_ReturnType SoAd_ControlRx(SoAd_SoConIdType SoConId, uint8_t *data, uint32_t length) {
   SoAd_SocketContextType *context;
   const SoAd_SocketConnectionType *connection = &SOAD_CONFIG->Connections[SoConId];
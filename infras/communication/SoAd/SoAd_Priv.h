@@ -128,6 +128,11 @@ typedef struct {
   TcpIp_SockAddrType RemoteAddr;
   TcpIp_SockAddrType LocalAddr;
   uint8_t flag;
+#ifdef USE_LWIP
+  /* the TCP pbuf that the TP upper layer had no room for all of, and how much of it is taken */
+  TcpIp_RecvBufferType rxBuffer;
+  uint32_t rxOffset;
+#endif
 #if SOAD_ERROR_COUNTER_LIMIT > 0
   uint8_t errorCounter;
 #endif
@@ -76,6 +76,24 @@
 #define SOMEIP_TX_NOK_RETRY_MAX 3
 #endif
 
+/* the response timer of a request whose TP segments are still being sent, not running yet */
+#define SOMEIP_WAIT_RES_SENDING 0xFFFF
+
+/* max number of TP segments of one message that could be sent in one main cycle */
+#ifndef SOMEIP_TP_TX_WINDOW
+#define SOMEIP_TP_TX_WINDOW 1
+#endif
+
+/* max number of TP segments in one main cycle for all the requests and responses */
+#ifndef SOMEIP_TP_TX_BUDGET_METHOD
+#define SOMEIP_TP_TX_BUDGET_METHOD 0xFFFF
+#endif
+
+/* max number of TP segments in one main cycle for all the events */
+#ifndef SOMEIP_TP_TX_BUDGET_EVENT
+#define SOMEIP_TP_TX_BUDGET_EVENT 0xFFFF
+#endif
+
 #ifdef USE_PCAP
 #define PCAP_TRACE PCap_SomeIp
 #else
@@ -188,6 +206,9 @@ DEF_SQP(TxTpMsg, SOMEIP_TX_TP_MESSAGE_POOL_SIZE)
 DEF_SQP(TxTpEvtMsg, SOMEIP_TX_TP_EVENT_MESSAGE_POOL_SIZE)
 DEF_SQP(WaitResMsg, SOMEIP_WAIT_RESPOSE_MESSAGE_POOL_SIZE)
 static const SomeIp_ConfigType *someIpConfigPtr = NULL;
+/* only used in the SomeIp_MainFunction context */
+static uint16_t someIpTpTxBudgetMethod;
+static uint16_t someIpTpTxBudgetEvent;
 /* ================================ [ LOCALS    ] ============================================== */
 static Std_ReturnType SomeIp_DecodeHeader(const uint8_t *data, uint32_t length,
                                           SomeIp_HeaderType *header) {
@@ -661,6 +682,73 @@ static Std_ReturnType SomeIp_SendNextTxTpEvtMsg(const SomeIp_ServerServiceType *
   return ret;
 }
 
+#ifdef SOMEIP_TP_TX_PACING_US
+#define SOMEIP_TP_TX_PACED(var) STD_TIME_IS_REACHED(Std_GetTime(), (var)->deadline)
+#define SOMEIP_TP_TX_PACE(var) (var)->deadline = Std_GetTime() + SOMEIP_TP_TX_PACING_US
+#else
+#define SOMEIP_TP_TX_PACED(var) TRUE
+#define SOMEIP_TP_TX_PACE(var)
+#endif
+
+/* send the next window of segments, stop early if no budget left, paced or no progress. The budget
+ * is the one of the main cycle, NULL from the API context where only the window limits */
+static Std_ReturnType SomeIp_SendTxTpMsgWindow(PduIdType TxPduId, uint16_t serviceId,
+                                               uint16_t methodId, uint8_t interfaceVersion,
+                                               uint8_t messageType,
+                                               SomeIp_OnTpCopyTxDataFncType onTpCopyTxData,
+                                               SomeIp_TxTpMsgType *var, uint16_t *budget) {
+  Std_ReturnType ret = E_OK;
+  uint16_t window = 0;
+  uint32_t offset;
+  boolean progress = TRUE;
+
+  while ((E_OK == ret) && progress && (var->offset < var->length) &&
+         (window < SOMEIP_TP_TX_WINDOW) && ((NULL == budget) || (*budget > 0)) &&
+         SOMEIP_TP_TX_PACED(var)) {
+    offset = var->offset;
+    ret = SomeIp_SendNextTxTpMsg(TxPduId, serviceId, methodId, interfaceVersion, messageType,
+                                 onTpCopyTxData, var);
+    progress = (offset != var->offset); /* FALSE for OoM or Tx NOK retry */
+    if (progress) {
+      SOMEIP_TP_TX_PACE(var);
+      if (NULL != budget) {
+        (*budget)--;
+      }
+      window++;
+    }
+  }
+
+  return ret;
+}
+
+static Std_ReturnType SomeIp_SendTxTpEvtMsgWindow(const SomeIp_ServerServiceType *config,
+                                                  const SomeIp_ServerEventType *event,
+                                                  SomeIp_TxTpEvtMsgType *var,
+                                                  Sd_EventHandlerSubscriberListType *list,
+                                                  uint16_t *budget) {
+  Std_ReturnType ret = E_OK;
+  uint16_t window = 0;
+  uint32_t offset;
+  boolean progress = TRUE;
+
+  while ((E_OK == ret) && progress && (var->offset < var->length) &&
+         (window < SOMEIP_TP_TX_WINDOW) && ((NULL == budget) || (*budget > 0)) &&
+         SOMEIP_TP_TX_PACED(var)) {
+    offset = var->offset;
+    ret = SomeIp_SendNextTxTpEvtMsg(config, event, var, list);
+    progress = (offset != var->offset);
+    if (progress) {
+      SOMEIP_TP_TX_PACE(var);
+      if (NULL != budget) {
+        (*budget)--;
+      }
+      window++;
+    }
+  }
+
+  return ret;
+}
+
 static Std_ReturnType SomeIp_ReplyRequest(const SomeIp_ServerServiceType *config, uint16_t conId,
                                           uint16_t methodId, uint16_t clientId, uint16_t sessionId,
                                           TcpIp_SockAddrType *RemoteAddr, SomeIp_MessageType *res) {
@@ -683,9 +771,12 @@ static Std_ReturnType SomeIp_ReplyRequest(const SomeIp_ServerServiceType *config
       var->retryCounter = 0;
 #endif
       var->timer = config->SeparationTime;
-      ret = SomeIp_SendNextTxTpMsg(connection->TxPduId, config->serviceId, method->methodId,
-                                   method->interfaceVersion, SOMEIP_MSG_RESPONSE,
-                                   method->onTpCopyTxData, var);
+#ifdef SOMEIP_TP_TX_PACING_US
+      var->deadline = 0;
+#endif
+      ret = SomeIp_SendTxTpMsgWindow(connection->TxPduId, config->serviceId, method->methodId,
+                                     method->interfaceVersion, SOMEIP_MSG_RESPONSE,
+                                     method->onTpCopyTxData, var, NULL);
       if (E_OK == ret) {
         SQP_CAPPEND(TxTpMsg);
       } else {
@@ -704,8 +795,9 @@ static Std_ReturnType SomeIp_ReplyRequest(const SomeIp_ServerServiceType *config
   return ret;
 }
 
+/* registered before the request goes out, so a response can't come before it */
 static Std_ReturnType SomeIp_WaitResponse(const SomeIp_ClientServiceType *config, uint16_t methodId,
-                                          uint16_t sessionId) {
+                                          uint16_t sessionId, uint16_t timer, uint16_t timeout) {
   Std_ReturnType ret = E_OK;
   SomeIp_ClientServiceContextType *context = config->context;
   SomeIp_WaitResMsgType *var;
@@ -714,7 +806,9 @@ static Std_ReturnType SomeIp_WaitResponse(const SomeIp_ClientServiceType *config
   if (NULL != var) {
     var->methodId = methodId;
     var->sessionId = sessionId;
-    var->timer = config->ResponseTimeout;
+    var->timer = timer;
+    var->timeout = timeout;
+    var->canceled = FALSE;
     SQP_CAPPEND(WaitResMsg);
   } else {
     ASLOG(SOMEIPE, ("OoM for wait res msg\n"));
@@ -724,10 +818,33 @@ static Std_ReturnType SomeIp_WaitResponse(const SomeIp_ClientServiceType *config
   return ret;
 }
 
+/* start the response timer once the request is sent, or drop the waiter if it failed or was
+ * canceled. This may be called by any thread, so the waiter is only marked here and removed by
+ * the main function which walks the list without holding the lock. */
+static void SomeIp_WaitResponseUpdate(const SomeIp_ClientServiceType *config, uint16_t methodId,
+                                      uint16_t sessionId, boolean sent) {
+  SomeIp_ClientServiceContextType *context = config->context;
+  SomeIp_WaitResMsgType *var;
+
+  EnterCritical();
+  STAILQ_FOREACH(var, &context->pendingWaitResMsgs, entry) {
+    if ((var->methodId == methodId) && (var->sessionId == sessionId) &&
+        (FALSE == var->canceled)) {
+      if (sent) {
+        var->timer = var->timeout;
+      } else {
+        var->canceled = TRUE;
+      }
+      break;
+    }
+  }
+  ExitCritical();
+}
+
 static Std_ReturnType SomeIp_SendRequest(const SomeIp_ClientServiceType *config, uint16_t methodId,
                                          uint16_t clientId, uint16_t sessionId,
                                          TcpIp_SockAddrType *RemoteAddr, SomeIp_MessageType *req,
-                                         uint8_t messageType) {
+                                         uint8_t messageType, uint16_t timeout) {
   Std_ReturnType ret = E_OK;
   SomeIp_ClientServiceContextType *context = config->context;
   const SomeIp_ClientMethodType *method = &config->methods[methodId];
@@ -748,10 +865,24 @@ static Std_ReturnType SomeIp_SendRequest(const SomeIp_ClientServiceType *config,
       var->retryCounter = 0;
 #endif
       var->timer = config->SeparationTime;
-      ret =
-        SomeIp_SendNextTxTpMsg(config->TxPduId, config->serviceId, method->methodId,
-                               method->interfaceVersion, messageType, method->onTpCopyTxData, var);
+#ifdef SOMEIP_TP_TX_PACING_US
+      var->deadline = 0;
+#endif
+      ret = SomeIp_WaitResponse(config, methodId, sessionId, SOMEIP_WAIT_RES_SENDING, timeout);
       if (E_OK == ret) {
+        ret = SomeIp_SendTxTpMsgWindow(config->TxPduId, config->serviceId, method->methodId,
+                                       method->interfaceVersion, messageType,
+                                       method->onTpCopyTxData, var, NULL);
+        if (E_OK != ret) {
+          SomeIp_WaitResponseUpdate(config, methodId, sessionId, FALSE);
+        } else if (var->offset >= var->length) {
+          /* all sent by the window */
+          SomeIp_WaitResponseUpdate(config, methodId, sessionId, TRUE);
+        } else {
+          /* the rest is sent by the main function */
+        }
+      }
+      if ((E_OK == ret) && (var->offset < var->length)) {
         SQP_CAPPEND(TxTpMsg);
       } else {
         SQP_FREE(TxTpMsg);
@@ -764,13 +895,16 @@ static Std_ReturnType SomeIp_SendRequest(const SomeIp_ClientServiceType *config,
     data = Net_MemAlloc(req->length + 16);
     if (NULL != data) {
       memcpy(&data[16], req->data, req->length);
-      ret = SomeIp_Transmit(config->TxPduId, RemoteAddr, data, config->serviceId, method->methodId,
-                            clientId, sessionId, method->interfaceVersion, messageType, E_OK,
-                            req->length);
-      Net_MemFree(data);
+      ret = SomeIp_WaitResponse(config, methodId, sessionId, timeout, timeout);
       if (E_OK == ret) {
-        ret = SomeIp_WaitResponse(config, methodId, sessionId);
+        ret = SomeIp_Transmit(config->TxPduId, RemoteAddr, data, config->serviceId,
+                              method->methodId, clientId, sessionId, method->interfaceVersion,
+                              messageType, E_OK, req->length);
+        if (E_OK != ret) {
+          SomeIp_WaitResponseUpdate(config, methodId, sessionId, FALSE);
+        }
       }
+      Net_MemFree(data);
     } else {
       ASLOG(SOMEIPE, ("OoM for request SF Tx\n"));
       ret = E_NOT_OK;
@@ -780,14 +914,16 @@ static Std_ReturnType SomeIp_SendRequest(const SomeIp_ClientServiceType *config,
   return ret;
 }
 
+/* the ResponseTimeout of the service is used if timeoutMs is 0 */
 static Std_ReturnType SomeIp_RequestOrFire(uint32_t requestId, uint8_t *data, uint32_t length,
-                                           uint8_t messageType) {
+                                           uint8_t messageType, uint32_t timeoutMs) {
   Std_ReturnType ret = E_OK;
   uint16_t TxMethodId = (requestId >> 16) & 0xFFFF;
   uint16_t sessionId = requestId & 0xFFFF;
   const SomeIp_ClientServiceType *config;
   SomeIp_ClientServiceContextType *context;
   uint16_t index;
+  uint16_t timeout;
   TcpIp_SockAddrType RemoteAddr;
   SomeIp_MessageType msg;
 
@@ -812,8 +948,15 @@ static Std_ReturnType SomeIp_RequestOrFire(uint32_t requestId, uint8_t *data, ui
   }
 
   if (E_OK == ret) {
+    if (0 == timeoutMs) {
+      timeout = config->ResponseTimeout;
+    } else if (timeoutMs < (SOMEIP_MAIN_FUNCTION_PERIOD * (uint32_t)SOMEIP_WAIT_RES_SENDING)) {
+      timeout = (uint16_t)SOMEIP_CONVERT_MS_TO_MAIN_CYCLES(timeoutMs);
+    } else {
+      timeout = SOMEIP_WAIT_RES_SENDING - 1;
+    }
     ret = SomeIp_SendRequest(config, index, config->clientId, sessionId, &RemoteAddr, &msg,
-                             messageType);
+                             messageType, timeout);
   }
 
   return ret;
@@ -838,7 +981,10 @@ static Std_ReturnType SomeIp_SendNotification(const SomeIp_ServerServiceType *co
       var->offset = 0;
       var->length = req->length;
       var->timer = config->SeparationTime;
-      ret = SomeIp_SendNextTxTpEvtMsg(config, event, var, list);
+#ifdef SOMEIP_TP_TX_PACING_US
+      var->deadline = 0;
+#endif
+      ret = SomeIp_SendTxTpEvtMsgWindow(config, event, var, list, NULL);
       if (E_OK == ret) {
         SQP_CAPPEND(TxTpEvtMsg);
       } else {
@@ -978,7 +1124,8 @@ static Std_ReturnType SomeIp_IsResponseExpected(const SomeIp_ClientServiceType *
   EnterCritical();
   if ((FALSE == msg->header.isTpFlag) || (0 == msg->tpHeader.offset)) {
     STAILQ_FOREACH(var, &context->pendingWaitResMsgs, entry) {
-      if ((var->methodId == methodId) && (var->sessionId == msg->header.sessionId)) {
+      if ((var->methodId == methodId) && (var->sessionId == msg->header.sessionId) &&
+          (FALSE == var->canceled)) {
         ret = E_OK;
         SQP_CRM_AND_FREE(WaitResMsg);
         break;
@@ -1152,7 +1299,7 @@ static Std_ReturnType SomeIp_HandleClientMessage(const SomeIp_ClientServiceType
   return ret;
 }
 
-static void SomeIp_MainServerAsyncRequest(const SomeIp_ServerServiceType *config, uint16_t conId) {
+static void SomeIp_PollServerAsyncRequest(const SomeIp_ServerServiceType *config, uint16_t conId) {
   const SomeIp_ServerConnectionType *connection = &config->connections[conId];
   SomeIp_ServerConnectionContextType *context = connection->context;
   DEC_SQP(AsyncReqMsg);
@@ -1167,7 +1314,7 @@ static void SomeIp_MainServerAsyncRequest(const SomeIp_ServerServiceType *config
     if (NULL != resData) {
       res.data = &resData[16];
       res.length = method->resMaxLen;
-      ret = method->onAsyncRequest(conId, &res);
+      ret = method->onAsyncRequest(((uint32_t)var->clientId << 16) + var->sessionId, &res);
       if (res.data != &resData[16]) {
         if (IS_TP_ENABLED(method) && (res.length > SOMEIP_SF_MAX)) {
           /* OK for TP case */
@@ -1204,6 +1351,33 @@ static void SomeIp_MainServerAsyncRequest(const SomeIp_ServerServiceType *config
   SQP_WHILE_END()
 }
 
+/* polled by the main function and the connection owner, only one of them at a time */
+static void SomeIp_MainServerAsyncRequest(const SomeIp_ServerServiceType *config, uint16_t conId) {
+  SomeIp_ServerConnectionContextType *context = config->connections[conId].context;
+  boolean poll = FALSE;
+
+  EnterCritical();
+  if (0 == context->asyncPollState) {
+    context->asyncPollState = 1;
+    poll = TRUE;
+  } else { /* the one in polling polls it once more */
+    context->asyncPollState = 2;
+  }
+  ExitCritical();
+
+  while (poll) {
+    SomeIp_PollServerAsyncRequest(config, conId);
+    EnterCritical();
+    if (2 == context->asyncPollState) {
+      context->asyncPollState = 1;
+    } else {
+      context->asyncPollState = 0;
+      poll = FALSE;
+    }
+    ExitCritical();
+  }
+}
+
 static void SomeIp_MainServerRxTpMsg(const SomeIp_ServerServiceType *config, uint16_t conId) {
   const SomeIp_ServerConnectionType *connection = &config->connections[conId];
   SomeIp_ServerConnectionContextType *context = connection->context;
@@ -1248,9 +1422,9 @@ static void SomeIp_MainServerTxTpMsg(const SomeIp_ServerServiceType *config, uin
       var->timer--;
     }
     if (0 == var->timer) {
-      ret = SomeIp_SendNextTxTpMsg(connection->TxPduId, config->serviceId, method->methodId,
-                                   method->interfaceVersion, SOMEIP_MSG_RESPONSE,
-                                   method->onTpCopyTxData, var);
+      ret = SomeIp_SendTxTpMsgWindow(connection->TxPduId, config->serviceId, method->methodId,
+                                     method->interfaceVersion, SOMEIP_MSG_RESPONSE,
+                                     method->onTpCopyTxData, var, &someIpTpTxBudgetMethod);
       if (E_OK == ret) {
         if (var->offset >= var->length) {
           SQP_CRM_AND_FREE(TxTpMsg);
@@ -1282,7 +1456,7 @@ static void SomeIp_MainServerTxTpEvtMsg(const SomeIp_ServerServiceType *config)
       /* NOTE: may result partial data send to later online subscribers */
       ret = Sd_GetSubscribers(event->sdHandleID, &list);
       if (E_OK == ret) {
-        ret = SomeIp_SendNextTxTpEvtMsg(config, event, var, list);
+        ret = SomeIp_SendTxTpEvtMsgWindow(config, event, var, list, &someIpTpTxBudgetEvent);
         if (E_OK == ret) {
           if (var->offset >= var->length) {
             SQP_CRM_AND_FREE(TxTpEvtMsg);
@@ -1365,15 +1539,16 @@ static void SomeIp_MainClientTxTpMsg(const SomeIp_ClientServiceType *config) {
       var->timer--;
     }
     if (0 == var->timer) {
-      ret = SomeIp_SendNextTxTpMsg(config->TxPduId, config->serviceId, method->methodId,
-                                   method->interfaceVersion, SOMEIP_MSG_REQUEST,
-                                   method->onTpCopyTxData, var);
+      ret = SomeIp_SendTxTpMsgWindow(config->TxPduId, config->serviceId, method->methodId,
+                                     method->interfaceVersion, SOMEIP_MSG_REQUEST,
+                                     method->onTpCopyTxData, var, &someIpTpTxBudgetMethod);
       if (E_OK == ret) {
         if (var->offset >= var->length) {
+          SomeIp_WaitResponseUpdate(config, var->methodId, var->sessionId, TRUE);
           SQP_CRM_AND_FREE(TxTpMsg);
-          (void)SomeIp_WaitResponse(config, var->methodId, var->sessionId);
         }
       } else { /* abort this tx */
+        SomeIp_WaitResponseUpdate(config, var->methodId, var->sessionId, FALSE);
         SQP_CRM_AND_FREE(TxTpMsg);
       }
     }
@@ -1389,10 +1564,12 @@ static void SomeIp_MainClientWaitResMsg(const SomeIp_ClientServiceType *config)
 
   SQP_WHILE(WaitResMsg) {
     method = &config->methods[var->methodId];
-    if (var->timer > 0) {
+    if ((var->timer > 0) && (SOMEIP_WAIT_RES_SENDING != var->timer)) {
       var->timer--;
     }
-    if (0 == var->timer) {
+    if (var->canceled) {
+      SQP_CRM_AND_FREE(WaitResMsg);
+    } else if (0 == var->timer) {
       requestId = ((uint32_t)var->methodId << 16) + var->sessionId;
       method->onError(requestId, SOMEIPXF_E_TIMEOUT);
       SQP_CRM_AND_FREE(WaitResMsg);
@@ -1478,6 +1655,175 @@ static Std_ReturnType SomeIp_HandleRxMsg(PduIdType RxPduId, SomeIp_MsgType *msg)
 
   return ret;
 }
+
+#ifdef SOMEIP_TCP_RING_SIZE
+static void SomeIp_TcpRingDeliver(PduIdType RxPduId, uint8_t *header, uint8_t *data,
+                                  uint32_t length, const TcpIp_SockAddrType *RemoteAddr) {
+  Std_ReturnType ret;
+  SomeIp_MsgType msg;
+
+  ret = SomeIp_DecodeMsgTcp(header, data, length, RemoteAddr, &msg);
+  if (E_OK == ret) {
+    SomeIp_HandleRxMsg(RxPduId, &msg);
+  } else {
+    ASLOG(SOMEIPE, ("TCP message malformed: %d\n", ret));
+  }
+}
+
+static void SomeIp_TcpRingPeek(SomeIp_TcpBufferType *tcpBuf, uint32_t offset, uint8_t *data,
+                               uint32_t length) {
+  uint32_t pos = (tcpBuf->head + offset) % SOMEIP_TCP_RING_SIZE;
+  uint32_t len = SOMEIP_TCP_RING_SIZE - pos;
+
+  if (len > length) {
+    len = length;
+  }
+  memcpy(data, &tcpBuf->ring[pos], len);
+  if (len < length) {
+    memcpy(&data[len], tcpBuf->ring, length - len);
+  }
+}
+
+static uint32_t SomeIp_TcpMsgLength(const uint8_t *header) {
+  uint32_t length = ((uint32_t)header[4] << 24) + ((uint32_t)header[5] << 16) +
+                    ((uint32_t)header[6] << 8) + header[7];
+  if (length < 8) {
+    length = 0; /* malformed */
+  } else {
+    length += 8;
+  }
+  return length;
+}
+
+/* deliver the complete messages in the ring, return FALSE if the stream is broken */
+static boolean SomeIp_TcpRingParse(PduIdType RxPduId, SomeIp_TcpBufferType *tcpBuf,
+                                   const TcpIp_SockAddrType *RemoteAddr) {
+  boolean ok = TRUE;
+  boolean more = TRUE;
+  uint8_t header[16];
+  uint32_t length;
+  uint8_t *data;
+
+  while (more && ok && (tcpBuf->count >= sizeof(header))) {
+    SomeIp_TcpRingPeek(tcpBuf, 0, header, sizeof(header));
+    length = SomeIp_TcpMsgLength(header);
+    if (0 == length) {
+      ok = FALSE;
+    } else if (length > SOMEIP_TCP_RING_SIZE) {
+      /* collect it in a dedicated buffer the way without the ring */
+      tcpBuf->data = Net_MemAlloc(length - 16);
+      if (NULL != tcpBuf->data) {
+        memcpy(tcpBuf->header, header, sizeof(header));
+        tcpBuf->lenOfHd = sizeof(header);
+        tcpBuf->length = length - 16;
+        tcpBuf->offset = tcpBuf->count - 16;
+        SomeIp_TcpRingPeek(tcpBuf, 16, tcpBuf->data, tcpBuf->offset);
+        tcpBuf->head = 0;
+        tcpBuf->count = 0;
+      } else {
+        ASLOG(SOMEIPE, ("OoM for tcp buffer, abort\n"));
+        ok = FALSE;
+      }
+      more = FALSE;
+    } else if (length > tcpBuf->count) {
+      more = FALSE;
+    } else {
+      if ((tcpBuf->head + length) <= SOMEIP_TCP_RING_SIZE) {
+        data = &tcpBuf->ring[tcpBuf->head];
+        SomeIp_TcpRingDeliver(RxPduId, data, &data[16], length - 16, RemoteAddr);
+      } else {
+        /* wrapped around the end of the ring, linearize it */
+        data = Net_MemAlloc(length);
+        if (NULL != data) {
+          SomeIp_TcpRingPeek(tcpBuf, 0, data, length);
+          SomeIp_TcpRingDeliver(RxPduId, data, &data[16], length - 16, RemoteAddr);
+          Net_MemFree(data);
+        } else {
+          ASLOG(SOMEIPE, ("OoM to linearize tcp message, drop it\n"));
+        }
+      }
+      tcpBuf->head = (tcpBuf->head + length) % SOMEIP_TCP_RING_SIZE;
+      tcpBuf->count -= length;
+    }
+  }
+
+  if (0 == tcpBuf->count) {
+    tcpBuf->head = 0;
+  }
+
+  return ok;
+}
+
+static BufReq_ReturnType SomeIp_TcpRingCopyRxData(PduIdType RxPduId, SomeIp_TcpBufferType *tcpBuf,
+                                                  const PduInfoType *PduInfoPtr,
+                                                  PduLengthType *bufferSizePtr) {
+  const TcpIp_SockAddrType *RemoteAddr = (const TcpIp_SockAddrType *)PduInfoPtr->MetaDataPtr;
+  BufReq_ReturnType bret = BUFREQ_OK;
+  uint8_t *data = PduInfoPtr->SduDataPtr;
+  uint32_t left = PduInfoPtr->SduLength;
+  uint32_t length;
+  uint32_t pos;
+  boolean ok = TRUE;
+
+  while ((left > 0) && ok) {
+    if (NULL != tcpBuf->data) {
+      length = tcpBuf->length - tcpBuf->offset;
+      if (length > left) {
+        length = left;
+      }
+      memcpy(&tcpBuf->data[tcpBuf->offset], data, length);
+      data += length;
+      left -= length;
+      tcpBuf->offset += length;
+      if (tcpBuf->offset >= tcpBuf->length) {
+        SomeIp_TcpRingDeliver(RxPduId, tcpBuf->header, tcpBuf->data, tcpBuf->length,
+                              RemoteAddr);
+        Net_MemFree(tcpBuf->data);
+        tcpBuf->data = NULL;
+        tcpBuf->lenOfHd = 0;
+      }
+    } else if ((0 == tcpBuf->count) && (left >= 16) &&
+               (SomeIp_TcpMsgLength(data) > 0) && (SomeIp_TcpMsgLength(data) <= left)) {
+      /* a complete message in the segment, no copy at all */
+      length = SomeIp_TcpMsgLength(data);
+      SomeIp_TcpRingDeliver(RxPduId, data, &data[16], length - 16, RemoteAddr);
+      data += length;
+      left -= length;
+    } else {
+      length = SOMEIP_TCP_RING_SIZE - tcpBuf->count;
+      if (length > left) {
+        length = left;
+      }
+      pos = (tcpBuf->head + tcpBuf->count) % SOMEIP_TCP_RING_SIZE;
+      if ((pos + length) <= SOMEIP_TCP_RING_SIZE) {
+        memcpy(&tcpBuf->ring[pos], data, length);
+      } else {
+        memcpy(&tcpBuf->ring[pos], data, SOMEIP_TCP_RING_SIZE - pos);
+        memcpy(tcpBuf->ring, &data[SOMEIP_TCP_RING_SIZE - pos],
+               length - (SOMEIP_TCP_RING_SIZE - pos));
+      }
+      tcpBuf->count += length;
+      data += length;
+      left -= length;
+      ok = SomeIp_TcpRingParse(RxPduId, tcpBuf, RemoteAddr);
+    }
+  }
+
+  if (FALSE == ok) {
+    ASLOG(SOMEIPE, ("TCP stream broken, drop %u bytes\n", tcpBuf->count + left));
+    tcpBuf->head = 0;
+    tcpBuf->count = 0;
+    bret = BUFREQ_E_NOT_OK;
+  } else if (NULL != tcpBuf->data) {
+    /* the rest of the long message being collected */
+    *bufferSizePtr = tcpBuf->length - tcpBuf->offset;
+  } else {
+    *bufferSizePtr = SOMEIP_TCP_RING_SIZE - tcpBuf->count;
+  }
+
+  return bret;
+}
+#endif
 /* ================================ [ FUNCTIONS ] ============================================== */
 void SomeIp_RxIndication(PduIdType RxPduId, const PduInfoType *PduInfoPtr) {
   SomeIp_MsgType msg;
@@ -1524,6 +1870,16 @@ BufReq_ReturnType SomeIp_SoAdTpCopyRxData(PduIdType RxPduId, const PduInfoType *
   }
 
   *bufferSizePtr = 0;
+  if ((NULL != tcpBuf) && (0 == PduInfoPtr->SduLength)) {
+    /* SoAd asks for the room, a message is buffered as it comes, so no limit */
+    *bufferSizePtr = PDU_LENGHT_MAX;
+    bret = BUFREQ_OK;
+  } else
+#ifdef SOMEIP_TCP_RING_SIZE
+  if (NULL != tcpBuf) {
+    bret = SomeIp_TcpRingCopyRxData(RxPduId, tcpBuf, PduInfoPtr, bufferSizePtr);
+  } else
+#endif
   if (NULL != tcpBuf) {
     PduInfo = *PduInfoPtr;
     ASLOG(SOMEIP, ("Tcp input(%d)\n", PduInfo.SduLength));
@@ -1662,11 +2018,34 @@ void SomeIp_SoConModeChg(SoAd_SoConIdType SoConId, SoAd_SoConModeType Mode) {
 }
 
 Std_ReturnType SomeIp_Request(uint32_t requestId, uint8_t *data, uint32_t length) {
-  return SomeIp_RequestOrFire(requestId, data, length, SOMEIP_MSG_REQUEST);
+  return SomeIp_RequestOrFire(requestId, data, length, SOMEIP_MSG_REQUEST, 0);
+}
+
+Std_ReturnType SomeIp_RequestWithTimeout(uint32_t requestId, uint8_t *data, uint32_t length,
+                                         uint32_t timeoutMs) {
+  return SomeIp_RequestOrFire(requestId, data, length, SOMEIP_MSG_REQUEST, timeoutMs);
+}
+
+Std_ReturnType SomeIp_CancelRequest(uint32_t requestId) {
+  Std_ReturnType ret = E_OK;
+  uint16_t TxMethodId = (requestId >> 16) & 0xFFFF;
+  const SomeIp_ClientServiceType *config;
+  uint16_t index;
+
+  if (TxMethodId < SOMEIP_CONFIG->numOfTxMethods) {
+    index = SOMEIP_CONFIG->TxMethod2ServiceMap[TxMethodId];
+    config = (const SomeIp_ClientServiceType *)SOMEIP_CONFIG->services[index].service;
+    index = SOMEIP_CONFIG->TxMethod2PerServiceMap[TxMethodId];
+    SomeIp_WaitResponseUpdate(config, index, requestId & 0xFFFF, FALSE);
+  } else {
+    ret = E_NOT_OK;
+  }
+
+  return ret;
 }
 
 Std_ReturnType SomeIp_FireForgot(uint32_t requestId, uint8_t *data, uint32_t length) {
-  return SomeIp_RequestOrFire(requestId, data, length, SOMEIP_MSG_REQUEST_NO_RETURN);
+  return SomeIp_RequestOrFire(requestId, data, length, SOMEIP_MSG_REQUEST_NO_RETURN, 0);
 }
 
 Std_ReturnType SomeIp_Notification(uint32_t requestId, uint8_t *data, uint32_t length) {
@@ -1755,6 +2134,8 @@ void SomeIp_Init(const SomeIp_ConfigType *ConfigPtr) {
   SQP_INIT(RxTpMsg);
   SQP_INIT(TxTpEvtMsg);
   SQP_INIT(WaitResMsg);
+  someIpTpTxBudgetMethod = SOMEIP_TP_TX_BUDGET_METHOD;
+  someIpTpTxBudgetEvent = SOMEIP_TP_TX_BUDGET_EVENT;
   for (i = 0; i < SOMEIP_CONFIG->numOfService; i++) {
     if (SOMEIP_CONFIG->services[i].isServer) {
       SomeIp_InitServer((const SomeIp_ServerServiceType *)SOMEIP_CONFIG->services[i].service);
@@ -1766,6 +2147,8 @@ void SomeIp_Init(const SomeIp_ConfigType *ConfigPtr) {
 
 void SomeIp_MainFunction(void) {
   int i;
+  someIpTpTxBudgetMethod = SOMEIP_TP_TX_BUDGET_METHOD;
+  someIpTpTxBudgetEvent = SOMEIP_TP_TX_BUDGET_EVENT;
   for (i = 0; i < SOMEIP_CONFIG->numOfService; i++) {
     if (SOMEIP_CONFIG->services[i].isServer) {
       SomeIp_MainServer((const SomeIp_ServerServiceType *)SOMEIP_CONFIG->services[i].service);
@@ -1817,3 +2200,66 @@ Std_ReturnType SomeIp_ConnectionRxControl(uint16_t serviceId, uint16_t conId, ui
 
   return ret;
 }
+
+Std_ReturnType SomeIp_ConnectionAsyncControl(uint16_t serviceId, uint16_t conId) {
+  Std_ReturnType ret = E_NOT_OK;
+  const SomeIp_ServerServiceType *config;
+  const SomeIp_ServerConnectionType *connection;
+  SomeIp_ServerConnectionContextType *context;
+
+  if (serviceId < SOMEIP_CONFIG->numOfService) {
+    if (SOMEIP_CONFIG->services[serviceId].isServer) {
+      config = SOMEIP_CONFIG->services[serviceId].service;
+      connection = &config->connections[conId];
+      context = connection->context;
+      if (TRUE == context->takenControled) {
+        SomeIp_MainServerAsyncRequest(config, conId);
+        ret = E_OK;
+      }
+    }
+  }
+
+  return ret;
+}
+
+Std_ReturnType SomeIp_ConnectionGetSocket(uint16_t serviceId, uint16_t conId,
+                                          TcpIp_SocketIdType *SocketIdPtr) {
+  Std_ReturnType ret = E_NOT_OK;
+  const SomeIp_ServerServiceType *config;
+  const SomeIp_ServerConnectionType *connection;
+  SomeIp_ServerConnectionContextType *context;
+
+  if (serviceId < SOMEIP_CONFIG->numOfService) {
+    if (SOMEIP_CONFIG->services[serviceId].isServer) {
+      config = SOMEIP_CONFIG->services[serviceId].service;
+      connection = &config->connections[conId];
+      context = connection->context;
+      if (TRUE == context->takenControled) {
+        ret = SoAd_GetSocket(connection->SoConId, SocketIdPtr);
+      }
+    }
+  }
+
+  return ret;
+}
+
+Std_ReturnType SomeIp_ConnectionClose(uint16_t serviceId, uint16_t conId) {
+  Std_ReturnType ret = E_NOT_OK;
+  const SomeIp_ServerServiceType *config;
+  const SomeIp_ServerConnectionType *connection;
+  SomeIp_ServerConnectionContextType *context;
+
+  if (serviceId < SOMEIP_CONFIG->numOfService) {
+    if (SOMEIP_CONFIG->services[serviceId].isServer) {
+      config = SOMEIP_CONFIG->services[serviceId].service;
+      connection = &config->connections[conId];
+      context = connection->context;
+      if (TRUE == context->takenControled) {
+        context->takenControled = FALSE;
+        ret = SoAd_CloseSoCon(connection->SoConId, TRUE);
+      }
+    }
+  }
+
+  return ret;
+}
@@ -7,6 +7,10 @@
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "ComStack_Types.h"
 #include "TcpIp.h"
+#include "SomeIp_Cfg.h"
+#ifdef SOMEIP_TP_TX_PACING_US
+#include "Std_Timer.h"
+#endif
 #include "sys/queue.h"
 /* ================================ [ MACROS    ] ============================================== */
 /* ================================ [ TYPES     ] ============================================== */
@@ -130,6 +134,9 @@ typedef struct SomeIp_TxTpMsg_s {
 #ifndef DISABLE_SOMEIP_TX_NOK_RETRY
   uint8_t retryCounter;
 #endif
+#ifdef SOMEIP_TP_TX_PACING_US
+  std_time_t deadline; /* when the next segment is allowed to be sent */
+#endif
 } SomeIp_TxTpMsgType;
 
 typedef struct SomeIp_TxTpEvtMsg_s {
@@ -139,6 +146,9 @@ typedef struct SomeIp_TxTpEvtMsg_s {
   uint16_t eventId; /* this is the key */
   uint16_t sessionId;
   uint16_t timer;
+#ifdef SOMEIP_TP_TX_PACING_US
+  std_time_t deadline;
+#endif
 } SomeIp_TxTpEvtMsgType;
 
 typedef struct SomeIp_WaitResMsg_s {
@@ -146,6 +156,9 @@ typedef struct SomeIp_WaitResMsg_s {
   uint16_t methodId;
   uint16_t sessionId;
   uint16_t timer;
+  uint16_t timeout; /* the timer once the request is sent */
+  /* dropped by a failed send or a cancel, freed by the main function without any error */
+  boolean canceled;
 } SomeIp_WaitResMsgType;
 
 /* For TCP large messages */
@@ -155,6 +168,13 @@ typedef struct {
   uint32_t offset;
   uint8_t header[16];
   uint8_t lenOfHd;
+#ifdef SOMEIP_TCP_RING_SIZE
+  /* the stream is kept here and parsed in place, data above is only for the messages larger than
+   * the ring */
+  uint8_t ring[SOMEIP_TCP_RING_SIZE];
+  uint32_t head;
+  uint32_t count;
+#endif
 } SomeIp_TcpBufferType;
 
 typedef STAILQ_HEAD(rxTpMsgHead, SomeIp_RxTpMsg_s) SomeIp_RxTpMsgList;
@@ -169,6 +189,9 @@ typedef struct {
   SomeIp_TxTpEvtMsgList pendingTxTpEvtMsgs;
   bool online;
   bool takenControled;
+  /* the async requests are polled by the main function and the connection owner, 0: idle,
+   * 1: in polling, 2: in polling and to be polled again */
+  uint8_t asyncPollState;
 } SomeIp_ServerConnectionContextType;
 
 typedef struct {
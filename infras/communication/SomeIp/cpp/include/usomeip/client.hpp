@@ -2,15 +2,19 @@
  * SSAS - Simple Smart Automotive Software
  * Copyright (C) 2022 Parai Wang <parai@foxmail.com>
  */
-#ifndef _USOMEIP_SERVER_HPP_
-#define _USOMEIP_SERVER_HPP_
+#ifndef _USOMEIP_CLIENT_HPP_
+#define _USOMEIP_CLIENT_HPP_
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "usomeip/usomeip.hpp"
+#include <future>
 namespace as {
 namespace usomeip {
 namespace client {
 using namespace as::usomeip;
 /* ================================ [ MACROS    ] ============================================== */
+#ifndef USOMEIP_CLIENT_TIMEOUT_MS
+#define USOMEIP_CLIENT_TIMEOUT_MS 1000
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 class Client {
 public:
@@ -24,11 +28,26 @@ public:
 
   void identity(uint16_t clientId);
   void require(uint16_t serviceId);
-  void bind(uint16_t methodId, BufferPool *bp = nullptr);
-  void listen(uint16_t eventId, BufferPool *bp = nullptr);
+  /* borrow: the short response or notification is given without copy, see Message::borrow */
+  void bind(uint16_t methodId, BufferPool *bp = nullptr, bool borrow = false);
+  void listen(uint16_t eventId, BufferPool *bp = nullptr, bool borrow = false);
   void subscribe(uint16_t eventGroupId);
 
   void request(uint32_t requestId, std::shared_ptr<Buffer> buffer);
+
+  /* the callback is invoked exactly once with the RESPONSE message, or an ERROR message whose
+   * returnCode tells the error, timeout or cancel */
+  typedef std::function<void(std::shared_ptr<Message> msg)> ResponseCallback;
+
+  /* request with a session ID allocated by the method client, many requests can be outstanding
+   * at the same time. The response of it is not given to onResponse/onError, so don't mix with
+   * request() on the same method. Return the requestId for cancel, or 0 if failed. */
+  uint32_t async_request(uint16_t methodId, std::shared_ptr<Buffer> buffer,
+                         ResponseCallback callback, uint32_t timeoutMs = USOMEIP_CLIENT_TIMEOUT_MS);
+  std::future<std::shared_ptr<Message>>
+  async_request(uint16_t methodId, std::shared_ptr<Buffer> buffer,
+                uint32_t timeoutMs = USOMEIP_CLIENT_TIMEOUT_MS, uint32_t *requestId = nullptr);
+  bool cancel(uint32_t requestId);
 };
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
@@ -53,4 +72,4 @@ void on_availability(uint16_t clientId, boolean isAvailable);
 } // namespace client
 } // namespace usomeip
 } /* namespace as */
-#endif /* _USOMEIP_SERVER_HPP_ */
+#endif /* _USOMEIP_CLIENT_HPP_ */
@@ -6,6 +6,7 @@
 #define _USOMEIP_SERVER_HPP_
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "usomeip/usomeip.hpp"
+#include <atomic>
 namespace as {
 namespace usomeip {
 namespace server {
@@ -23,7 +24,9 @@ public:
 
   void identity(uint16_t serviceId);
   void offer(uint16_t serviceId);
-  void listen(uint16_t methodId, BufferPool *bp = nullptr);
+  /* borrow: the short request is given to onRequest/onFireForgot without copy, see
+   * Message::borrow */
+  void listen(uint16_t methodId, BufferPool *bp = nullptr, bool borrow = false);
   void provide(uint16_t eventGroupId);
 
   // requestId is eventId + sessionId
@@ -36,15 +39,32 @@ public:
     Server *self;
     uint16_t conId;
     osal_thread_t thread;
-    bool online;
+    std::atomic<bool> online;
+    /* for the reactor mode */
+    bool reactor;
+    int loop;
+    TcpIp_SocketIdType sock;
+    std::atomic<bool> inRx;
   };
   void run_rx(Connection *con);
+  void run_event(Connection *con, bool hangup, std::vector<uint8_t> &data);
+
+private:
+  bool attach(Connection *con);
 
 private:
   uint16_t m_Identity = -1;
   std::map<uint16_t, Connection *> m_ConnectionMap;
   std::mutex m_Lock;
 };
+
+struct ReactorConfig {
+  int numOfLoops = 1;   /* the epoll loops which serve the connections of all the servers */
+  int numOfWorkers = 4; /* the threads which run the request handlers */
+  /* pin the loop or worker i to the cpu cpus[i % size], no affinity if empty */
+  std::vector<int> loopCpus;
+  std::vector<int> workerCpus;
+};
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
 /* ================================ [ LOCALS    ] ============================================== */
@@ -68,6 +88,11 @@ Std_ReturnType on_event_tp_tx_data(uint32_t requestId, SomeIp_TpMessageType *msg
 void on_connect(uint16_t serviceId, uint16_t conId, boolean isConnected);
 
 void on_subscribe(uint16_t eventGroupId, boolean isSubscribe, TcpIp_SockAddrType *RemoteAddr);
+
+/* switch from a thread per connection to the reactor mode: the connections of all the servers
+ * are served by a fixed set of epoll loops and the request handlers are run by a worker pool.
+ * Shall be called before any connection is online, the epoll loops are only for linux. */
+void reactor(const ReactorConfig &config);
 } // namespace server
 } // namespace usomeip
 } /* namespace as */
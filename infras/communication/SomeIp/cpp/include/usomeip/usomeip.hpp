@@ -29,6 +29,8 @@ namespace usomeip {
 using namespace as;
 /* ================================ [ MACROS    ] ============================================== */
 #define usLOG(level, ...) LOG(level, "usomeip: " __VA_ARGS__)
+
+#define USOMEIP_E_CANCELED ((Std_ReturnType)110)
 /* ================================ [ TYPES     ] ============================================== */
 typedef enum
 {
@@ -39,6 +41,16 @@ typedef enum
   ERROR
 } MessageType;
 
+/* a view of [offset, offset+length) of the owner buffer, the owner is kept alive by the view */
+inline std::shared_ptr<Buffer> make_view(std::shared_ptr<Buffer> owner, size_t offset,
+                                         size_t length) {
+  if ((nullptr == owner) || (offset > owner->size) || (length > (owner->size - offset))) {
+    throw std::out_of_range("buffer view out of range");
+  }
+  return std::shared_ptr<Buffer>(new Buffer((uint8_t *)owner->data + offset, length),
+                                 [owner](Buffer *view) { delete view; });
+}
+
 struct Message {
 public:
   uint16_t handleId;
@@ -46,6 +58,7 @@ public:
   uint16_t sessionId;
   std::shared_ptr<Buffer> payload = nullptr;
   MessageType type;
+  Std_ReturnType returnCode = E_OK; /* for the ERROR message */
 
 public:
   Message(uint16_t handleId, uint32_t requestId, uint8_t *data, uint32_t len, MessageType type)
@@ -62,12 +75,45 @@ public:
     sessionId = (uint16_t)(requestId & 0xFFFF);
   }
 
+  /* adopt a part of the owner buffer as payload without copy */
+  Message(uint16_t handleId, uint32_t requestId, std::shared_ptr<Buffer> owner, size_t offset,
+          size_t length, MessageType type)
+    : handleId(handleId), type(type) {
+    clientId = (uint16_t)(requestId >> 16);
+    sessionId = (uint16_t)(requestId & 0xFFFF);
+    payload = make_view(owner, offset, length);
+  }
+
   Message(uint16_t handleId, uint32_t requestId, MessageType type)
     : handleId(handleId), payload(nullptr), type(type) {
     clientId = (uint16_t)(requestId >> 16);
     sessionId = (uint16_t)(requestId & 0xFFFF);
   }
 
+  /* the payload refers to the receive buffer directly, it is only valid in the callback which
+   * the message is given to, call detach to keep the message after that */
+  static std::shared_ptr<Message> borrow(uint16_t handleId, uint32_t requestId, uint8_t *data,
+                                         uint32_t len, MessageType type) {
+    auto msg = std::make_shared<Message>(handleId, requestId,
+                                         std::make_shared<Buffer>((void *)data, len), type);
+    msg->m_Borrowed = true;
+    return msg;
+  }
+
+  bool is_borrowed() {
+    return m_Borrowed;
+  }
+
+  /* copy the borrowed payload to an own buffer */
+  void detach() {
+    if (m_Borrowed) {
+      auto own = std::make_shared<Buffer>(payload->size);
+      memcpy(own->data, payload->data, payload->size);
+      payload = own;
+      m_Borrowed = false;
+    }
+  }
+
   uint32_t get_requestId() {
     return ((uint32_t)clientId << 16) + sessionId;
   }
@@ -93,6 +139,9 @@ public:
   }
 
   void reply(Std_ReturnType returnCode, std::shared_ptr<Buffer> payload = nullptr);
+
+private:
+  bool m_Borrowed = false;
 };
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
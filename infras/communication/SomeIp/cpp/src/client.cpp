@@ -6,16 +6,41 @@
 #include "usomeip/usomeip.hpp"
 #include "usomeip/client.hpp"
 #include "./common.hpp"
+#include <atomic>
+#include <condition_variable>
 namespace as {
 namespace usomeip {
 namespace client {
 /* ================================ [ MACROS    ] ============================================== */
 #define SOMEIP_SF_MAX 1396
+
+/* the number of outstanding async requests per method, shall be power of 2 */
+#ifndef USOMEIP_CLIENT_MAX_PENDING
+#define USOMEIP_CLIENT_MAX_PENDING 1024
+#endif
+
+#ifndef USOMEIP_CLIENT_TIMER_MS
+#define USOMEIP_CLIENT_TIMER_MS 10
+#endif
+
+/* the state of the async slot, the low 16 bits is the session ID */
+#define SLOT_FREE 0
+#define SLOT_RESERVED 0x10000
+#define SLOT_PENDING 0x20000
+#define SLOT_DONE 0x40000
 /* ================================ [ TYPES     ] ============================================== */
+struct AsyncSlot {
+  std::atomic<uint32_t> tag = SLOT_FREE;
+  std::atomic<int64_t> deadline = 0; /* steady clock in ms */
+  Client::ResponseCallback callback;
+};
+
 class MethodClient : public CSHelper {
 public:
-  MethodClient(uint16_t methodId, client::Client *client, BufferPool *bp)
-    : m_MethodId(methodId), m_Client(client), m_BufferPool(bp) {
+  MethodClient(uint16_t methodId, client::Client *client, BufferPool *bp, bool borrow)
+    : m_MethodId(methodId), m_Client(client), m_BufferPool(bp), m_Borrow(borrow) {
+    static_assert(0 == (USOMEIP_CLIENT_MAX_PENDING & (USOMEIP_CLIENT_MAX_PENDING - 1)),
+                  "USOMEIP_CLIENT_MAX_PENDING shall be power of 2");
   }
 
   ~MethodClient() {
@@ -37,43 +62,198 @@ public:
     return ret;
   }
 
-  void request(uint32_t requestId, std::shared_ptr<Buffer> buffer) {
+  /* timeoutMs 0: the ResponseTimeout of the service */
+  Std_ReturnType request(uint32_t requestId, std::shared_ptr<Buffer> buffer,
+                         uint32_t timeoutMs = 0) {
     if (buffer->size > SOMEIP_SF_MAX) {
       std::unique_lock<std::mutex> lck(m_Lock);
       m_RequestMap[requestId & 0xFFFF] = {buffer, E_OK};
     }
-    Std_ReturnType ret = SomeIp_Request(requestId, (uint8_t *)buffer->data, buffer->size);
+    Std_ReturnType ret =
+      SomeIp_RequestWithTimeout(requestId, (uint8_t *)buffer->data, buffer->size, timeoutMs);
     if (E_OK != ret) {
       if (buffer->size > SOMEIP_SF_MAX) {
         std::unique_lock<std::mutex> lck(m_Lock);
         m_RequestMap.erase(requestId & 0xFFFF);
       }
     }
+    return ret;
+  }
+
+  uint32_t async_request(std::shared_ptr<Buffer> buffer, Client::ResponseCallback callback,
+                         uint32_t timeoutMs) {
+    uint32_t requestId = 0;
+    uint16_t sessionId;
+    Std_ReturnType ret;
+
+    std::call_once(m_SlotsOnce, [this]() {
+      m_Slots = std::make_unique<AsyncSlot[]>(USOMEIP_CLIENT_MAX_PENDING);
+      m_Async = true;
+    });
+
+    sessionId = reserve(callback, timeoutMs);
+    if (0 == sessionId) {
+      usLOG(ERROR, "method %u: no free slot for async request\n", m_MethodId);
+      callback(error(0, SOMEIP_E_NOMEM));
+    } else {
+      requestId = ((uint32_t)m_MethodId << 16) + sessionId;
+      /* the stack waits the response as long as the slot, so it can't report a timeout early */
+      ret = request(requestId, buffer, timeoutMs);
+      if (E_OK != ret) {
+        complete(sessionId, error(sessionId, ret));
+        requestId = 0;
+      }
+    }
+
+    return requestId;
+  }
+
+  bool cancel(uint16_t sessionId) {
+    bool canceled = false;
+    if (m_Async) {
+      canceled = complete(sessionId, error(sessionId, USOMEIP_E_CANCELED));
+      if (canceled) {
+        forget(sessionId);
+      }
+    }
+    return canceled;
+  }
+
+  /* time out the async requests whose deadline is over */
+  void expire(int64_t now) {
+    uint32_t i, tag;
+    if (m_Async) {
+      for (i = 0; i < USOMEIP_CLIENT_MAX_PENDING; i++) {
+        AsyncSlot &slot = m_Slots[i];
+        tag = slot.tag.load(std::memory_order_acquire);
+        if ((tag & SLOT_PENDING) && (now >= slot.deadline.load(std::memory_order_relaxed))) {
+          if (complete(tag & 0xFFFF, error(tag & 0xFFFF, SOMEIPXF_E_TIMEOUT))) {
+            forget(tag & 0xFFFF);
+          }
+        }
+      }
+    }
   }
 
   void onResponse(uint32_t requestId, SomeIp_MessageType *res) {
-    auto msg = transform(requestId, res, m_MethodId, MessageType::RESPONSE, m_ResponseMap);
-    m_Client->onResponse(msg);
+    auto msg =
+      transform(requestId, res, m_MethodId, MessageType::RESPONSE, m_ResponseMap, m_Borrow);
+    if (m_Async) {
+      if (false == complete(requestId & 0xFFFF, msg)) {
+        usLOG(DEBUG, "method %u: drop response %x as not pending\n", m_MethodId, requestId);
+      }
+    } else {
+      m_Client->onResponse(msg);
+    }
   }
 
   void onError(uint32_t requestId, Std_ReturnType ercd) {
     auto msg = std::make_shared<Message>(m_MethodId, requestId, MessageType::ERROR);
-    m_Client->onError(msg);
+    msg->returnCode = ercd;
+    if (m_Async) {
+      (void)complete(requestId & 0xFFFF, msg);
+    } else {
+      m_Client->onError(msg);
+    }
+  }
+
+private:
+  /* free the response waiter of the stack and its TP request buffer */
+  void forget(uint16_t sessionId) {
+    (void)SomeIp_CancelRequest(((uint32_t)m_MethodId << 16) + sessionId);
+    std::unique_lock<std::mutex> lck(m_Lock);
+    m_RequestMap.erase(sessionId);
+  }
+
+  std::shared_ptr<Message> error(uint16_t sessionId, Std_ReturnType ercd) {
+    auto msg = std::make_shared<Message>(m_MethodId, sessionId, MessageType::ERROR);
+    msg->returnCode = ercd;
+    return msg;
+  }
+
+  /* get a free slot by the next session ID, 0 if all busy */
+  uint16_t reserve(Client::ResponseCallback &callback, uint32_t timeoutMs) {
+    uint16_t sessionId = 0;
+    uint32_t i, expected;
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+    for (i = 0; (i < USOMEIP_CLIENT_MAX_PENDING) && (0 == sessionId); i++) {
+      uint16_t id = (uint16_t)m_NextSessionId.fetch_add(1);
+      if (0 != id) { /* session ID 0 means no session handling */
+        AsyncSlot &slot = m_Slots[id & (USOMEIP_CLIENT_MAX_PENDING - 1)];
+        expected = SLOT_FREE;
+        if (slot.tag.compare_exchange_strong(expected, SLOT_RESERVED | id)) {
+          slot.callback = callback;
+          slot.deadline.store(now + timeoutMs, std::memory_order_relaxed);
+          slot.tag.store(SLOT_PENDING | id, std::memory_order_release);
+          sessionId = id;
+        }
+      }
+    }
+    return sessionId;
+  }
+
+  /* the one who moves the slot from pending to done invokes the callback */
+  bool complete(uint16_t sessionId, std::shared_ptr<Message> msg) {
+    bool completed = false;
+    Client::ResponseCallback callback;
+    AsyncSlot &slot = m_Slots[sessionId & (USOMEIP_CLIENT_MAX_PENDING - 1)];
+    uint32_t expected = SLOT_PENDING | sessionId;
+    if (slot.tag.compare_exchange_strong(expected, SLOT_DONE | sessionId,
+                                         std::memory_order_acq_rel)) {
+      callback = std::move(slot.callback);
+      slot.callback = nullptr;
+      slot.tag.store(SLOT_FREE, std::memory_order_release);
+      callback(msg);
+      completed = true;
+    }
+    return completed;
   }
 
 private:
   uint16_t m_MethodId;
   client::Client *m_Client;
   BufferPool *m_BufferPool;
+  bool m_Borrow;
   std::map<uint32_t, BufferInfo> m_RequestMap;
   std::map<uint32_t, BufferInfo> m_ResponseMap;
   std::mutex m_Lock;
+  std::once_flag m_SlotsOnce;
+  std::unique_ptr<AsyncSlot[]> m_Slots;
+  std::atomic<bool> m_Async = false;
+  std::atomic<uint32_t> m_NextSessionId = 1;
+};
+
+/* time out the async requests of all the method clients */
+class AsyncTimer {
+public:
+  AsyncTimer() : m_Thread(&AsyncTimer::run, this) {
+  }
+
+  ~AsyncTimer() {
+    {
+      std::unique_lock<std::mutex> lck(m_Lock);
+      m_Running = false;
+    }
+    m_Cond.notify_all();
+    m_Thread.join();
+  }
+
+private:
+  void run();
+
+private:
+  bool m_Running = true;
+  std::mutex m_Lock;
+  std::condition_variable m_Cond;
+  std::thread m_Thread;
 };
 
 class EventClient : public CSHelper {
 public:
-  EventClient(uint16_t eventId, client::Client *client, BufferPool *bp)
-    : m_EventId(eventId), m_Client(client), m_BufferPool(bp) {
+  EventClient(uint16_t eventId, client::Client *client, BufferPool *bp, bool borrow)
+    : m_EventId(eventId), m_Client(client), m_BufferPool(bp), m_Borrow(borrow) {
   }
 
   ~EventClient() {
@@ -92,7 +272,8 @@ public:
   }
 
   void onNotification(uint32_t requestId, SomeIp_MessageType *evt) {
-    auto msg = transform(requestId, evt, m_EventId, MessageType::NOTIFICATION, m_EventMap);
+    auto msg =
+      transform(requestId, evt, m_EventId, MessageType::NOTIFICATION, m_EventMap, m_Borrow);
     m_Client->onNotification(msg);
   }
 
@@ -100,6 +281,7 @@ private:
   uint16_t m_EventId;
   client::Client *m_Client;
   BufferPool *m_BufferPool;
+  bool m_Borrow;
   std::map<uint32_t, BufferInfo> m_EventMap;
   std::mutex m_Lock;
 };
@@ -110,6 +292,8 @@ static std::mutex s_Lock;
 static std::map<uint16_t, std::shared_ptr<MethodClient>> s_MethodClientMap;
 static std::map<uint16_t, std::shared_ptr<EventClient>> s_EventClientMap;
 static std::map<uint16_t, client::Client *> s_IdentityMap;
+static std::once_flag s_AsyncTimerOnce;
+static std::unique_ptr<AsyncTimer> s_AsyncTimer;
 /* ================================ [ LOCALS    ] ============================================== */
 std::shared_ptr<MethodClient> get_mc(uint16_t methodId) {
   std::shared_ptr<MethodClient> mc = nullptr;
@@ -130,6 +314,27 @@ std::shared_ptr<EventClient> get_ec(uint16_t eventId) {
   }
   return ec;
 }
+
+void AsyncTimer::run() {
+  std::vector<std::shared_ptr<MethodClient>> mcs;
+  std::unique_lock<std::mutex> lck(m_Lock);
+  while (m_Running) {
+    m_Cond.wait_for(lck, std::chrono::milliseconds(USOMEIP_CLIENT_TIMER_MS));
+    {
+      std::unique_lock<std::mutex> lck2(s_Lock);
+      for (auto &it : s_MethodClientMap) {
+        mcs.push_back(it.second);
+      }
+    }
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+    for (auto &mc : mcs) {
+      mc->expire(now);
+    }
+    mcs.clear();
+  }
+}
 /* ================================ [ FUNCTIONS ] ============================================== */
 Std_ReturnType on_response(uint16_t methodId, uint32_t requestId, SomeIp_MessageType *res) {
   Std_ReturnType ret = E_NOT_OK;
@@ -206,21 +411,21 @@ Std_ReturnType on_event_tp_rx_data(uint16_t eventId, uint32_t requestId,
   return ret;
 }
 
-void Client::bind(uint16_t methodId, BufferPool *bp) {
+void Client::bind(uint16_t methodId, BufferPool *bp, bool borrow) {
   std::unique_lock<std::mutex> lck(s_Lock);
   auto it = s_MethodClientMap.find(methodId);
   if (it == s_MethodClientMap.end()) {
-    s_MethodClientMap[methodId] = std::make_shared<MethodClient>(methodId, this, bp);
+    s_MethodClientMap[methodId] = std::make_shared<MethodClient>(methodId, this, bp, borrow);
   } else {
     throw std::runtime_error("method " + std::to_string(methodId) + " has already been used");
   }
 }
 
-void Client::listen(uint16_t eventId, BufferPool *bp) {
+void Client::listen(uint16_t eventId, BufferPool *bp, bool borrow) {
   std::unique_lock<std::mutex> lck(s_Lock);
   auto it = s_EventClientMap.find(eventId);
   if (it == s_EventClientMap.end()) {
-    s_EventClientMap[eventId] = std::make_shared<EventClient>(eventId, this, bp);
+    s_EventClientMap[eventId] = std::make_shared<EventClient>(eventId, this, bp, borrow);
   } else {
     throw std::runtime_error("event " + std::to_string(eventId) + " has already been used");
   }
@@ -259,11 +464,55 @@ void Client::request(uint32_t requestId, std::shared_ptr<Buffer> buffer) {
   uint16_t methodId = requestId >> 16;
   auto mc = get_mc(methodId);
   if (nullptr != mc) {
-    mc->request(requestId, buffer);
+    (void)mc->request(requestId, buffer);
   } else {
     usLOG(ERROR, "has no method client for request %x\n", requestId);
   }
 }
+
+uint32_t Client::async_request(uint16_t methodId, std::shared_ptr<Buffer> buffer,
+                               ResponseCallback callback, uint32_t timeoutMs) {
+  uint32_t requestId = 0;
+  auto mc = get_mc(methodId);
+  if (nullptr != mc) {
+    std::call_once(s_AsyncTimerOnce, []() { s_AsyncTimer = std::make_unique<AsyncTimer>(); });
+    requestId = mc->async_request(buffer, callback, timeoutMs);
+  } else {
+    usLOG(ERROR, "has no method client for async request of method %u\n", methodId);
+    auto msg = std::make_shared<Message>(methodId, 0, MessageType::ERROR);
+    msg->returnCode = E_NOT_OK;
+    callback(msg);
+  }
+  return requestId;
+}
+
+std::future<std::shared_ptr<Message>> Client::async_request(uint16_t methodId,
+                                                            std::shared_ptr<Buffer> buffer,
+                                                            uint32_t timeoutMs,
+                                                            uint32_t *requestId) {
+  auto promise = std::make_shared<std::promise<std::shared_ptr<Message>>>();
+  auto future = promise->get_future();
+  uint32_t id = async_request(
+    methodId, buffer,
+    [promise](std::shared_ptr<Message> msg) {
+      msg->detach(); /* the future may be got after the callback */
+      promise->set_value(msg);
+    },
+    timeoutMs);
+  if (nullptr != requestId) {
+    *requestId = id;
+  }
+  return future;
+}
+
+bool Client::cancel(uint32_t requestId) {
+  bool canceled = false;
+  auto mc = get_mc(requestId >> 16);
+  if (nullptr != mc) {
+    canceled = mc->cancel(requestId & 0xFFFF);
+  }
+  return canceled;
+}
 } /* namespace client */
 } /* namespace usomeip */
 } /* namespace as */
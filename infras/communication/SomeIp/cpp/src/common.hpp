@@ -61,8 +61,8 @@ public:
   }
 
   std::shared_ptr<Message> transform(uint32_t requestId, SomeIp_MessageType *msg, uint16_t handleId,
-                                     MessageType msgType,
-                                     std::map<uint32_t, BufferInfo> &bufferMap) {
+                                     MessageType msgType, std::map<uint32_t, BufferInfo> &bufferMap,
+                                     bool borrow = false) {
     std::shared_ptr<Message> pMsg = nullptr;
     auto buffer = poll(requestId, bufferMap);
     if (nullptr != buffer) {
@@ -73,9 +73,10 @@ public:
         buffer->size = msg->length;
         pMsg = std::make_shared<Message>(handleId, requestId, buffer, msgType);
       }
+    } else if (borrow) {
+      pMsg = Message::borrow(handleId, requestId, msg->data, msg->length, msgType);
     } else {
-      pMsg = std::make_shared<Message>(handleId, requestId, msg->data, msg->length,
-                                       MessageType::REQUEST);
+      pMsg = std::make_shared<Message>(handleId, requestId, msg->data, msg->length, msgType);
     }
     return pMsg;
   }
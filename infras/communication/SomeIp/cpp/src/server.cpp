@@ -6,17 +6,279 @@
 #include "usomeip/usomeip.hpp"
 #include "usomeip/server.hpp"
 #include <atomic>
+#include <deque>
+#include <condition_variable>
 #include "./common.hpp"
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
 namespace as {
 namespace usomeip {
 namespace server {
 /* ================================ [ MACROS    ] ============================================== */
 #define SOMEIP_SF_MAX 1396
+
+#ifdef __linux__
+#define USOMEIP_USE_EPOLL
+#endif
+
+#ifndef USOMEIP_REACTOR_MAX_EVENTS
+#define USOMEIP_REACTOR_MAX_EVENTS 64
+#endif
 /* ================================ [ TYPES     ] ============================================== */
+/* the connection whose loop sends the response of a request handled by a worker */
+struct ReactorWakeup {
+  int loop;
+  uint16_t serviceId;
+  uint16_t conId;
+};
+
+class Reactor {
+public:
+  Reactor(const ReactorConfig &config) : m_Config(config) {
+    int i;
+    for (i = 0; i < config.numOfWorkers; i++) {
+      m_Workers.push_back(std::thread(&Reactor::run_worker, this));
+      pin(m_Workers.back(), config.workerCpus, i);
+    }
+#ifdef USOMEIP_USE_EPOLL
+    for (i = 0; i < config.numOfLoops; i++) {
+      auto loop = std::make_shared<Loop>();
+      loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+      if (loop->epfd < 0) {
+        throw std::runtime_error("reactor epoll create failed");
+      }
+      loop->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      struct epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.ptr = nullptr; /* the wakeup of the loop, not a connection */
+      if ((loop->evfd < 0) || (0 != epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->evfd, &ev))) {
+        throw std::runtime_error("reactor eventfd create failed");
+      }
+      m_Loops.push_back(loop);
+      loop->thread = std::thread(&Reactor::run_loop, this, loop.get());
+      pin(loop->thread, config.loopCpus, i);
+    }
+#endif
+  }
+
+  ~Reactor() {
+    m_Running = false;
+    m_Cond.notify_all();
+    for (auto &worker : m_Workers) {
+      worker.join();
+    }
+#ifdef USOMEIP_USE_EPOLL
+    for (auto &loop : m_Loops) {
+      loop->thread.join();
+      close(loop->evfd);
+      close(loop->epfd);
+      for (auto con : loop->dead) {
+        delete con;
+      }
+    }
+#endif
+  }
+
+  static Reactor *get() {
+    return s_Instance.get();
+  }
+
+  static void create(const ReactorConfig &config) {
+    if (nullptr == s_Instance) {
+      s_Instance = std::make_unique<Reactor>(config);
+    } else {
+      throw std::runtime_error("reactor has already been created");
+    }
+  }
+
+  /* run the job by the worker pool, or return false if no reactor */
+  static bool dispatch(std::function<void()> job, std::shared_ptr<Message> msg) {
+    bool dispatched = false;
+    auto self = get();
+    if ((nullptr != self) && (false == self->m_Workers.empty())) {
+      msg->detach(); /* the receive buffer is reused once the job is queued */
+      {
+        std::unique_lock<std::mutex> lck(self->m_Lock);
+        self->m_Jobs.push_back(std::move(job));
+      }
+      self->m_Cond.notify_one();
+      dispatched = true;
+    }
+    return dispatched;
+  }
+
+  bool add(Server::Connection *con) {
+    bool added = false;
+#ifdef USOMEIP_USE_EPOLL
+    struct epoll_event ev;
+    if (false == m_Loops.empty()) {
+      con->loop = m_NextLoop.fetch_add(1) % m_Loops.size();
+      con->inRx = false;
+      ev.events = EPOLLIN | EPOLLRDHUP;
+      ev.data.ptr = con;
+      if (0 == epoll_ctl(m_Loops[con->loop]->epfd, EPOLL_CTL_ADD, con->sock, &ev)) {
+        added = true;
+      } else {
+        usLOG(ERROR, "reactor: add connection %d failed: %d\n", con->conId, errno);
+      }
+    }
+#endif
+    return added;
+  }
+
+  /* the connection is freed by its loop once no event of it is in processing */
+  void remove(Server::Connection *con) {
+#ifdef USOMEIP_USE_EPOLL
+    auto loop = m_Loops[con->loop];
+    if (false == con->inRx) {
+      /* the socket is still open, else it was closed in the rx and gone from the epoll set */
+      (void)epoll_ctl(loop->epfd, EPOLL_CTL_DEL, con->sock, nullptr);
+    }
+    std::unique_lock<std::mutex> lck(loop->lock);
+    loop->dead.push_back(con);
+#endif
+  }
+
+  /* let the loop send the response now, else it waits for the next SomeIp_MainFunction */
+  void wake(const ReactorWakeup &wakeup) {
+#ifdef USOMEIP_USE_EPOLL
+    uint64_t one = 1;
+    auto loop = m_Loops[wakeup.loop];
+    {
+      std::unique_lock<std::mutex> lck(loop->lock);
+      loop->wakeups.push_back(wakeup);
+    }
+    if (write(loop->evfd, &one, sizeof(one)) < 0) {
+      /* EAGAIN: the counter is already set, the loop wakes up anyway */
+    }
+#endif
+  }
+
+  bool has_loops() {
+#ifdef USOMEIP_USE_EPOLL
+    return (false == m_Loops.empty());
+#else
+    return false;
+#endif
+  }
+
+private:
+#ifdef USOMEIP_USE_EPOLL
+  struct Loop {
+    int epfd;
+    int evfd;
+    std::thread thread;
+    std::mutex lock;
+    std::vector<Server::Connection *> dead;
+    std::vector<ReactorWakeup> wakeups;
+  };
+
+  void run_wakeups(Loop *loop) {
+    uint64_t count;
+    std::vector<ReactorWakeup> wakeups;
+    if (read(loop->evfd, &count, sizeof(count)) < 0) {
+      /* EAGAIN: reset by an earlier event, take the wakeups anyway */
+    }
+    {
+      std::unique_lock<std::mutex> lck(loop->lock);
+      wakeups.swap(loop->wakeups);
+    }
+    for (auto &wakeup : wakeups) {
+      /* E_NOT_OK if the connection is gone, nothing to send then */
+      (void)SomeIp_ConnectionAsyncControl(wakeup.serviceId, wakeup.conId);
+    }
+  }
+
+  void run_loop(Loop *loop) {
+    struct epoll_event events[USOMEIP_REACTOR_MAX_EVENTS];
+    std::vector<uint8_t> data(1420);
+    std::vector<Server::Connection *> dead;
+    int i, n;
+    bool hangup;
+    while (m_Running) {
+      n = epoll_wait(loop->epfd, events, USOMEIP_REACTOR_MAX_EVENTS, 100);
+      for (i = 0; i < n; i++) {
+        auto con = (Server::Connection *)events[i].data.ptr;
+        if (nullptr == con) {
+          run_wakeups(loop);
+        } else if (con->online) {
+          hangup = (0 != (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)));
+          con->self->run_event(con, hangup, data);
+        }
+      }
+      {
+        std::unique_lock<std::mutex> lck(loop->lock);
+        dead.swap(loop->dead);
+      }
+      for (auto con : dead) {
+        delete con;
+      }
+      dead.clear();
+    }
+  }
+#endif
+
+  void run_worker() {
+    std::function<void()> job;
+    while (m_Running) {
+      {
+        std::unique_lock<std::mutex> lck(m_Lock);
+        m_Cond.wait(lck, [this] { return (false == m_Running) || (false == m_Jobs.empty()); });
+        if (m_Jobs.empty()) {
+          continue;
+        }
+        job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+  void pin(std::thread &thread, const std::vector<int> &cpus, int index) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    int r;
+    if (false == cpus.empty()) {
+      CPU_ZERO(&cpuset);
+      CPU_SET(cpus[index % cpus.size()], &cpuset);
+      r = pthread_setaffinity_np(thread.native_handle(), sizeof(cpuset), &cpuset);
+      if (0 != r) {
+        usLOG(WARN, "reactor: pin thread %d to cpu %d failed: %d\n", index,
+              cpus[index % cpus.size()], r);
+      }
+    }
+#else
+    if (false == cpus.empty()) {
+      usLOG(WARN, "reactor: cpu affinity is not supported\n");
+    }
+#endif
+  }
+
+private:
+  ReactorConfig m_Config;
+  std::atomic<bool> m_Running = true;
+  std::vector<std::thread> m_Workers;
+  std::deque<std::function<void()>> m_Jobs;
+  std::mutex m_Lock;
+  std::condition_variable m_Cond;
+#ifdef USOMEIP_USE_EPOLL
+  std::vector<std::shared_ptr<Loop>> m_Loops;
+  std::atomic<unsigned int> m_NextLoop = 0;
+#endif
+  static std::unique_ptr<Reactor> s_Instance;
+};
+
+/* the connection whose request is being received by this loop thread */
+static thread_local const ReactorWakeup *t_RxWakeup = nullptr;
+
 class MethodServer : public CSHelper {
 public:
-  MethodServer(uint16_t methodId, server::Server *server, BufferPool *bp)
-    : m_MethodId(methodId), m_Server(server), m_BufferPool(bp) {
+  MethodServer(uint16_t methodId, server::Server *server, BufferPool *bp, bool borrow)
+    : m_MethodId(methodId), m_Server(server), m_BufferPool(bp), m_Borrow(borrow) {
   }
 
   ~MethodServer() {
@@ -36,6 +298,10 @@ public:
       if (it != m_ResponseMap.end()) {
         bu = it->second;
         responseReady = true;
+        /* a single frame is consumed here, erased under the lock as reply() inserts under it */
+        if ((nullptr != bu.buffer) && (bu.buffer->size <= SOMEIP_SF_MAX)) {
+          m_ResponseMap.erase(it);
+        }
       }
     }
     if (responseReady) {
@@ -52,7 +318,6 @@ public:
           usLOG(ERROR, "response buffer too small for request %x\n", requestId);
           ret = SOMEIP_E_NOMEM;
         }
-        m_ResponseMap.erase(requestId);
       } else {
         res->length = reply->size;
         res->data = (uint8_t *)reply->data;
@@ -63,14 +328,32 @@ public:
   }
 
   Std_ReturnType onRequest(uint32_t requestId, SomeIp_MessageType *req, SomeIp_MessageType *res) {
-    auto msg = transform(requestId, req, m_MethodId, MessageType::REQUEST, m_RequestMap);
-    m_Server->onRequest(msg);
+    auto msg = transform(requestId, req, m_MethodId, MessageType::REQUEST, m_RequestMap, m_Borrow);
+    auto server = m_Server;
+    if (nullptr != t_RxWakeup) {
+      /* before the dispatch, the worker may reply at once */
+      std::unique_lock<std::mutex> lck(m_Lock);
+      m_WakeupMap[requestId] = *t_RxWakeup;
+    }
+    /* in the reactor mode, the response is polled by on_async_request, at once by the loop of
+     * the connection when the reply is given */
+    if (false == Reactor::dispatch([server, msg]() { server->onRequest(msg); }, msg)) {
+      if (nullptr != t_RxWakeup) {
+        std::unique_lock<std::mutex> lck(m_Lock);
+        m_WakeupMap.erase(requestId);
+      }
+      m_Server->onRequest(msg);
+    }
     return onAsyncRequest(requestId, res);
   }
 
   void onFireForgot(uint32_t requestId, SomeIp_MessageType *req) {
-    auto msg = transform(requestId, req, m_MethodId, MessageType::REQUEST, m_RequestMap);
-    m_Server->onFireForgot(msg);
+    auto msg = transform(requestId, req, m_MethodId, MessageType::REQUEST_NO_RETURN, m_RequestMap,
+                         m_Borrow);
+    auto server = m_Server;
+    if (false == Reactor::dispatch([server, msg]() { server->onFireForgot(msg); }, msg)) {
+      m_Server->onFireForgot(msg);
+    }
   }
 
   Std_ReturnType copy_request(uint32_t requestId, SomeIp_TpMessageType *msg) {
@@ -87,15 +370,31 @@ public:
 
   void reply(Std_ReturnType returnCode, uint32_t requestId, std::shared_ptr<Buffer> payload) {
     BufferInfo bu = {payload, returnCode};
-    m_ResponseMap[requestId] = bu;
+    ReactorWakeup wakeup;
+    bool toWake = false;
+    {
+      std::unique_lock<std::mutex> lck(m_Lock);
+      m_ResponseMap[requestId] = bu;
+      auto it = m_WakeupMap.find(requestId);
+      if (it != m_WakeupMap.end()) {
+        wakeup = it->second;
+        m_WakeupMap.erase(it);
+        toWake = true;
+      }
+    }
+    if (toWake) {
+      Reactor::get()->wake(wakeup);
+    }
   }
 
 private:
   uint16_t m_MethodId;
   server::Server *m_Server;
   BufferPool *m_BufferPool;
+  bool m_Borrow;
   std::map<uint32_t, BufferInfo> m_RequestMap;
   std::map<uint32_t, BufferInfo> m_ResponseMap;
+  std::map<uint32_t, ReactorWakeup> m_WakeupMap;
   std::mutex m_Lock;
 };
 
@@ -135,6 +434,7 @@ static std::map<uint16_t, std::shared_ptr<MethodServer>> s_MethodServerMap;
 static std::map<uint32_t, BufferInfo> s_EventMap;
 static std::map<uint16_t, std::shared_ptr<EventGroupServer>> s_EventGroupServerMap;
 static std::map<uint16_t, server::Server *> s_IdentityMap;
+std::unique_ptr<Reactor> Reactor::s_Instance;
 /* ================================ [ LOCALS    ] ============================================== */
 std::shared_ptr<MethodServer> get_ms(uint16_t methodId) {
   std::shared_ptr<MethodServer> ms = nullptr;
@@ -244,6 +544,49 @@ void Server::run_rx(Connection *con) {
   usLOG(INFO, "service %d: connection %d offline\n", m_Identity, con->conId);
 }
 
+void Server::run_event(Connection *con, bool hangup, std::vector<uint8_t> &data) {
+  Std_ReturnType ret;
+  if ((true == hangup) && (0 == TcpIp_Tell(con->sock))) {
+    /* all the data has been read out, the peer is gone */
+    ret = SomeIp_ConnectionClose(m_Identity, con->conId);
+    if (E_OK != ret) {
+      usLOG(ERROR, "service %d: connection %d close failed\n", m_Identity, con->conId);
+    }
+  } else {
+    ReactorWakeup wakeup = {con->loop, m_Identity, con->conId};
+    con->inRx = true;
+    t_RxWakeup = &wakeup;
+    ret = SomeIp_ConnectionRxControl(m_Identity, con->conId, data.data(), data.size());
+    t_RxWakeup = nullptr;
+    con->inRx = false;
+    if (E_OK != ret) {
+      usLOG(ERROR, "service %d: connection %d rx control failed\n", m_Identity, con->conId);
+    }
+  }
+}
+
+bool Server::attach(Connection *con) {
+  bool attached = false;
+  auto reactor = Reactor::get();
+  if ((nullptr != reactor) && (reactor->has_loops())) {
+    auto ret = SomeIp_ConnectionTakeControl(m_Identity, con->conId);
+    if (E_OK == ret) {
+      ret = SomeIp_ConnectionGetSocket(m_Identity, con->conId, &con->sock);
+    }
+    if (E_OK == ret) {
+      attached = reactor->add(con);
+    }
+    if (attached) {
+      usLOG(INFO, "service %d: connection %d online in loop %d\n", m_Identity, con->conId,
+            con->loop);
+    } else {
+      usLOG(ERROR, "service %d: connection %d attach to reactor failed\n", m_Identity,
+            con->conId);
+    }
+  }
+  return attached;
+}
+
 void Server::on_connect(uint16_t conId, bool isConnected) {
   std::unique_lock<std::mutex> lck(m_Lock);
   auto it = m_ConnectionMap.find(conId);
@@ -253,7 +596,11 @@ void Server::on_connect(uint16_t conId, bool isConnected) {
       con->conId = conId;
       con->online = true;
       con->self = this;
-      con->thread = osal_thread_create(thread_con_main, con);
+      con->thread = nullptr;
+      con->reactor = attach(con);
+      if (false == con->reactor) {
+        con->thread = osal_thread_create(thread_con_main, con);
+      }
       m_ConnectionMap[conId] = con;
     } else {
       usLOG(ERROR, "invalid service %d connection %d offline callback\n", m_Identity, conId);
@@ -262,9 +609,13 @@ void Server::on_connect(uint16_t conId, bool isConnected) {
     if (false == isConnected) {
       auto con = it->second;
       con->online = false;
-      osal_thread_join(con->thread);
       m_ConnectionMap.erase(conId);
-      delete con;
+      if (con->reactor) {
+        Reactor::get()->remove(con);
+      } else {
+        osal_thread_join(con->thread);
+        delete con;
+      }
     } else {
       usLOG(ERROR, "invalid service %d connection %d online callback\n", m_Identity, conId);
     }
@@ -284,6 +635,10 @@ void on_connect(uint16_t serviceId, uint16_t conId, boolean isConnected) {
 #endif
 }
 
+void reactor(const ReactorConfig &config) {
+  Reactor::create(config);
+}
+
 void Server::identity(uint16_t serviceId) {
   std::unique_lock<std::mutex> lck(s_Lock);
   auto it = s_IdentityMap.find(serviceId);
@@ -299,11 +654,11 @@ void Server::offer(uint16_t serviceId) {
   Sd_ServerServiceSetState(serviceId, SD_SERVER_SERVICE_AVAILABLE);
 }
 
-void Server::listen(uint16_t methodId, BufferPool *bp) {
+void Server::listen(uint16_t methodId, BufferPool *bp, bool borrow) {
   std::unique_lock<std::mutex> lck(s_Lock);
   auto it = s_MethodServerMap.find(methodId);
   if (it == s_MethodServerMap.end()) {
-    s_MethodServerMap[methodId] = std::make_shared<MethodServer>(methodId, this, bp);
+    s_MethodServerMap[methodId] = std::make_shared<MethodServer>(methodId, this, bp, borrow);
   } else {
     throw std::runtime_error("method " + std::to_string(methodId) + " has already been used");
   }
@@ -336,6 +691,11 @@ void Server::notify(uint32_t requestId, std::shared_ptr<Buffer> buffer) {
 } /* namespace server */
 
 void Message::reply(Std_ReturnType ercd, std::shared_ptr<Buffer> payload) {
+  if ((nullptr != payload) && (payload == this->payload) && m_Borrowed) {
+    /* echo of a borrowed request, the reply may be sent after the callback */
+    detach();
+    payload = this->payload;
+  }
   if (type == MessageType::REQUEST) {
     uint32_t requestId = get_requestId();
     auto ms = server::get_ms(handleId);
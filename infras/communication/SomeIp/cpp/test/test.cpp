@@ -0,0 +1,219 @@
+/**
+ * SSAS - Simple Smart Automotive Software
+ * Copyright (C) 2022 Parai Wang <parai@foxmail.com>
+ *
+ * test of the async requests of the usomeip Client, built with USOMEIP_CLIENT_MAX_PENDING 4, the
+ * SOME/IP stack below is replaced by the stubs of this file.
+ */
+/* ================================ [ INCLUDES  ] ============================================== */
+#include "usomeip/client.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <algorithm>
+using namespace as::usomeip;
+/* ================================ [ MACROS    ] ============================================== */
+#define TEST_METHOD_ID 3
+#define TEST_MAX_PENDING 4
+
+#define TEST_ASSERT(cond)                                                                          \
+  if (!(cond)) {                                                                                   \
+    printf(" FAIL at line %d: %s\n", __LINE__, #cond);                                             \
+    exit(-1);                                                                                      \
+  }
+/* ================================ [ TYPES     ] ============================================== */
+class TestClient : public client::Client {
+public:
+  void onResponse(std::shared_ptr<Message> msg) {
+  }
+  void onNotification(std::shared_ptr<Message> msg) {
+  }
+  void onError(std::shared_ptr<Message> msg) {
+  }
+  void onAvailability(bool isAvailable) {
+  }
+};
+/* ================================ [ DECLARES  ] ============================================== */
+/* ================================ [ DATAS     ] ============================================== */
+static std::mutex lLock;
+static Std_ReturnType lRequestReturn = E_OK;
+static uint32_t lLastTimeoutMs = 0;
+static std::vector<uint32_t> lWaiting; /* the requests the stack waits a response for */
+/* ================================ [ LOCALS    ] ============================================== */
+static bool isWaiting(uint32_t requestId) {
+  std::unique_lock<std::mutex> lck(lLock);
+  return std::find(lWaiting.begin(), lWaiting.end(), requestId) != lWaiting.end();
+}
+
+/* the stack stops waiting once the response is received */
+static void respond(uint32_t requestId) {
+  uint8_t data[4] = {1, 2, 3, 4};
+  SomeIp_MessageType res = {data, sizeof(data)};
+  {
+    std::unique_lock<std::mutex> lck(lLock);
+    auto it = std::find(lWaiting.begin(), lWaiting.end(), requestId);
+    if (it != lWaiting.end()) {
+      lWaiting.erase(it);
+    }
+  }
+  (void)client::on_response(TEST_METHOD_ID, requestId, &res);
+}
+
+static std::shared_ptr<Buffer> payload(void) {
+  return std::make_shared<Buffer>(8);
+}
+
+static void TestResponse(client::Client &client) {
+  uint32_t requestId = 0;
+  printf("Test async response:");
+  auto future = client.async_request(TEST_METHOD_ID, payload(), 1000, &requestId);
+  TEST_ASSERT(0 != requestId);
+  TEST_ASSERT(1000 == lLastTimeoutMs);
+  TEST_ASSERT(isWaiting(requestId));
+  respond(requestId);
+  auto msg = future.get();
+  TEST_ASSERT(MessageType::RESPONSE == msg->type);
+  TEST_ASSERT(requestId == msg->get_requestId());
+  TEST_ASSERT(4 == msg->payload->size);
+  printf(" PASS\n");
+}
+
+static void TestTimeout(client::Client &client) {
+  uint32_t requestId = 0;
+  printf("Test async timeout:");
+  auto start = std::chrono::steady_clock::now();
+  auto future = client.async_request(TEST_METHOD_ID, payload(), 50, &requestId);
+  TEST_ASSERT(50 == lLastTimeoutMs);
+  TEST_ASSERT(std::future_status::ready == future.wait_for(std::chrono::seconds(2)));
+  auto msg = future.get();
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  TEST_ASSERT(MessageType::ERROR == msg->type);
+  TEST_ASSERT(SOMEIPXF_E_TIMEOUT == msg->returnCode);
+  TEST_ASSERT(elapsed >= 50);
+  /* the stack doesn't wait it any more, and a late response is dropped */
+  TEST_ASSERT(false == isWaiting(requestId));
+  respond(requestId);
+  TEST_ASSERT(false == client.cancel(requestId));
+  printf(" PASS\n");
+}
+
+static void TestCancel(client::Client &client) {
+  std::atomic<int> calls = 0;
+  std::atomic<Std_ReturnType> returnCode = E_OK;
+  printf("Test async cancel:");
+  uint32_t requestId = client.async_request(
+    TEST_METHOD_ID, payload(),
+    [&](std::shared_ptr<Message> msg) {
+      returnCode = msg->returnCode;
+      calls++;
+    },
+    1000);
+  TEST_ASSERT(0 != requestId);
+  TEST_ASSERT(true == client.cancel(requestId));
+  TEST_ASSERT(1 == calls);
+  TEST_ASSERT(USOMEIP_E_CANCELED == returnCode);
+  TEST_ASSERT(false == isWaiting(requestId));
+  TEST_ASSERT(false == client.cancel(requestId));
+  respond(requestId);
+  TEST_ASSERT(1 == calls);
+  printf(" PASS\n");
+}
+
+static void TestRequestFailed(client::Client &client) {
+  std::atomic<int> calls = 0;
+  printf("Test async request failed:");
+  lRequestReturn = E_NOT_OK;
+  uint32_t requestId = client.async_request(
+    TEST_METHOD_ID, payload(),
+    [&](std::shared_ptr<Message> msg) {
+      TEST_ASSERT(MessageType::ERROR == msg->type);
+      TEST_ASSERT(E_NOT_OK == msg->returnCode);
+      calls++;
+    },
+    1000);
+  lRequestReturn = E_OK;
+  TEST_ASSERT(0 == requestId);
+  TEST_ASSERT(1 == calls);
+  printf(" PASS\n");
+}
+
+static void TestSlotExhaustion(client::Client &client) {
+  std::atomic<int> calls = 0;
+  std::atomic<Std_ReturnType> returnCode = E_OK;
+  std::vector<uint32_t> requestIds;
+  auto callback = [&](std::shared_ptr<Message> msg) {
+    returnCode = msg->returnCode;
+    calls++;
+  };
+  int i;
+  printf("Test async slot exhaustion:");
+  for (i = 0; i < TEST_MAX_PENDING; i++) {
+    requestIds.push_back(client.async_request(TEST_METHOD_ID, payload(), callback, 5000));
+    TEST_ASSERT(0 != requestIds.back());
+  }
+  TEST_ASSERT(0 == calls);
+  /* no free slot, fails at once */
+  TEST_ASSERT(0 == client.async_request(TEST_METHOD_ID, payload(), callback, 5000));
+  TEST_ASSERT(1 == calls);
+  TEST_ASSERT(SOMEIP_E_NOMEM == returnCode);
+  /* a response frees its slot for the next request */
+  respond(requestIds[0]);
+  TEST_ASSERT(2 == calls);
+  TEST_ASSERT(E_OK == returnCode);
+  requestIds[0] = client.async_request(TEST_METHOD_ID, payload(), callback, 5000);
+  TEST_ASSERT(0 != requestIds[0]);
+  for (auto requestId : requestIds) {
+    TEST_ASSERT(true == client.cancel(requestId));
+  }
+  TEST_ASSERT((2 + TEST_MAX_PENDING) == calls);
+  {
+    std::unique_lock<std::mutex> lck(lLock);
+    TEST_ASSERT(lWaiting.empty());
+  }
+  printf(" PASS\n");
+}
+/* ================================ [ FUNCTIONS ] ============================================== */
+extern "C" {
+Std_ReturnType SomeIp_RequestWithTimeout(uint32_t requestId, uint8_t *data, uint32_t length,
+                                         uint32_t timeoutMs) {
+  std::unique_lock<std::mutex> lck(lLock);
+  lLastTimeoutMs = timeoutMs;
+  if (E_OK == lRequestReturn) {
+    lWaiting.push_back(requestId);
+  }
+  return lRequestReturn;
+}
+
+Std_ReturnType SomeIp_CancelRequest(uint32_t requestId) {
+  std::unique_lock<std::mutex> lck(lLock);
+  auto it = std::find(lWaiting.begin(), lWaiting.end(), requestId);
+  if (it != lWaiting.end()) {
+    lWaiting.erase(it);
+  }
+  return E_OK;
+}
+
+Std_ReturnType Sd_ClientServiceSetState(uint16_t ClientServiceHandleId,
+                                        Sd_ClientServiceSetStateType ClientServiceState) {
+  return E_OK;
+}
+
+Std_ReturnType
+Sd_ConsumedEventGroupSetState(uint16_t SdConsumedEventGroupHandleId,
+                              Sd_ConsumedEventGroupSetStateType ConsumedEventGroupState) {
+  return E_OK;
+}
+}
+
+int main(int argc, char *argv[]) {
+  TestClient client;
+  client.bind(TEST_METHOD_ID);
+  TestResponse(client);
+  TestTimeout(client);
+  TestCancel(client);
+  TestRequestFailed(client);
+  TestSlotExhaustion(client);
+  return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * SSAS - Simple Smart Automotive Software
+ * Copyright (C) 2021 Parai Wang <parai@foxmail.com>
+ *
+ * test of the client response waiters: a request canceled or failed by any thread is only marked,
+ * and freed by the main function once, even when its response timeout fires at the same time.
+ */
+/* ================================ [ INCLUDES  ] ============================================== */
+#include "SomeIp.h"
+#include "SomeIp_Cfg.h"
+#include "SoAd.h"
+#include "SoAd_Cfg.h"
+#include "Sd.h"
+#include "NetMem.h"
+#include "osal.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+/* ================================ [ MACROS    ] ============================================== */
+#define TEST_ASSERT(cond)                                                                          \
+  if (!(cond)) {                                                                                   \
+    printf(" FAIL at line %d: %s\n", __LINE__, #cond);                                             \
+    exit(-1);                                                                                      \
+  }
+
+#define TEST_SERVICE_ID 0x1234
+#define TEST_METHOD_ID 0x0001
+#define TEST_CLIENT_ID 0x1001
+
+/* the default SOMEIP_WAIT_RESPOSE_MESSAGE_POOL_SIZE */
+#define TEST_WAITERS 8
+#define TEST_STRESS_LOOPS 20000
+/* ================================ [ TYPES     ] ============================================== */
+/* ================================ [ DECLARES  ] ============================================== */
+/* ================================ [ DATAS     ] ============================================== */
+static int lNumOfResponse = 0;
+static int lNumOfError = 0;
+static uint16_t lSessionId = 0;
+static uint16_t lCancelOnError = 0;
+static volatile boolean lStressStop = FALSE;
+/* ================================ [ LOCALS    ] ============================================== */
+static uint32_t requestId(uint16_t sessionId) {
+  return ((uint32_t)SOMEIP_TX_METHOD_CALC_SQUARE << 16) + sessionId;
+}
+
+static Std_ReturnType request(uint16_t sessionId, uint32_t timeoutMs) {
+  uint8_t data[4] = {1, 2, 3, 4};
+  return SomeIp_RequestWithTimeout(requestId(sessionId), data, sizeof(data), timeoutMs);
+}
+
+static void respond(uint16_t sessionId) {
+  uint8_t data[20];
+  TcpIp_SockAddrType RemoteAddr;
+  PduInfoType info;
+
+  memset(&RemoteAddr, 0, sizeof(RemoteAddr));
+  data[0] = (TEST_SERVICE_ID >> 8) & 0xFF;
+  data[1] = TEST_SERVICE_ID & 0xFF;
+  data[2] = (TEST_METHOD_ID >> 8) & 0xFF;
+  data[3] = TEST_METHOD_ID & 0xFF;
+  data[4] = 0;
+  data[5] = 0;
+  data[6] = 0;
+  data[7] = 12; /* 8 bytes header + 4 bytes payload */
+  data[8] = (TEST_CLIENT_ID >> 8) & 0xFF;
+  data[9] = TEST_CLIENT_ID & 0xFF;
+  data[10] = (sessionId >> 8) & 0xFF;
+  data[11] = sessionId & 0xFF;
+  data[12] = 1;    /* protocol version */
+  data[13] = 0;    /* interface version */
+  data[14] = 0x80; /* response */
+  data[15] = E_OK;
+  memset(&data[16], 0x55, 4);
+  info.SduDataPtr = data;
+  info.MetaDataPtr = (uint8_t *)&RemoteAddr;
+  info.SduLength = sizeof(data);
+  SomeIp_RxIndication(SOMEIP_RX_PID_SOMEIP_CALC, &info);
+}
+
+static void mainFunction(int cycles) {
+  int i;
+  for (i = 0; i < cycles; i++) {
+    SomeIp_MainFunction();
+  }
+}
+
+/* all the waiters are back in the pool: exactly TEST_WAITERS requests can wait at the same time */
+static void checkWaitersFree(void) {
+  uint16_t first = lSessionId + 1;
+  int i;
+  for (i = 0; i < TEST_WAITERS; i++) {
+    TEST_ASSERT(E_OK == request(++lSessionId, 0));
+  }
+  TEST_ASSERT(E_OK != request(++lSessionId, 0));
+  for (i = 0; i < TEST_WAITERS; i++) {
+    TEST_ASSERT(E_OK == SomeIp_CancelRequest(requestId(first + i)));
+  }
+  mainFunction(1);
+}
+
+static void reset(void) {
+  lNumOfResponse = 0;
+  lNumOfError = 0;
+}
+
+static void TestResponse(void) {
+  printf("Test response:");
+  reset();
+  TEST_ASSERT(E_OK == request(++lSessionId, 0));
+  respond(lSessionId);
+  TEST_ASSERT(1 == lNumOfResponse);
+  respond(lSessionId); /* not waited any more */
+  TEST_ASSERT(1 == lNumOfResponse);
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+
+static void TestTimeout(void) {
+  printf("Test timeout:");
+  reset();
+  TEST_ASSERT(E_OK == request(++lSessionId, 30));
+  mainFunction(2);
+  TEST_ASSERT(0 == lNumOfError);
+  mainFunction(1);
+  TEST_ASSERT(1 == lNumOfError);
+  mainFunction(10);
+  TEST_ASSERT(1 == lNumOfError);
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+
+static void TestCancel(void) {
+  printf("Test cancel:");
+  reset();
+  TEST_ASSERT(E_OK == request(++lSessionId, 0));
+  TEST_ASSERT(E_OK == SomeIp_CancelRequest(requestId(lSessionId)));
+  TEST_ASSERT(E_OK == SomeIp_CancelRequest(requestId(lSessionId))); /* twice is harmless */
+  respond(lSessionId); /* a late response is dropped */
+  TEST_ASSERT(0 == lNumOfResponse);
+  mainFunction(1);
+  TEST_ASSERT(0 == lNumOfError);
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+
+static void TestCancelAtTimeout(void) {
+  printf("Test cancel at timeout:");
+  reset();
+  TEST_ASSERT(E_OK == request(++lSessionId, 10));
+  TEST_ASSERT(E_OK == SomeIp_CancelRequest(requestId(lSessionId)));
+  mainFunction(10);
+  TEST_ASSERT(0 == lNumOfError);
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+
+/* the next waiter is canceled while the main function walks the list, as when the usomeip slot
+ * timeout and the stack timeout of 2 requests fire together */
+static void TestCancelInMainFunction(void) {
+  printf("Test cancel in main function:");
+  reset();
+  TEST_ASSERT(E_OK == request(++lSessionId, 10));
+  TEST_ASSERT(E_OK == request(++lSessionId, 10));
+  lCancelOnError = lSessionId;
+  mainFunction(10);
+  TEST_ASSERT(1 == lNumOfError);
+  lCancelOnError = 0;
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+
+static void stressCancel(void *args) {
+  uint16_t sessionId = 0x8000;
+  int i;
+  (void)args;
+  for (i = 0; i < TEST_STRESS_LOOPS; i++) {
+    sessionId++;
+    if (E_OK == request(sessionId, 10)) {
+      (void)SomeIp_CancelRequest(requestId(sessionId));
+    }
+  }
+  lStressStop = TRUE;
+}
+
+/* the main function walks the waiters while another thread requests and cancels, as the usomeip
+ * timer thread does, and the 1 cycle timeouts expire together with the cancels */
+static void TestCancelStress(void) {
+  osal_thread_t thread;
+  printf("Test cancel stress:");
+  reset();
+  lStressStop = FALSE;
+  thread = osal_thread_create(stressCancel, NULL);
+  TEST_ASSERT(NULL != thread);
+  while (FALSE == lStressStop) {
+    SomeIp_MainFunction();
+  }
+  (void)osal_thread_join(thread);
+  mainFunction(2);
+  checkWaitersFree();
+  printf(" PASS\n");
+}
+/* ================================ [ FUNCTIONS ] ============================================== */
+void SomeIp_Calc_OnAvailability(boolean isAvailable) {
+}
+
+Std_ReturnType SomeIp_Calc_square_OnResponse(uint32_t requestId, SomeIp_MessageType *res) {
+  lNumOfResponse++;
+  return E_OK;
+}
+
+Std_ReturnType SomeIp_Calc_square_OnError(uint32_t requestId, Std_ReturnType ercd) {
+  lNumOfError++;
+  if (0 != lCancelOnError) {
+    (void)SomeIp_CancelRequest(((uint32_t)SOMEIP_TX_METHOD_CALC_SQUARE << 16) + lCancelOnError);
+  }
+  return E_OK;
+}
+
+Std_ReturnType SoAd_IfTransmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
+  return E_OK;
+}
+
+Std_ReturnType SoAd_CloseSoCon(SoAd_SoConIdType SoConId, boolean abort) {
+  return E_OK;
+}
+
+Std_ReturnType SoAd_GetRemoteAddr(SoAd_SoConIdType SoConId, TcpIp_SockAddrType *IpAddrPtr) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType SoAd_TakeControl(SoAd_SoConIdType SoConId) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType SoAd_SetTimeout(SoAd_SoConIdType SoConId, uint32_t timeoutMs) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType SoAd_ControlRx(SoAd_SoConIdType SoConId, uint8_t *data, uint32_t length) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType SoAd_GetSocket(SoAd_SoConIdType SoConId, TcpIp_SocketIdType *SocketIdPtr) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Sd_GetProviderAddr(uint16_t ClientServiceHandleId, TcpIp_SockAddrType *RemoteAddr) {
+  memset(RemoteAddr, 0, sizeof(TcpIp_SockAddrType));
+  return E_OK;
+}
+
+Std_ReturnType Sd_GetSubscribers(uint16_t EventHandlerId,
+                                 Sd_EventHandlerSubscriberListType **list) {
+  return E_NOT_OK;
+}
+
+void Sd_RemoveSubscriber(uint16_t EventHandlerId, PduIdType TxPduId) {
+}
+
+int main(int argc, char *argv[]) {
+  Net_MemInit();
+  SomeIp_Init(NULL);
+  SomeIp_SoConModeChg(SOAD_SOCKID_SOMEIP_CALC, SOAD_SOCON_ONLINE);
+  TestResponse();
+  TestTimeout();
+  TestCancel();
+  TestCancelAtTimeout();
+  TestCancelInMainFunction();
+  TestCancelStress();
+  return 0;
+}
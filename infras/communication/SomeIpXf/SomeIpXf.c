@@ -11,6 +11,17 @@
 /* ================================ [ MACROS    ] ============================================== */
 #define AS_LOG_SOMEIPXF 0
 #define AS_LOG_SOMEIPXFE 2
+
+/* arrays are serialized in bulk: a plain memcpy if the host is big endian, else a byte swap loop
+ * by the compiler builtins which the compiler vectorizes */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SOMEIPXF_HOST_BIG_ENDIAN
+#endif
+#endif
+#if !defined(SOMEIPXF_HOST_BIG_ENDIAN) && defined(__GNUC__)
+#define SOMEIPXF_USE_BSWAP
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 #define STRUCT_PTR(dtype, pStruct, offset) ((dtype *)(((uint8_t *)(pStruct)) + offset))
 #define STRUCT_VAL(dtype, pStruct, offset) (*STRUCT_PTR(dtype, pStruct, offset))
@@ -247,6 +258,114 @@ static void SomeIpXf_SetLenghtIfhave(void *pStruct, const SomeIpXf_DataElementTy
   }
 }
 /* ================================ [ FUNCTIONS ] ============================================== */
+void SomeIpXf_PutShorts(uint8_t *buffer, const uint16_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(buffer, data, length * sizeof(uint16_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint16_t v;
+  for (i = 0; i < length; i++) {
+    v = __builtin_bswap16(data[i]);
+    memcpy(&buffer[i * sizeof(uint16_t)], &v, sizeof(uint16_t));
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    SOMEIPXF_PUT_SHORT(&buffer[i * sizeof(uint16_t)], data[i]);
+  }
+#endif
+}
+
+void SomeIpXf_GetShorts(const uint8_t *buffer, uint16_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(data, buffer, length * sizeof(uint16_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint16_t v;
+  for (i = 0; i < length; i++) {
+    memcpy(&v, &buffer[i * sizeof(uint16_t)], sizeof(uint16_t));
+    data[i] = __builtin_bswap16(v);
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    data[i] = SOMEIPXF_GET_SHORT(&buffer[i * sizeof(uint16_t)]);
+  }
+#endif
+}
+
+void SomeIpXf_PutLongs(uint8_t *buffer, const uint32_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(buffer, data, length * sizeof(uint32_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint32_t v;
+  for (i = 0; i < length; i++) {
+    v = __builtin_bswap32(data[i]);
+    memcpy(&buffer[i * sizeof(uint32_t)], &v, sizeof(uint32_t));
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    SOMEIPXF_PUT_LONG(&buffer[i * sizeof(uint32_t)], data[i]);
+  }
+#endif
+}
+
+void SomeIpXf_GetLongs(const uint8_t *buffer, uint32_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(data, buffer, length * sizeof(uint32_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint32_t v;
+  for (i = 0; i < length; i++) {
+    memcpy(&v, &buffer[i * sizeof(uint32_t)], sizeof(uint32_t));
+    data[i] = __builtin_bswap32(v);
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    data[i] = SOMEIPXF_GET_LONG(&buffer[i * sizeof(uint32_t)]);
+  }
+#endif
+}
+
+void SomeIpXf_PutLongLongs(uint8_t *buffer, const uint64_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(buffer, data, length * sizeof(uint64_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint64_t v;
+  for (i = 0; i < length; i++) {
+    v = __builtin_bswap64(data[i]);
+    memcpy(&buffer[i * sizeof(uint64_t)], &v, sizeof(uint64_t));
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    SOMEIPXF_PUT_LONG_LONG(&buffer[i * sizeof(uint64_t)], data[i]);
+  }
+#endif
+}
+
+void SomeIpXf_GetLongLongs(const uint8_t *buffer, uint64_t *data, uint32_t length) {
+#if defined(SOMEIPXF_HOST_BIG_ENDIAN)
+  memcpy(data, buffer, length * sizeof(uint64_t));
+#elif defined(SOMEIPXF_USE_BSWAP)
+  uint32_t i;
+  uint64_t v;
+  for (i = 0; i < length; i++) {
+    memcpy(&v, &buffer[i * sizeof(uint64_t)], sizeof(uint64_t));
+    data[i] = __builtin_bswap64(v);
+  }
+#else
+  uint32_t i;
+  for (i = 0; i < length; i++) {
+    data[i] = SOMEIPXF_GET_LONG_LONG(&buffer[i * sizeof(uint64_t)]);
+  }
+#endif
+}
+
 int32_t SomeIpXf_EncodeByte(uint8_t *buffer, uint32_t bufferSize, uint8_t data) {
   int32_t offset = 1;
 
@@ -365,8 +484,9 @@ int32_t SomeIpXf_DecodeLongLong(const uint8_t *buffer, uint32_t bufferSize, uint
   return offset;
 }
 
-int32_t SomeIpXf_EncodeStruct(uint8_t *buffer, uint32_t bufferSize, const void *pStruct,
-                              const SomeIpXf_StructDefinitionType *structDef) {
+static int32_t SomeIpXf_InterpretEncodeStruct(uint8_t *buffer, uint32_t bufferSize,
+                                              const void *pStruct,
+                                              const SomeIpXf_StructDefinitionType *structDef) {
   uint32_t i;
   int32_t offset = 0;
   int32_t length = 0;
@@ -497,8 +617,9 @@ int32_t SomeIpXf_EncodeStruct(uint8_t *buffer, uint32_t bufferSize, const void *
   return offset;
 }
 
-int32_t SomeIpXf_DecodeStruct(const uint8_t *buffer, uint32_t bufferSize, void *pStruct,
-                              const SomeIpXf_StructDefinitionType *structDef) {
+static int32_t SomeIpXf_InterpretDecodeStruct(const uint8_t *buffer, uint32_t bufferSize,
+                                              void *pStruct,
+                                              const SomeIpXf_StructDefinitionType *structDef) {
   uint32_t i;
   int32_t offset = 0;
   int32_t r = 0;
@@ -666,6 +787,36 @@ int32_t SomeIpXf_DecodeStruct(const uint8_t *buffer, uint32_t bufferSize, void *
   return offset;
 }
 
+int32_t SomeIpXf_EncodeStruct(uint8_t *buffer, uint32_t bufferSize, const void *pStruct,
+                              const SomeIpXf_StructDefinitionType *structDef) {
+  int32_t offset;
+
+  if ((NULL != structDef->put) && (bufferSize >= structDef->wireSize)) {
+    ASLOG(SOMEIPXF, ("put struct %s @%p to %p\n", structDef->name, pStruct, buffer));
+    structDef->put(buffer, pStruct);
+    offset = (int32_t)structDef->wireSize;
+  } else {
+    offset = SomeIpXf_InterpretEncodeStruct(buffer, bufferSize, pStruct, structDef);
+  }
+
+  return offset;
+}
+
+int32_t SomeIpXf_DecodeStruct(const uint8_t *buffer, uint32_t bufferSize, void *pStruct,
+                              const SomeIpXf_StructDefinitionType *structDef) {
+  int32_t offset;
+
+  if ((NULL != structDef->get) && (bufferSize >= structDef->wireSize)) {
+    ASLOG(SOMEIPXF, ("get struct %s @%p from %p\n", structDef->name, pStruct, buffer));
+    structDef->get(buffer, pStruct);
+    offset = (int32_t)structDef->wireSize;
+  } else {
+    offset = SomeIpXf_InterpretDecodeStruct(buffer, bufferSize, pStruct, structDef);
+  }
+
+  return offset;
+}
+
 int32_t SomeIpXf_EncodeByteArray(uint8_t *buffer, uint32_t bufferSize, const uint8_t *data,
                                  uint32_t length) {
   int32_t offset = length;
@@ -696,13 +847,10 @@ int32_t SomeIpXf_DecodeByteArray(const uint8_t *buffer, uint32_t bufferSize, uin
 
 int32_t SomeIpXf_EncodeShortArray(uint8_t *buffer, uint32_t bufferSize, const uint16_t *data,
                                   uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint16_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("encode short array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_EncodeShort(buffer + i * sizeof(uint16_t), sizeof(uint16_t), data[i]);
-    }
+    SomeIpXf_PutShorts(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
@@ -711,13 +859,10 @@ int32_t SomeIpXf_EncodeShortArray(uint8_t *buffer, uint32_t bufferSize, const ui
 
 int32_t SomeIpXf_DecodeShortArray(const uint8_t *buffer, uint32_t bufferSize, uint16_t *data,
                                   uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint16_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("decode short array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_DecodeShort(buffer + i * sizeof(uint16_t), sizeof(uint16_t), &data[i]);
-    }
+    SomeIpXf_GetShorts(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
@@ -726,13 +871,10 @@ int32_t SomeIpXf_DecodeShortArray(const uint8_t *buffer, uint32_t bufferSize, ui
 
 int32_t SomeIpXf_EncodeLongArray(uint8_t *buffer, uint32_t bufferSize, const uint32_t *data,
                                  uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint32_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("encode long array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_EncodeLong(buffer + i * sizeof(uint32_t), sizeof(uint32_t), data[i]);
-    }
+    SomeIpXf_PutLongs(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
@@ -741,13 +883,10 @@ int32_t SomeIpXf_EncodeLongArray(uint8_t *buffer, uint32_t bufferSize, const uin
 
 int32_t SomeIpXf_DecodeLongArray(const uint8_t *buffer, uint32_t bufferSize, uint32_t *data,
                                  uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint32_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("decode long array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_DecodeLong(buffer + i * sizeof(uint32_t), sizeof(uint32_t), &data[i]);
-    }
+    SomeIpXf_GetLongs(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
@@ -756,13 +895,10 @@ int32_t SomeIpXf_DecodeLongArray(const uint8_t *buffer, uint32_t bufferSize, uin
 
 int32_t SomeIpXf_EncodeLongLongArray(uint8_t *buffer, uint32_t bufferSize, const uint64_t *data,
                                      uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint64_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("encode long long array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_EncodeLongLong(buffer + i * sizeof(uint64_t), sizeof(uint64_t), data[i]);
-    }
+    SomeIpXf_PutLongLongs(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
@@ -771,13 +907,10 @@ int32_t SomeIpXf_EncodeLongLongArray(uint8_t *buffer, uint32_t bufferSize, const
 
 int32_t SomeIpXf_DecodeLongLongArray(const uint8_t *buffer, uint32_t bufferSize, uint64_t *data,
                                      uint32_t length) {
-  uint32_t i;
   int32_t offset = length * sizeof(uint64_t);
   if (bufferSize >= (uint32_t)offset) {
     ASLOG(SOMEIPXF, ("decode long long array len=%u\n", length));
-    for (i = 0; i < length; i++) {
-      SomeIpXf_DecodeLongLong(buffer + i * sizeof(uint64_t), sizeof(uint64_t), &data[i]);
-    }
+    SomeIpXf_GetLongLongs(buffer, data, length);
   } else {
     offset = -E_NO_DATA;
   }
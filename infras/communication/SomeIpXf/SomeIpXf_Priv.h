@@ -21,9 +21,38 @@
 #define SOMEIPXF_DATA_ELEMENT_TYPE_STRUCT_ARRAY ((SomIpXf_DataElementTypeType)0x09)
 
 #define SOMEIPXF_TAG_NOT_USED ((uint16_t)0xFFFF)
+
+/* big endian accessors used by the generated serializers */
+#define SOMEIPXF_PUT_SHORT(b, v)                                                                   \
+  do {                                                                                             \
+    (b)[0] = (uint8_t)((v) >> 8);                                                                  \
+    (b)[1] = (uint8_t)(v);                                                                         \
+  } while (0)
+#define SOMEIPXF_PUT_LONG(b, v)                                                                    \
+  do {                                                                                             \
+    (b)[0] = (uint8_t)((v) >> 24);                                                                 \
+    (b)[1] = (uint8_t)((v) >> 16);                                                                 \
+    (b)[2] = (uint8_t)((v) >> 8);                                                                  \
+    (b)[3] = (uint8_t)(v);                                                                         \
+  } while (0)
+#define SOMEIPXF_PUT_LONG_LONG(b, v)                                                               \
+  do {                                                                                             \
+    SOMEIPXF_PUT_LONG(b, (uint32_t)((v) >> 32));                                                   \
+    SOMEIPXF_PUT_LONG(&(b)[4], (uint32_t)(v));                                                     \
+  } while (0)
+#define SOMEIPXF_GET_SHORT(b) ((uint16_t)(((uint16_t)(b)[0] << 8) | (b)[1]))
+#define SOMEIPXF_GET_LONG(b)                                                                       \
+  (((uint32_t)(b)[0] << 24) | ((uint32_t)(b)[1] << 16) | ((uint32_t)(b)[2] << 8) | (b)[3])
+#define SOMEIPXF_GET_LONG_LONG(b)                                                                  \
+  (((uint64_t)SOMEIPXF_GET_LONG(b) << 32) | SOMEIPXF_GET_LONG(&(b)[4]))
 /* ================================ [ TYPES     ] ============================================== */
 typedef uint8_t SomIpXf_DataElementTypeType;
 
+/* straight-line serializers of a struct whose serialized layout is fixed, the caller ensures the
+ * buffer has at least wireSize bytes */
+typedef void (*SomeIpXf_PutStructFncType)(uint8_t *buffer, const void *pStruct);
+typedef void (*SomeIpXf_GetStructFncType)(const uint8_t *buffer, void *pStruct);
+
 /* For this implementataion, the dataSize or structSize must be smaller than UINT32_MAX/2,
  * That means this SomeIpXf support data serialized size maximum to 2GB */
 typedef struct {
@@ -44,10 +73,21 @@ typedef struct SomeIpXf_StructDefinition_s {
   uint32_t structSize;
   uint16_t numOfDataElements;
   uint8_t sizeOfStructLengthField;
+  /* generated for the fixed layout structs, NULL to interpret the dataElements */
+  SomeIpXf_PutStructFncType put;
+  SomeIpXf_GetStructFncType get;
+  uint32_t wireSize;
 } SomeIpXf_StructDefinitionType;
 
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
 /* ================================ [ LOCALS    ] ============================================== */
 /* ================================ [ FUNCTIONS ] ============================================== */
+/* serialize arrays of basic types without bounds check, float and double go as long and long long */
+void SomeIpXf_PutShorts(uint8_t *buffer, const uint16_t *data, uint32_t length);
+void SomeIpXf_GetShorts(const uint8_t *buffer, uint16_t *data, uint32_t length);
+void SomeIpXf_PutLongs(uint8_t *buffer, const uint32_t *data, uint32_t length);
+void SomeIpXf_GetLongs(const uint8_t *buffer, uint32_t *data, uint32_t length);
+void SomeIpXf_PutLongLongs(uint8_t *buffer, const uint64_t *data, uint32_t length);
+void SomeIpXf_GetLongLongs(const uint8_t *buffer, uint64_t *data, uint32_t length);
 #endif /* _SOMEIP_XF_PRIV_H_ */
@@ -0,0 +1,113 @@
+/**
+ * SSAS - Simple Smart Automotive Software
+ * Copyright (C) 2023 Parai Wang <parai@foxmail.com>
+ */
+/* ================================ [ INCLUDES  ] ============================================== */
+#include "SomeIpXf_Priv.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+/* ================================ [ MACROS    ] ============================================== */
+#define MAX_ELEMENTS (1024 * 1024)
+#define BENCH_BYTES (64 * 1024 * 1024)
+/* ================================ [ TYPES     ] ============================================== */
+typedef int32_t (*EncodeOneFncType)(uint8_t *buffer, uint32_t bufferSize, const void *data);
+typedef int32_t (*EncodeArrayFncType)(uint8_t *buffer, uint32_t bufferSize, const void *data,
+                                      uint32_t length);
+typedef int32_t (*DecodeArrayFncType)(const uint8_t *buffer, uint32_t bufferSize, void *data,
+                                      uint32_t length);
+typedef struct {
+  const char *name;
+  uint32_t size;
+  EncodeOneFncType encodeOne;
+  EncodeArrayFncType encode;
+  DecodeArrayFncType decode;
+} BenchType;
+/* ================================ [ DECLARES  ] ============================================== */
+/* ================================ [ DATAS     ] ============================================== */
+static uint64_t lData[MAX_ELEMENTS];
+static uint64_t lDecoded[MAX_ELEMENTS];
+static uint8_t lBuffer[MAX_ELEMENTS * sizeof(uint64_t)];
+static uint8_t lReference[MAX_ELEMENTS * sizeof(uint64_t)];
+/* ================================ [ LOCALS    ] ============================================== */
+static int32_t encodeShort(uint8_t *buffer, uint32_t bufferSize, const void *data) {
+  return SomeIpXf_EncodeShort(buffer, bufferSize, *(const uint16_t *)data);
+}
+
+static int32_t encodeLong(uint8_t *buffer, uint32_t bufferSize, const void *data) {
+  return SomeIpXf_EncodeLong(buffer, bufferSize, *(const uint32_t *)data);
+}
+
+static int32_t encodeLongLong(uint8_t *buffer, uint32_t bufferSize, const void *data) {
+  return SomeIpXf_EncodeLongLong(buffer, bufferSize, *(const uint64_t *)data);
+}
+
+static const BenchType lBenchs[] = {
+  {"uint16", sizeof(uint16_t), encodeShort, (EncodeArrayFncType)SomeIpXf_EncodeShortArray,
+   (DecodeArrayFncType)SomeIpXf_DecodeShortArray},
+  {"uint32/float", sizeof(uint32_t), encodeLong, (EncodeArrayFncType)SomeIpXf_EncodeLongArray,
+   (DecodeArrayFncType)SomeIpXf_DecodeLongArray},
+  {"uint64/double", sizeof(uint64_t), encodeLongLong,
+   (EncodeArrayFncType)SomeIpXf_EncodeLongLongArray,
+   (DecodeArrayFncType)SomeIpXf_DecodeLongLongArray},
+};
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1000000.0 + (double)ts.tv_nsec / 1000.0;
+}
+
+static int bench(const BenchType *b, uint32_t length) {
+  uint32_t i, loop;
+  uint32_t loops = BENCH_BYTES / (length * b->size);
+  uint32_t bytes = length * b->size;
+  const uint8_t *data = (const uint8_t *)lData;
+  double t0, t1, t2, t3;
+  int r = 0;
+
+  t0 = now();
+  for (loop = 0; loop < loops; loop++) {
+    for (i = 0; i < length; i++) {
+      (void)b->encodeOne(&lReference[i * b->size], b->size, &data[i * b->size]);
+    }
+  }
+  t1 = now();
+  for (loop = 0; loop < loops; loop++) {
+    (void)b->encode(lBuffer, bytes, lData, length);
+  }
+  t2 = now();
+  for (loop = 0; loop < loops; loop++) {
+    (void)b->decode(lBuffer, bytes, lDecoded, length);
+  }
+  t3 = now();
+
+  if ((0 != memcmp(lBuffer, lReference, bytes)) || (0 != memcmp(lDecoded, lData, bytes))) {
+    printf("%s x %u: FAIL\n", b->name, length);
+    r = -1;
+  } else {
+    printf("%-14s x %7u: per element %8.1f MB/s, encode %8.1f MB/s, decode %8.1f MB/s\n",
+           b->name, length, (double)bytes * loops / (t1 - t0), (double)bytes * loops / (t2 - t1),
+           (double)bytes * loops / (t3 - t2));
+  }
+
+  return r;
+}
+/* ================================ [ FUNCTIONS ] ============================================== */
+int main(int argc, char *argv[]) {
+  uint32_t i, length;
+  int r = 0;
+
+  for (i = 0; i < MAX_ELEMENTS; i++) {
+    lData[i] = ((uint64_t)rand() << 32) | (uint32_t)rand();
+  }
+
+  for (i = 0; (i < ARRAY_SIZE(lBenchs)) && (0 == r); i++) {
+    for (length = 1024; (length <= MAX_ELEMENTS) && (0 == r); length *= 4) {
+      r = bench(&lBenchs[i], length);
+    }
+  }
+
+  return r;
+}
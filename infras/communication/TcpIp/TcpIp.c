@@ -5,6 +5,9 @@
  * ref: Specification of TCP/IP Stack AUTOSAR CP Release 4.4.0
  */
 /* ================================ [ INCLUDES  ] ============================================== */
+#if defined(linux) && !defined(USE_LWIP) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* for recvmmsg/sendmmsg */
+#endif
 #include <string.h>
 #include <stdlib.h>
 
@@ -23,6 +26,12 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <time.h>
+#ifdef USE_TCPIP_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef TCPIP_USE_UDP_GSO
+#include <netinet/udp.h>
+#endif
 #elif defined(_WIN32) && !defined(USE_LWIP)
 #include <Ws2tcpip.h>
 #include <windows.h>
@@ -49,6 +58,7 @@
 #include "netif/tapif.h"
 #endif
 #include "lwip/sockets.h"
+#include "lwip/priv/sockets_priv.h"
 #endif
 
 /* ================================ [ MACROS    ] ============================================== */
@@ -61,7 +71,50 @@
 #define TCPIP_MAX_DATA_SIZE 1420
 #endif
 
+#ifndef TCPIP_RECV_MULTI_MAX
+#define TCPIP_RECV_MULTI_MAX 32
+#endif
+
+#if defined(USE_TCPIP_EPOLL) && (!defined(linux) || defined(USE_LWIP))
+#error USE_TCPIP_EPOLL is only supported by the linux socket
+#endif
+
+#ifdef TCPIP_TX_BATCH_SIZE
+#if !defined(linux) || defined(USE_LWIP)
+#error TCPIP_TX_BATCH_SIZE is only supported by the linux socket
+#endif
+#ifndef TCPIP_TX_BATCH_BUFFER_SIZE
+#define TCPIP_TX_BATCH_BUFFER_SIZE 1500
+#endif
+#ifdef TCPIP_USE_UDP_GSO
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+/* the kernel limits of one GSO super datagram */
+#define TCPIP_GSO_MAX_SEGMENTS 64
+#define TCPIP_GSO_MAX_BYTES 60000
+/* the path MTU, a GSO segment must not be fragmented, the kernel refuses the whole message */
+#ifndef TCPIP_GSO_MTU
+#define TCPIP_GSO_MTU 1500
+#endif
+/* IPv4 and UDP headers */
+#define TCPIP_GSO_HEADER_SIZE 28
+#endif
+#endif
+
 /* ================================ [ TYPES     ] ============================================== */
+#ifdef TCPIP_TX_BATCH_SIZE
+typedef struct {
+  TcpIp_SocketIdType SocketId;
+  struct sockaddr_in toAddr;
+  uint32_t Length;
+  boolean sent;
+  uint8_t data[TCPIP_TX_BATCH_BUFFER_SIZE];
+} TcpIp_TxBatchSlotType;
+#endif
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
 #ifdef USE_LWIP
@@ -72,7 +125,205 @@ struct dhcp netif_dhcp;
 #endif /* LWIP_DHCP */
 #endif
 static boolean lInitialized = FALSE;
+#ifdef USE_TCPIP_EPOLL
+static int lEpollFd = -1;
+#endif
+#ifdef TCPIP_TX_BATCH_SIZE
+/* datagrams queued by TcpIp_SendToQueued in FIFO order, flushed by TcpIp_FlushTx */
+static TcpIp_TxBatchSlotType lTxBatch[TCPIP_TX_BATCH_SIZE];
+static uint16_t lTxBatchNum = 0;
+/* sockets which had a queued datagram dropped by an error, reported by their next
+ * TcpIp_SendToQueued */
+static TcpIp_SocketIdType lTxBatchFailed[TCPIP_TX_BATCH_SIZE];
+static uint16_t lTxBatchNumOfFailed = 0;
+#endif
 /* ================================ [ LOCALS    ] ============================================== */
+#ifdef TCPIP_TX_BATCH_SIZE
+#ifdef TCPIP_USE_UDP_GSO
+/* a slot can join the GSO run started by head if it goes to the same destination and all segments
+ * except the last one have the same size */
+static boolean tcpIpTxBatchCanMerge(const TcpIp_TxBatchSlotType *head,
+                                    const TcpIp_TxBatchSlotType *prev,
+                                    const TcpIp_TxBatchSlotType *slot, uint32_t segments,
+                                    uint32_t total) {
+  boolean r = FALSE;
+
+  if ((head->toAddr.sin_addr.s_addr == slot->toAddr.sin_addr.s_addr) &&
+      (head->toAddr.sin_port == slot->toAddr.sin_port) && (prev->Length == head->Length) &&
+      ((head->Length + TCPIP_GSO_HEADER_SIZE) <= TCPIP_GSO_MTU) &&
+      (slot->Length <= head->Length) && (slot->Length > 0) &&
+      (segments < TCPIP_GSO_MAX_SEGMENTS) && ((total + slot->Length) <= TCPIP_GSO_MAX_BYTES)) {
+    r = TRUE;
+  }
+
+  return r;
+}
+#endif
+
+/* remember that a queued datagram of the socket was dropped */
+static void tcpIpTxBatchSetFailed(TcpIp_SocketIdType SocketId) {
+  uint16_t i;
+
+  for (i = 0; (i < lTxBatchNumOfFailed) && (lTxBatchFailed[i] != SocketId); i++) {
+  }
+
+  if ((i >= lTxBatchNumOfFailed) && (lTxBatchNumOfFailed < TCPIP_TX_BATCH_SIZE)) {
+    lTxBatchFailed[lTxBatchNumOfFailed] = SocketId;
+    lTxBatchNumOfFailed++;
+  }
+}
+
+/* take the dropped datagram error of the socket, TRUE if there was one */
+static boolean tcpIpTxBatchTakeFailed(TcpIp_SocketIdType SocketId) {
+  boolean failed = FALSE;
+  uint16_t i;
+
+  for (i = 0; (i < lTxBatchNumOfFailed) && (FALSE == failed); i++) {
+    if (lTxBatchFailed[i] == SocketId) {
+      lTxBatchNumOfFailed--;
+      lTxBatchFailed[i] = lTxBatchFailed[lTxBatchNumOfFailed];
+      failed = TRUE;
+    }
+  }
+
+  return failed;
+}
+
+static boolean tcpIpTxBatchIsQueued(TcpIp_SocketIdType SocketId) {
+  boolean queued = FALSE;
+  uint16_t i;
+
+  for (i = 0; (i < lTxBatchNum) && (FALSE == queued); i++) {
+    if ((lTxBatch[i].SocketId == SocketId) && (FALSE == lTxBatch[i].sent)) {
+      queued = TRUE;
+    }
+  }
+
+  return queued;
+}
+
+/* send all the queued datagrams of the socket of slot first with one sendmmsg, in queued order.
+ * The datagrams are kept queued if the socket is full, a message the kernel refuses is dropped
+ * alone. */
+static void tcpIpTxBatchFlushSocket(uint16_t first) {
+  struct mmsghdr mmsgs[TCPIP_TX_BATCH_SIZE];
+  struct iovec iovs[TCPIP_TX_BATCH_SIZE];
+  uint32_t totals[TCPIP_TX_BATCH_SIZE];
+  uint16_t slots[TCPIP_TX_BATCH_SIZE]; /* slot index of each iov */
+  /* the iovs of message i are from firstIovs[i] to firstIovs[i + 1] */
+  uint16_t firstIovs[TCPIP_TX_BATCH_SIZE + 1];
+#ifdef TCPIP_USE_UDP_GSO
+  union {
+    char buf[CMSG_SPACE(sizeof(uint16_t))];
+    struct cmsghdr align;
+  } ctrls[TCPIP_TX_BATCH_SIZE];
+  struct cmsghdr *cmsg;
+  TcpIp_TxBatchSlotType *head = NULL;
+  TcpIp_TxBatchSlotType *prev = NULL;
+#endif
+  TcpIp_SocketIdType SocketId = lTxBatch[first].SocketId;
+  TcpIp_TxBatchSlotType *slot;
+  boolean merged;
+  uint16_t numOfIovs = 0;
+  uint16_t numOfMsgs = 0;
+  uint16_t numOfSent = 0;
+  uint16_t i, j;
+  int r;
+
+  memset(mmsgs, 0, sizeof(mmsgs));
+  for (i = first; i < lTxBatchNum; i++) {
+    slot = &lTxBatch[i];
+    if ((SocketId == slot->SocketId) && (FALSE == slot->sent)) {
+      slots[numOfIovs] = i;
+      iovs[numOfIovs].iov_base = slot->data;
+      iovs[numOfIovs].iov_len = slot->Length;
+      merged = FALSE;
+#ifdef TCPIP_USE_UDP_GSO
+      if (NULL != head) {
+        merged = tcpIpTxBatchCanMerge(head, prev, slot, mmsgs[numOfMsgs - 1].msg_hdr.msg_iovlen,
+                                      totals[numOfMsgs - 1]);
+      }
+      if (FALSE == merged) {
+        head = slot;
+      }
+      prev = slot;
+#endif
+      if (TRUE == merged) {
+        mmsgs[numOfMsgs - 1].msg_hdr.msg_iovlen++;
+        totals[numOfMsgs - 1] += slot->Length;
+      } else {
+        mmsgs[numOfMsgs].msg_hdr.msg_name = &slot->toAddr;
+        mmsgs[numOfMsgs].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        mmsgs[numOfMsgs].msg_hdr.msg_iov = &iovs[numOfIovs];
+        mmsgs[numOfMsgs].msg_hdr.msg_iovlen = 1;
+        totals[numOfMsgs] = slot->Length;
+        firstIovs[numOfMsgs] = numOfIovs;
+        numOfMsgs++;
+      }
+      numOfIovs++;
+    }
+  }
+  firstIovs[numOfMsgs] = numOfIovs;
+
+#ifdef TCPIP_USE_UDP_GSO
+  for (i = 0; i < numOfMsgs; i++) {
+    if (mmsgs[i].msg_hdr.msg_iovlen > 1) {
+      mmsgs[i].msg_hdr.msg_control = ctrls[i].buf;
+      mmsgs[i].msg_hdr.msg_controllen = sizeof(ctrls[i].buf);
+      cmsg = CMSG_FIRSTHDR(&mmsgs[i].msg_hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      *(uint16_t *)CMSG_DATA(cmsg) = (uint16_t)mmsgs[i].msg_hdr.msg_iov[0].iov_len;
+    }
+  }
+#endif
+
+  /* sendmmsg fails only if its first message fails, the error is of that message */
+  while (numOfSent < numOfMsgs) {
+    r = sendmmsg(SocketId, &mmsgs[numOfSent], numOfMsgs - numOfSent, 0);
+    if (r > 0) {
+      for (i = numOfSent; i < (numOfSent + r); i++) {
+        if (mmsgs[i].msg_len != totals[i]) {
+          ASLOG(TCPIPE,
+                ("[%d] sendmmsg[%d] %d/%d bytes\n", SocketId, i, mmsgs[i].msg_len, totals[i]));
+        }
+      }
+      numOfSent += (uint16_t)r;
+    } else if ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (ENOBUFS == errno) ||
+               (EINTR == errno)) {
+      ASLOG(TCPIP, ("[%d] sendmmsg busy, %d messages kept\n", SocketId, numOfMsgs - numOfSent));
+      break;
+    } else {
+      ASLOG(TCPIPE, ("[%d] sendmmsg[%d] error %d, %d datagrams dropped\n", SocketId, numOfSent,
+                     errno, firstIovs[numOfSent + 1] - firstIovs[numOfSent]));
+      tcpIpTxBatchSetFailed(SocketId);
+      numOfSent++;
+    }
+  }
+
+  for (j = 0; j < firstIovs[numOfSent]; j++) {
+    lTxBatch[slots[j]].sent = TRUE;
+  }
+
+  ASLOG(TCPIP, ("[%d] sendmmsg %d datagrams in %d/%d messages\n", SocketId, firstIovs[numOfSent],
+                numOfSent, numOfMsgs));
+}
+
+/* drop the queued datagrams of a closed socket, its fd number may be reused */
+static void tcpIpTxBatchDrop(TcpIp_SocketIdType SocketId) {
+  uint16_t i;
+
+  for (i = 0; i < lTxBatchNum; i++) {
+    if ((lTxBatch[i].SocketId == SocketId) && (FALSE == lTxBatch[i].sent)) {
+      lTxBatch[i].sent = TRUE;
+      ASLOG(TCPIPE, ("[%d] closed, queued datagram dropped\n", SocketId));
+    }
+  }
+  (void)tcpIpTxBatchTakeFailed(SocketId);
+}
+#endif
+
 #ifdef USE_LWIP
 static void init_default_netif(const ip4_addr_t *ipaddr, const ip4_addr_t *netmask,
                                const ip4_addr_t *gw) {
@@ -253,6 +504,12 @@ void TcpIp_Init(const TcpIp_ConfigType *ConfigPtr) {
 #elif defined(_WIN32)
     WSADATA wsaData;
     WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+#ifdef USE_TCPIP_EPOLL
+    lEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (lEpollFd < 0) {
+      ASLOG(TCPIPE, ("epoll create failed: %d\n", errno));
+    }
 #endif
     lInitialized = TRUE;
   }
@@ -262,6 +519,7 @@ void TcpIp_MainFunction(void) {
 #ifdef USE_LWIP
   default_netif_poll();
 #endif
+  TcpIp_FlushTx();
 }
 
 TcpIp_SocketIdType TcpIp_Create(TcpIp_ProtocolType protocol) {
@@ -332,6 +590,11 @@ Std_ReturnType TcpIp_Close(TcpIp_SocketIdType SocketId, boolean Abort) {
   int r;
   Std_ReturnType ret = E_OK;
   (void)Abort;
+#ifdef TCPIP_TX_BATCH_SIZE
+  /* the fd number may be reused by the next socket */
+  TcpIp_FlushTx();
+  tcpIpTxBatchDrop(SocketId);
+#endif
 #if defined(_WIN32) && !defined(USE_LWIP)
   r = closesocket(SocketId);
 #else
@@ -528,6 +791,87 @@ Std_ReturnType TcpIp_IsTcpStatusOK(TcpIp_SocketIdType SocketId) {
   return ret;
 }
 
+#ifdef USE_LWIP
+Std_ReturnType TcpIp_RecvBuffer(TcpIp_SocketIdType SocketId, TcpIp_RecvBufferType *Buffer) {
+  Std_ReturnType ret = E_OK;
+  struct lwip_sock *sock = lwip_socket_dbg_get_socket(SocketId);
+  struct netbuf *nb = NULL;
+  struct pbuf *p = NULL;
+  struct pbuf *q;
+  err_t err = ERR_OK;
+
+  Buffer->BufPtr = NULL;
+  Buffer->Length = 0;
+  Buffer->pbuf = NULL;
+  Buffer->conn = NULL;
+
+  if ((NULL == sock) || (NULL == sock->conn)) {
+    ret = E_NOT_OK;
+  } else if (NETCONN_TCP == NETCONNTYPE_GROUP(netconn_type(sock->conn))) {
+    /* the window is updated by TcpIp_ReleaseBuffer after the data is consumed */
+    err = netconn_recv_tcp_pbuf_flags(sock->conn, &p, NETCONN_DONTBLOCK | NETCONN_NOAUTORCVD);
+    if (ERR_OK == err) {
+      Buffer->conn = sock->conn;
+    }
+  } else {
+    err = netconn_recv_udp_raw_netbuf_flags(sock->conn, &nb, NETCONN_DONTBLOCK);
+    if (ERR_OK == err) {
+      memcpy(Buffer->RemoteAddr.addr, &ip_2_ip4(netbuf_fromaddr(nb))->addr, 4);
+      Buffer->RemoteAddr.port = netbuf_fromport(nb);
+      p = nb->p;
+      nb->p = NULL;
+      netbuf_delete(nb);
+    }
+  }
+
+  if ((ERR_OK == err) && (NULL != p)) {
+    if (p->len != p->tot_len) {
+      q = pbuf_coalesce(p, PBUF_RAW);
+      if (q != p) {
+        p = q;
+      } else {
+        ASLOG(TCPIPE, ("[%d] no memory to linearize %d bytes\n", SocketId, p->tot_len));
+        ret = E_NOT_OK;
+      }
+    }
+    if (E_OK == ret) {
+      Buffer->BufPtr = (uint8_t *)p->payload;
+      Buffer->Length = p->tot_len;
+      Buffer->pbuf = p;
+      ASLOG(TCPIP, ("[%d] lend %d bytes\n", SocketId, p->tot_len));
+    } else {
+      if (NULL != Buffer->conn) {
+        netconn_tcp_recvd((struct netconn *)Buffer->conn, p->tot_len);
+        Buffer->conn = NULL;
+      }
+      pbuf_free(p);
+    }
+  } else if (ERR_WOULDBLOCK == err) {
+    /* got nothing */
+  } else if (E_OK == ret) {
+    ASLOG(TCPIP, ("[%d] netconn recv got error %d\n", SocketId, err));
+    ret = E_NOT_OK;
+  } else {
+    /* bad socket */
+  }
+
+  return ret;
+}
+
+void TcpIp_ReleaseBuffer(TcpIp_RecvBufferType *Buffer) {
+  if (NULL != Buffer->pbuf) {
+    if (NULL != Buffer->conn) {
+      netconn_tcp_recvd((struct netconn *)Buffer->conn, (size_t)Buffer->Length);
+    }
+    pbuf_free((struct pbuf *)Buffer->pbuf);
+    Buffer->pbuf = NULL;
+    Buffer->conn = NULL;
+    Buffer->BufPtr = NULL;
+    Buffer->Length = 0;
+  }
+}
+#endif
+
 Std_ReturnType TcpIp_Recv(TcpIp_SocketIdType SocketId, uint8_t *BufPtr,
                           uint32_t *Length /* InOut */) {
   Std_ReturnType ret = E_OK;
@@ -591,6 +935,76 @@ Std_ReturnType TcpIp_RecvFrom(TcpIp_SocketIdType SocketId, TcpIp_SockAddrType *R
   return ret;
 }
 
+#if defined(linux) && !defined(USE_LWIP)
+Std_ReturnType TcpIp_RecvFromMulti(TcpIp_SocketIdType SocketId, TcpIp_RecvMsgType *Msgs,
+                                   uint16_t *Num /* InOut */) {
+  Std_ReturnType ret = E_OK;
+  struct mmsghdr mmsgs[TCPIP_RECV_MULTI_MAX];
+  struct iovec iovs[TCPIP_RECV_MULTI_MAX];
+  struct sockaddr_in fromAddrs[TCPIP_RECV_MULTI_MAX];
+  uint16_t num = *Num;
+  int i, n;
+
+  if (num > TCPIP_RECV_MULTI_MAX) {
+    num = TCPIP_RECV_MULTI_MAX;
+  }
+
+  memset(mmsgs, 0, sizeof(struct mmsghdr) * num);
+  for (i = 0; i < num; i++) {
+    iovs[i].iov_base = Msgs[i].BufPtr;
+    iovs[i].iov_len = Msgs[i].Length;
+    mmsgs[i].msg_hdr.msg_iov = &iovs[i];
+    mmsgs[i].msg_hdr.msg_iovlen = 1;
+    mmsgs[i].msg_hdr.msg_name = &fromAddrs[i];
+    mmsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+  }
+
+  n = recvmmsg(SocketId, mmsgs, num, MSG_DONTWAIT, NULL);
+  *Num = 0;
+  if (n > 0) {
+    for (i = 0; i < n; i++) {
+      Msgs[i].RemoteAddr.port = htons(fromAddrs[i].sin_port);
+      memcpy(Msgs[i].RemoteAddr.addr, &fromAddrs[i].sin_addr.s_addr, 4);
+      if (mmsgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        ASLOG(TCPIPE, ("[%d] datagram truncated to %d bytes\n", SocketId, Msgs[i].Length));
+        Msgs[i].Length = 0;
+      } else {
+        Msgs[i].Length = mmsgs[i].msg_len;
+      }
+    }
+    *Num = (uint16_t)n;
+    ASLOG(TCPIP, ("[%d] recv %d datagrams\n", SocketId, n));
+  } else if ((n < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+    ret = E_NOT_OK;
+    ASLOG(TCPIPE, ("[%d] recvmmsg got error %d\n", SocketId, errno));
+  } else {
+    /* got nothing */
+  }
+
+  return ret;
+}
+#else
+Std_ReturnType TcpIp_RecvFromMulti(TcpIp_SocketIdType SocketId, TcpIp_RecvMsgType *Msgs,
+                                   uint16_t *Num /* InOut */) {
+  Std_ReturnType ret = E_OK;
+  uint16_t i;
+
+  for (i = 0; i < *Num; i++) {
+    ret = TcpIp_RecvFrom(SocketId, &Msgs[i].RemoteAddr, Msgs[i].BufPtr, &Msgs[i].Length);
+    if ((E_OK != ret) || (0 == Msgs[i].Length)) {
+      break;
+    }
+  }
+
+  if (i > 0) {
+    ret = E_OK; /* the error if any will be reported by the next call */
+  }
+  *Num = i;
+
+  return ret;
+}
+#endif
+
 Std_ReturnType TcpIp_SendTo(TcpIp_SocketIdType SocketId, const TcpIp_SockAddrType *RemoteAddrPtr,
                             const uint8_t *BufPtr, uint32_t Length) {
   Std_ReturnType ret = E_OK;
@@ -625,6 +1039,87 @@ Std_ReturnType TcpIp_SendTo(TcpIp_SocketIdType SocketId, const TcpIp_SockAddrTyp
   return ret;
 }
 
+Std_ReturnType TcpIp_SendToQueued(TcpIp_SocketIdType SocketId,
+                                  const TcpIp_SockAddrType *RemoteAddrPtr, const uint8_t *BufPtr,
+                                  uint32_t Length) {
+  Std_ReturnType ret = E_OK;
+#ifdef TCPIP_TX_BATCH_SIZE
+  TcpIp_TxBatchSlotType *slot;
+  boolean queue = FALSE;
+
+  if (TRUE == tcpIpTxBatchTakeFailed(SocketId)) {
+    /* as the socket does with its pending error, fail the next send */
+    ASLOG(TCPIPE, ("[%d] a queued datagram was dropped\n", SocketId));
+    ret = E_NOT_OK;
+  } else if (Length <= TCPIP_TX_BATCH_BUFFER_SIZE) {
+    if (lTxBatchNum >= TCPIP_TX_BATCH_SIZE) {
+      TcpIp_FlushTx();
+    }
+    if (lTxBatchNum >= TCPIP_TX_BATCH_SIZE) {
+      ASLOG(TCPIPE, ("[%d] Tx batch full\n", SocketId));
+      ret = E_NOT_OK;
+    } else {
+      queue = TRUE;
+    }
+  } else {
+    /* flush first to keep the order of this socket */
+    TcpIp_FlushTx();
+    if (TRUE == tcpIpTxBatchIsQueued(SocketId)) {
+      ret = E_NOT_OK;
+    } else {
+      ret = TcpIp_SendTo(SocketId, RemoteAddrPtr, BufPtr, Length);
+    }
+  }
+
+  if (TRUE == queue) {
+    slot = &lTxBatch[lTxBatchNum];
+    slot->SocketId = SocketId;
+    memset(&slot->toAddr, 0, sizeof(slot->toAddr));
+    slot->toAddr.sin_family = AF_INET;
+    memcpy(&slot->toAddr.sin_addr.s_addr, RemoteAddrPtr->addr, 4);
+    slot->toAddr.sin_port = htons(RemoteAddrPtr->port);
+    slot->Length = Length;
+    slot->sent = FALSE;
+    memcpy(slot->data, BufPtr, Length);
+    lTxBatchNum++;
+    ASLOG(TCPIP, ("[%d] queue to %d.%d.%d.%d:%d %d bytes\n", SocketId, RemoteAddrPtr->addr[0],
+                  RemoteAddrPtr->addr[1], RemoteAddrPtr->addr[2], RemoteAddrPtr->addr[3],
+                  RemoteAddrPtr->port, Length));
+  }
+#else
+  ret = TcpIp_SendTo(SocketId, RemoteAddrPtr, BufPtr, Length);
+#endif
+  return ret;
+}
+
+void TcpIp_FlushTx(void) {
+#ifdef TCPIP_TX_BATCH_SIZE
+  uint16_t i, j;
+
+  for (i = 0; i < lTxBatchNum; i++) {
+    if (FALSE == lTxBatch[i].sent) {
+      /* once per socket, from its first queued datagram */
+      for (j = 0; (j < i) && (lTxBatch[j].SocketId != lTxBatch[i].SocketId); j++) {
+      }
+      if (j >= i) {
+        tcpIpTxBatchFlushSocket(i);
+      }
+    }
+  }
+
+  /* keep the datagrams of the busy sockets in order for the next flush */
+  for (i = 0, j = 0; i < lTxBatchNum; i++) {
+    if (FALSE == lTxBatch[i].sent) {
+      if (j != i) {
+        lTxBatch[j] = lTxBatch[i];
+      }
+      j++;
+    }
+  }
+  lTxBatchNum = j;
+#endif
+}
+
 Std_ReturnType TcpIp_Send(TcpIp_SocketIdType SocketId, const uint8_t *BufPtr, uint32_t Length) {
   Std_ReturnType ret = E_OK;
   int nbytes;
@@ -764,4 +1259,77 @@ uint16_t TcpIp_Tell(TcpIp_SocketIdType SocketId) {
   }
 
   return Length;
-}
\ No newline at end of file
+}
+
+#ifdef USE_TCPIP_EPOLL
+Std_ReturnType TcpIp_Watch(TcpIp_SocketIdType SocketId, uint32_t cookie) {
+  Std_ReturnType ret = E_OK;
+  struct epoll_event ev;
+  int r;
+
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.u64 = ((uint64_t)cookie << 32) | (uint32_t)SocketId;
+  r = epoll_ctl(lEpollFd, EPOLL_CTL_ADD, SocketId, &ev);
+  if ((0 != r) && (EEXIST == errno)) {
+    r = epoll_ctl(lEpollFd, EPOLL_CTL_MOD, SocketId, &ev);
+  }
+
+  if (0 != r) {
+    ASLOG(TCPIPE, ("[%d] watch failed: %d\n", SocketId, errno));
+    ret = E_NOT_OK;
+  }
+
+  return ret;
+}
+
+Std_ReturnType TcpIp_Unwatch(TcpIp_SocketIdType SocketId) {
+  Std_ReturnType ret = E_OK;
+  struct epoll_event ev;
+  int r;
+
+  r = epoll_ctl(lEpollFd, EPOLL_CTL_DEL, SocketId, &ev);
+  if (0 != r) {
+    ret = E_NOT_OK;
+  }
+
+  return ret;
+}
+
+int TcpIp_WaitEvents(TcpIp_SocketEventType *events, int maxEvents, uint32_t timeoutMs) {
+  struct epoll_event evs[32];
+  int i, n;
+
+  if (maxEvents > (int)ARRAY_SIZE(evs)) {
+    maxEvents = (int)ARRAY_SIZE(evs);
+  }
+
+  n = epoll_wait(lEpollFd, evs, maxEvents, (int)timeoutMs);
+  for (i = 0; i < n; i++) {
+    events[i].cookie = (uint32_t)(evs[i].data.u64 >> 32);
+    events[i].SocketId = (TcpIp_SocketIdType)(evs[i].data.u64 & 0xFFFFFFFFu);
+    events[i].events = 0;
+    if (evs[i].events & EPOLLIN) {
+      events[i].events |= TCPIP_EVENT_READ;
+    }
+    if (evs[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+      events[i].events |= TCPIP_EVENT_HANGUP;
+    }
+  }
+
+  if (n < 0) {
+    n = 0;
+  }
+
+  return n;
+}
+
+boolean TcpIp_Wait(uint32_t timeoutMs) {
+  struct epoll_event ev;
+  int n;
+
+  /* level triggered, so the ready socket will be reported again by TcpIp_WaitEvents */
+  n = epoll_wait(lEpollFd, &ev, 1, (int)timeoutMs);
+
+  return (n > 0);
+}
+#endif
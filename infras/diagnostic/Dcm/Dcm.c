@@ -21,6 +21,81 @@
 static Dcm_ContextType Dcm_Context;
 extern const Dcm_ConfigType Dcm_Config;
 /* ================================ [ LOCALS    ] ============================================== */
+#ifdef DCM_USE_PAGED_BUFFER
+/* drop the first start bytes of the page as consumed and fill the room left with the next page */
+static BufReq_ReturnType Dcm_UpdateTxPage(Dcm_ContextType *context, const Dcm_ConfigType *config,
+                                          PduLengthType start, boolean allowPending) {
+  BufReq_ReturnType ret = BUFREQ_E_NOT_OK;
+  Std_ReturnType r = E_NOT_OK;
+  Dcm_NegativeResponseCodeType nrc = DCM_POS_RESP;
+  PduLengthType left = context->TxPageLength - start;
+  PduLengthType end = context->TxPageIndex + context->TxPageLength;
+  Dcm_MsgLenType length = config->txBufferSize - left;
+
+  if (length > (context->TxTpSduLength - end)) {
+    length = context->TxTpSduLength - end;
+  }
+
+  if ((NULL != context->TxPageFnc) && (length > 0)) {
+    if (start > 0) {
+      memmove(config->txBuffer, &config->txBuffer[start], left);
+      context->TxPageIndex += start;
+      context->TxPageLength = left;
+    }
+    r = context->TxPageFnc(context->pageOpStatus, &config->txBuffer[left], end - 1, &length, &nrc);
+  }
+
+  if ((E_OK == r) && (length > 0)) {
+    context->pageOpStatus = DCM_INITIAL;
+    context->TxPageLength += length;
+    ret = BUFREQ_OK;
+  } else if ((DCM_E_PENDING == r) && allowPending) {
+    context->pageOpStatus = DCM_PENDING;
+    ret = BUFREQ_E_BUSY;
+  } else {
+    ASLOG(DCME, ("Tx page update at %d failed: r = %d, nrc = 0x%02X\n", end, r, nrc));
+  }
+
+  return ret;
+}
+
+static BufReq_ReturnType Dcm_CopyTxPage(Dcm_ContextType *context, const Dcm_ConfigType *config,
+                                        const PduInfoType *info) {
+  BufReq_ReturnType ret = BUFREQ_OK;
+  PduLengthType copied = 0;
+  PduLengthType start;
+  PduLengthType left;
+
+  if (context->TxPageLength > config->txBufferSize) {
+    ASLOG(DCME, ("Tx page length %d over the buffer, clamped\n", context->TxPageLength));
+    context->TxPageLength = config->txBufferSize;
+  }
+
+  if ((context->TxTpSduLength - context->TxIndex) < info->SduLength) {
+    ASLOG(DCME, ("copy Tx %d bytes at %d over length %d\n", info->SduLength, context->TxIndex,
+                 context->TxTpSduLength));
+    ret = BUFREQ_E_NOT_OK;
+  }
+
+  while ((BUFREQ_OK == ret) && (copied < info->SduLength)) {
+    start = context->TxIndex + copied - context->TxPageIndex;
+    left = context->TxPageLength - start;
+    if (left >= (info->SduLength - copied)) {
+      memcpy(&info->SduDataPtr[copied], &config->txBuffer[start], info->SduLength - copied);
+      copied = info->SduLength;
+    } else if ((0 == start) && (left > 0) && (DCM_PENDING != context->pageOpStatus)) {
+      /* the chunk is larger than what the page could be extended to, hand out the page first */
+      memcpy(&info->SduDataPtr[copied], config->txBuffer, left);
+      copied += left;
+    } else {
+      /* the pages handed out are gone, so only the first update of a chunk may be pending */
+      ret = Dcm_UpdateTxPage(context, config, start, (0 == copied));
+    }
+  }
+
+  return ret;
+}
+#endif
 /* ================================ [ FUNCTIONS ] ============================================== */
 Dcm_ContextType *Dcm_GetContext(void) {
   return (&Dcm_Context);
@@ -63,6 +138,9 @@ void Dcm_MainFunction_Response(void) {
   PduInfoType PduInfo;
   Dcm_ContextType *context = Dcm_GetContext();
   const Dcm_ConfigType *config = Dcm_GetConfig();
+#ifdef DCM_USE_PAGED_BUFFER
+  Dcm_DspUpdatePageFncType pageFnc = context->TxPageFnc;
+#endif
 
   if (DCM_RESPONSE_PENDING == context->responcePending) {
     PduInfo.MetaDataPtr = NULL;
@@ -79,10 +157,28 @@ void Dcm_MainFunction_Response(void) {
     PduInfo.SduLength = context->TxTpSduLength;
     context->txBufferState = DCM_BUFFER_PROVIDED;
     context->TxIndex = 0;
+#ifdef DCM_USE_PAGED_BUFFER
+    context->TxPageIndex = 0;
+    if (NULL == context->TxPageFnc) {
+      context->TxPageLength = context->TxTpSduLength;
+    }
+#endif
     ASLOG(DCM, ("Tx %02X %02X ...\n", config->txBuffer[0], config->txBuffer[1]));
     r = PduR_DcmTransmit(context->curPduId, &PduInfo);
     if (E_OK != r) {
+#ifdef DCM_USE_PAGED_BUFFER
+      if ((NULL != pageFnc) &&
+          ((DCM_BUFFER_PROVIDED != context->txBufferState) || (0 != context->TxPageIndex))) {
+        /* the TP has already consumed pages of the response, they can't be sent again */
+        ASLOG(DCME, ("paged response failed to be transmitted, drop it\n"));
+        context->TxPageFnc = NULL;
+        context->txBufferState = DCM_BUFFER_IDLE;
+      } else {
+        context->txBufferState = DCM_BUFFER_FULL; /* try next time */
+      }
+#else
       context->txBufferState = DCM_BUFFER_FULL; /* try next time */
+#endif
     }
   } else {
     /* do nothing */
@@ -175,6 +271,9 @@ void Dcm_TpRxIndication(PduIdType id, Std_ReturnType result) {
       context->msgContext.resData = &config->txBuffer[1];
       context->msgContext.resDataLen = 0;
       context->msgContext.resMaxDataLen = config->txBufferSize - 1;
+#ifdef DCM_USE_PAGED_BUFFER
+      context->updatePageFnc = NULL;
+#endif
       context->opStatus = DCM_INITIAL;
       context->rxBufferState = DCM_BUFFER_FULL;
       ASLOG(DCM, ("Rx %02X %02X ...\n", config->rxBuffer[0], config->rxBuffer[1]));
@@ -202,13 +301,31 @@ BufReq_ReturnType Dcm_CopyTxData(PduIdType id, const PduInfoType *info, const Re
     ret = BUFREQ_OK;
   } else if (DCM_BUFFER_PROVIDED == context->txBufferState) {
     if (context->curPduId == id) {
+#ifdef DCM_USE_PAGED_BUFFER
+      ret = Dcm_CopyTxPage(context, config, info);
+#else
       memcpy(info->SduDataPtr, &config->txBuffer[context->TxIndex], info->SduLength);
-      context->TxIndex += info->SduLength;
-      *availableDataPtr = context->TxTpSduLength - context->TxIndex;
       ret = BUFREQ_OK;
+#endif
+      if (BUFREQ_OK == ret) {
+        context->TxIndex += info->SduLength;
+        *availableDataPtr = context->TxTpSduLength - context->TxIndex;
+#ifdef DCM_USE_PAGED_BUFFER
+      } else if (BUFREQ_E_NOT_OK == ret) {
+        /* the transport aborts the response, nothing may call the page function again */
+        ASLOG(DCME, ("Tx page failed, reset to Idle\n"));
+        context->txBufferState = DCM_BUFFER_IDLE;
+        context->TxPageFnc = NULL;
+#endif
+      } else {
+        /* busy, the page update is pending */
+      }
     } else {
       ASLOG(DCME, ("Fatal Error when copy Tx Data, reset to Idle\n"));
       context->txBufferState = DCM_BUFFER_IDLE;
+#ifdef DCM_USE_PAGED_BUFFER
+      context->TxPageFnc = NULL;
+#endif
     }
   } else {
     ASLOG(DCME, ("Fatal Error when copy Tx Data, do nothing\n"));
@@ -234,5 +351,8 @@ void Dcm_TpTxConfirmation(PduIdType id, Std_ReturnType result) {
     /* comment out for Periodic DID */
     /* context->curPduId = DCM_INVALID_PDU_ID; */
     context->txBufferState = DCM_BUFFER_IDLE;
+#ifdef DCM_USE_PAGED_BUFFER
+    context->TxPageFnc = NULL;
+#endif
   }
 }
\ No newline at end of file
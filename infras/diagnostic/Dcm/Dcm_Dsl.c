@@ -77,6 +77,15 @@ void Dcm_DslProcessingDone(Dcm_ContextType *context, const Dcm_ConfigType *confi
     } else {
       config->txBuffer[0] = config->rxBuffer[0] | SID_RESPONSE_BIT;
       context->TxTpSduLength = context->msgContext.resDataLen + 1;
+#ifdef DCM_USE_PAGED_BUFFER
+      /* the first page is in txBuffer, the rest is filled by Dcm_CopyTxData */
+      context->TxPageFnc = context->updatePageFnc;
+      if (NULL != context->updatePageFnc) {
+        context->TxPageLength = context->TxTpSduLength;
+        context->TxTpSduLength = context->pagedResDataLen + 1;
+        context->pageOpStatus = DCM_INITIAL;
+      }
+#endif
       context->txBufferState = DCM_BUFFER_FULL;
     }
     context->opStatus = DCM_INITIAL;
@@ -95,14 +104,33 @@ void Dcm_DslProcessingDone(Dcm_ContextType *context, const Dcm_ConfigType *confi
     config->txBuffer[2] = nrc;
 
     context->TxTpSduLength = 3;
+#ifdef DCM_USE_PAGED_BUFFER
+    context->TxPageFnc = NULL;
+#endif
     context->txBufferState = DCM_BUFFER_FULL;
     context->rxBufferState = DCM_BUFFER_IDLE;
 
     context->opStatus = DCM_INITIAL;
     context->timerP2Server = 0;
   }
+
+#ifdef DCM_USE_PAGED_BUFFER
+  if (DCM_E_RESPONSE_PENDING != nrc) {
+    context->updatePageFnc = NULL;
+  }
+#endif
 }
 
+#ifdef DCM_USE_PAGED_BUFFER
+void Dcm_DslStartPagedProcessing(Dcm_MsgLenType resDataLen,
+                                 Dcm_DspUpdatePageFncType updatePageFnc) {
+  Dcm_ContextType *context = Dcm_GetContext();
+
+  context->pagedResDataLen = resDataLen;
+  context->updatePageFnc = updatePageFnc;
+}
+#endif
+
 Std_ReturnType Dcm_DslIsSessionSupported(Dcm_SesCtrlType sesCtrl, uint8_t sesMask) {
   Std_ReturnType r = E_NOT_OK;
   uint8_t mask = Dcm_DslSession2Mask(sesCtrl);
@@ -17,7 +17,115 @@
 /* ================================ [ TYPES     ] ============================================== */
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
+#ifdef DCM_USE_SERVICE_READ_DATA_BY_IDENTIFIER
+/* the DIDs of the ongoing ReadDataByIdentifier request resolved by its check pass */
+static uint16_t Dcm_ReadDIDIndexs[DCM_READ_DID_MAX_CACHED];
+#endif
+
+#if defined(DCM_USE_SERVICE_READ_MEMORY_BY_ADDRESS) && defined(DCM_USE_PAGED_BUFFER)
+/* the memoryAddress of the ongoing paged ReadMemoryByAddress response */
+static uint32_t Dcm_ReadMemoryPageAddress;
+#endif
 /* ================================ [ LOCALS    ] ============================================== */
+#if defined(DCM_USE_SERVICE_READ_MEMORY_BY_ADDRESS) && defined(DCM_USE_PAGED_BUFFER)
+static Std_ReturnType Dcm_DspReadMemoryPage(Dcm_OpStatusType opStatus, uint8_t *data,
+                                            Dcm_MsgLenType offset, Dcm_MsgLenType *length,
+                                            Dcm_NegativeResponseCodeType *nrc) {
+  Std_ReturnType r = E_NOT_OK;
+  Dcm_ReturnReadMemoryType rm;
+
+  rm = Dcm_ReadMemory(opStatus, 0x00, Dcm_ReadMemoryPageAddress + offset, *length, data, nrc);
+  if ((DCM_READ_PENDING == rm) || (DCM_READ_FORCE_RCRRP == rm)) {
+    r = DCM_E_PENDING;
+  } else if (DCM_READ_OK == rm) {
+    r = E_OK;
+  } else {
+    /* FAILED */
+  }
+
+  return r;
+}
+#endif
+
+#if defined(DCM_USE_SERVICE_READ_DTC_INFORMATION) && defined(DCM_USE_PAGED_BUFFER)
+/* the DTC filter set by the request is kept, so the pages simply continue with the next DTCs */
+static Std_ReturnType Dem_DspReportDTCByStatusMaskPage(Dcm_OpStatusType opStatus, uint8_t *data,
+                                                       Dcm_MsgLenType offset,
+                                                       Dcm_MsgLenType *length,
+                                                       Dcm_NegativeResponseCodeType *nrc) {
+  Std_ReturnType r = E_OK;
+  Dcm_MsgLenType filled = 0;
+  uint32_t DTCNumber;
+  Dem_UdsStatusByteType udsStatus;
+
+  (void)opStatus;
+  (void)offset;
+  while (((filled + 4) <= *length) && (E_OK == r)) {
+    r = Dem_GetNextFilteredDTC(0, &DTCNumber, &udsStatus);
+    if (E_OK == r) {
+      data[filled] = (uint8_t)((DTCNumber >> 16) & 0xFF);
+      data[filled + 1] = (uint8_t)((DTCNumber >> 8) & 0xFF);
+      data[filled + 2] = (uint8_t)(DTCNumber & 0xFF);
+      data[filled + 3] = udsStatus;
+      filled += 4;
+    } else {
+      *nrc = DCM_E_REQUEST_OUT_OF_RANGE;
+    }
+  }
+  *length = filled;
+
+  return r;
+}
+#endif
+
+#if defined(DCM_USE_SERVICE_READ_DATA_BY_IDENTIFIER) ||                                            \
+  defined(DCM_USE_SERVICE_WRITE_DATA_BY_IDENTIFIER) ||                                             \
+  defined(DCM_USE_SERVICE_INPUT_OUTPUT_CONTROL_BY_IDENTIFIER)
+/* binary search of the generated sorted id table, return the index of id or -1 */
+static int Dcm_DspFindDID(const uint16_t *ids, uint16_t numOfIds, uint16_t id) {
+  int index = -1;
+  int low = 0;
+  int high = (int)numOfIds - 1;
+  int mid;
+
+  while ((low <= high) && (index < 0)) {
+    mid = (low + high) >> 1;
+    if (ids[mid] == id) {
+      index = mid;
+    } else if (ids[mid] < id) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+
+  return index;
+}
+#endif
+
+#ifdef DCM_USE_SERVICE_READ_DATA_BY_IDENTIFIER
+static const Dcm_ReadDIDType *Dcm_DspFindReadDID(const Dcm_ReadDIDConfigType *rDidConfig,
+                                                 uint16_t id) {
+  const Dcm_ReadDIDType *rDid = NULL;
+  int index;
+  int i;
+
+  index = Dcm_DspFindDID(rDidConfig->ids, rDidConfig->numOfIds, id);
+  if (index >= 0) {
+    rDid = &rDidConfig->DIDs[index];
+  } else {
+    /* the dynamically defined DIDs change their id at runtime, so they are not sorted */
+    for (i = rDidConfig->numOfIds; (NULL == rDid) && (i < rDidConfig->numOfDIDs); i++) {
+      if (rDidConfig->DIDs[i].rDID->id == id) {
+        rDid = &rDidConfig->DIDs[i];
+      }
+    }
+  }
+
+  return rDid;
+}
+#endif
+
 #ifdef DCM_USE_SERVICE_ROUTINE_CONTROL
 Std_ReturnType Dcm_DspRoutineControlStart(Dcm_MsgContextType *msgContext, Dcm_OpStatusType OpStatus,
                                           const Dcm_RoutineControlType *rtCtrl,
@@ -790,20 +898,17 @@ Std_ReturnType Dcm_DspReadDataByIdentifier(Dcm_MsgContextType *msgContext,
   uint16_t numOfDids = 0;
   Dcm_MsgLenType totalResLength = 0;
   boolean forceRCRRP = FALSE;
-  int i, j;
+  int i;
 
   if ((msgContext->reqDataLen >= 2) && ((msgContext->reqDataLen & 0x01) == 0)) {
     numOfDids = msgContext->reqDataLen >> 1;
     for (i = 0; (i < numOfDids) && (E_OK == r) && (DCM_INITIAL == context->opStatus); i++) {
-      rDid = NULL;
       id = ((uint16_t)msgContext->reqData[i * 2] << 8) + msgContext->reqData[i * 2 + 1];
-      for (j = 0; j < rDidConfig->numOfDIDs; j++) {
-        if (rDidConfig->DIDs[j].rDID->id == id) {
-          rDid = &rDidConfig->DIDs[j];
-          break;
-        }
-      }
+      rDid = Dcm_DspFindReadDID(rDidConfig, id);
       if (NULL != rDid) {
+        if (i < DCM_READ_DID_MAX_CACHED) {
+          Dcm_ReadDIDIndexs[i] = (uint16_t)(rDid - rDidConfig->DIDs);
+        }
         totalResLength += rDid->rDID->length + 2;
         r = Dcm_DslServiceDIDSesSecPhyFuncCheck(context, &rDid->rDID->SesSecAccess, nrc);
       } else {
@@ -826,13 +931,11 @@ Std_ReturnType Dcm_DspReadDataByIdentifier(Dcm_MsgContextType *msgContext,
   if (E_OK == r) {
     totalResLength = 0;
     for (i = 0; (i < numOfDids) && (E_OK == r); i++) {
-      rDid = NULL;
       id = ((uint16_t)msgContext->reqData[i * 2] << 8) + msgContext->reqData[i * 2 + 1];
-      for (j = 0; j < rDidConfig->numOfDIDs; j++) {
-        if (rDidConfig->DIDs[j].rDID->id == id) {
-          rDid = &rDidConfig->DIDs[j];
-          break;
-        }
+      if (i < DCM_READ_DID_MAX_CACHED) {
+        rDid = &rDidConfig->DIDs[Dcm_ReadDIDIndexs[i]];
+      } else {
+        rDid = Dcm_DspFindReadDID(rDidConfig, id);
       }
       if (NULL != rDid) {
         msgContext->resData[totalResLength] = (id >> 8) & 0xFF;
@@ -887,16 +990,13 @@ Std_ReturnType Dcm_DspWriteDataByIdentifier(Dcm_MsgContextType *msgContext,
     (const Dcm_WriteDIDConfigType *)context->curService->config;
   const Dcm_WriteDIDType *wDid = NULL;
   uint16_t id;
-  int i;
+  int index;
 
   if (msgContext->reqDataLen > 2) {
-    wDid = NULL;
     id = ((uint16_t)msgContext->reqData[0] << 8) + msgContext->reqData[1];
-    for (i = 0; i < wDidConfig->numOfDIDs; i++) {
-      if (wDidConfig->DIDs[i].id == id) {
-        wDid = &wDidConfig->DIDs[i];
-        break;
-      }
+    index = Dcm_DspFindDID(wDidConfig->ids, wDidConfig->numOfDIDs, id);
+    if (index >= 0) {
+      wDid = &wDidConfig->DIDs[index];
     }
 
     if (NULL != wDid) {
@@ -1067,6 +1167,7 @@ Std_ReturnType Dem_DspReportDTCByStatusMask_Impl(Dcm_MsgContextType *msgContext,
   Std_ReturnType r = E_NOT_OK;
   uint8_t statusMask;
   uint16_t NumberOfFilteredDTC = 0;
+  uint16_t numOfDTCs = 0;
   uint32_t DTCNumber;
   Dem_UdsStatusByteType udsStatus;
   int i;
@@ -1081,10 +1182,17 @@ Std_ReturnType Dem_DspReportDTCByStatusMask_Impl(Dcm_MsgContextType *msgContext,
     }
 
     if (E_OK == r) {
-      if ((NumberOfFilteredDTC * 4 + 2) <= msgContext->resMaxDataLen) {
+      numOfDTCs = NumberOfFilteredDTC;
+#ifdef DCM_USE_PAGED_BUFFER
+      if (((Dcm_MsgLenType)NumberOfFilteredDTC * 4 + 2) > msgContext->resMaxDataLen) {
+        /* give the DTCs that fit into the first page, the rest as the TP consumes them */
+        numOfDTCs = (uint16_t)((msgContext->resMaxDataLen - 2) / 4);
+      }
+#endif
+      if (((Dcm_MsgLenType)numOfDTCs * 4 + 2) <= msgContext->resMaxDataLen) {
         msgContext->resData[0] = msgContext->reqData[0];
         msgContext->resData[1] = statusMask;
-        for (i = 0; (i < NumberOfFilteredDTC) && (E_OK == r); i++) {
+        for (i = 0; (i < numOfDTCs) && (E_OK == r); i++) {
           r = Dem_GetNextFilteredDTC(0, &DTCNumber, &udsStatus);
           if (E_OK == r) {
             msgContext->resData[2 + 4 * i] = (uint8_t)((DTCNumber >> 16) & 0xFF);
@@ -1094,7 +1202,13 @@ Std_ReturnType Dem_DspReportDTCByStatusMask_Impl(Dcm_MsgContextType *msgContext,
           }
         }
         if (E_OK == r) {
-          msgContext->resDataLen = NumberOfFilteredDTC * 4 + 2;
+          msgContext->resDataLen = numOfDTCs * 4 + 2;
+#ifdef DCM_USE_PAGED_BUFFER
+          if (numOfDTCs < NumberOfFilteredDTC) {
+            Dcm_DslStartPagedProcessing((Dcm_MsgLenType)NumberOfFilteredDTC * 4 + 2,
+                                        Dem_DspReportDTCByStatusMaskPage);
+          }
+#endif
         } else {
           *nrc = DCM_E_REQUEST_OUT_OF_RANGE;
         }
@@ -1318,18 +1432,16 @@ Std_ReturnType Dcm_DspIOControlByIdentifier(Dcm_MsgContextType *msgContext,
   uint16_t id;
   uint8_t action;
   uint16_t resDataLen = msgContext->resMaxDataLen - 3;
-  int i;
+  int index;
   const Dcm_IOCtrlExecuteFncType *ExecuteFncs;
 
   if (msgContext->reqDataLen >= 3) {
     id = ((uint16_t)msgContext->reqData[0] << 8) + msgContext->reqData[1];
     action = msgContext->reqData[2];
-    for (i = 0; i < config->numOfIOCtrls; i++) {
-      if (config->IOCtrls[i].id == id) {
-        IOCtrl = &config->IOCtrls[i];
-        r = E_OK;
-        break;
-      }
+    index = Dcm_DspFindDID(config->ids, config->numOfIOCtrls, id);
+    if (index >= 0) {
+      IOCtrl = &config->IOCtrls[index];
+      r = E_OK;
     }
 
     if (E_OK != r) {
@@ -1679,6 +1791,7 @@ Std_ReturnType Dcm_DspReadMemoryByAddress(Dcm_MsgContextType *msgContext,
   uint8_t memoryAddressLen;
   uint32_t memoryAddress;
   uint32_t memorySize;
+  uint32_t readSize;
   int i;
 
   if (msgContext->reqDataLen > 3) {
@@ -1712,15 +1825,22 @@ Std_ReturnType Dcm_DspReadMemoryByAddress(Dcm_MsgContextType *msgContext,
   }
 
   if (E_OK == r) {
+    readSize = memorySize;
     if (memorySize > msgContext->resMaxDataLen) {
+#ifdef DCM_USE_PAGED_BUFFER
+      /* read the first page here, the rest on the fly as the TP consumes the response */
+      readSize = msgContext->resMaxDataLen;
+#else
       *nrc = DCM_E_RESPONSE_TOO_LONG;
+      r = E_NOT_OK;
+#endif
     }
   }
 
   if (E_OK == r) {
     ASLOG(DCM, ("read memoryAddress=0x%X memorySize=0x%X\n", memoryAddress, memorySize));
     /* @SWS_Dcm_91070: MemoryIdentifier is not used, set it to 0x00 */
-    rm = Dcm_ReadMemory(context->opStatus, 0x00, memoryAddress, memorySize, &msgContext->resData[0],
+    rm = Dcm_ReadMemory(context->opStatus, 0x00, memoryAddress, readSize, &msgContext->resData[0],
                         nrc);
     if (DCM_READ_PENDING == rm) {
       *nrc = DCM_E_RESPONSE_PENDING;
@@ -1736,7 +1856,13 @@ Std_ReturnType Dcm_DspReadMemoryByAddress(Dcm_MsgContextType *msgContext,
   }
 
   if (E_OK == r) {
-    msgContext->resDataLen = memorySize;
+    msgContext->resDataLen = readSize;
+#ifdef DCM_USE_PAGED_BUFFER
+    if (readSize < memorySize) {
+      Dcm_ReadMemoryPageAddress = memoryAddress;
+      Dcm_DslStartPagedProcessing(memorySize, Dcm_DspReadMemoryPage);
+    }
+#endif
   }
 
   return r;
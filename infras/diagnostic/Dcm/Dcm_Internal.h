@@ -123,6 +123,11 @@
 #define DCM_DDDID_MAX_ENTRY 32
 #endif
 
+/* number of DIDs of one ReadDataByIdentifier request whose lookup is kept for the read pass */
+#ifndef DCM_READ_DID_MAX_CACHED
+#define DCM_READ_DID_MAX_CACHED 64
+#endif
+
 #define DCM_MEM_ATTR_READ ((uint8_t)0x01)
 #define DCM_MEM_ATTR_WRITE ((uint8_t)0x02)
 #define DCM_MEM_ATTR_EXECUTE ((uint8_t)0x04)
@@ -147,6 +152,15 @@ enum {
 
 typedef struct Dcm_Service_s Dcm_ServiceType;
 
+#ifdef DCM_USE_PAGED_BUFFER
+/* fill the next page of a paged response into data, offset is relative to resData, on input
+ * length is the room of the page and on output the number of bytes filled. The offsets are
+ * requested in sequence, DCM_E_PENDING asks to be called again with the same offset. */
+typedef Std_ReturnType (*Dcm_DspUpdatePageFncType)(Dcm_OpStatusType opStatus, uint8_t *data,
+                                                   Dcm_MsgLenType offset, Dcm_MsgLenType *length,
+                                                   Dcm_NegativeResponseCodeType *nrc);
+#endif
+
 #if defined(DCM_USE_SERVICE_REQUEST_DOWNLOAD) || defined(DCM_USE_SERVICE_REQUEST_UPLOAD)
 /* UDT = Upload Download Transfer */
 typedef enum {
@@ -193,6 +207,16 @@ typedef struct {
   uint8_t resetType;
   uint16_t timer2Reset;
 #endif
+#ifdef DCM_USE_PAGED_BUFFER
+  /* registered by the service being processed */
+  Dcm_DspUpdatePageFncType updatePageFnc;
+  Dcm_MsgLenType pagedResDataLen;
+  /* of the response being transmitted, txBuffer holds TxPageLength bytes from TxPageIndex */
+  Dcm_DspUpdatePageFncType TxPageFnc;
+  PduLengthType TxPageIndex;
+  PduLengthType TxPageLength;
+  Dcm_OpStatusType pageOpStatus;
+#endif
 } Dcm_ContextType;
 
 typedef struct {
@@ -299,7 +323,8 @@ typedef struct {
 
 typedef struct {
   const Dcm_IOControlType *IOCtrls;
-  uint8_t numOfIOCtrls;
+  const uint16_t *ids; /* sorted, ids[i] is the id of IOCtrls[i] */
+  uint16_t numOfIOCtrls;
 } Dcm_IOControlConfigType;
 
 /* @SWS_Dcm_00754 */
@@ -416,7 +441,10 @@ typedef struct {
 
 typedef struct {
   const Dcm_ReadDIDType *DIDs;
-  uint8_t numOfDIDs;
+  uint16_t numOfDIDs;
+  /* sorted ids of the first numOfIds static DIDs, the dynamically defined DIDs follow them */
+  const uint16_t *ids;
+  uint16_t numOfIds;
 } Dcm_ReadDIDConfigType;
 
 typedef struct {
@@ -437,7 +465,8 @@ typedef struct {
 
 typedef struct {
   const Dcm_WriteDIDType *DIDs;
-  uint8_t numOfDIDs;
+  const uint16_t *ids; /* sorted, ids[i] is the id of DIDs[i] */
+  uint16_t numOfDIDs;
 } Dcm_WriteDIDConfigType;
 
 typedef struct {
@@ -546,6 +575,9 @@ const Dcm_ConfigType *Dcm_GetConfig(void);
 
 void Dcm_DslProcessingDone(Dcm_ContextType *context, const Dcm_ConfigType *config,
                            Dcm_NegativeResponseCodeType nrc);
+#ifdef DCM_USE_PAGED_BUFFER
+void Dcm_DslStartPagedProcessing(Dcm_MsgLenType resDataLen, Dcm_DspUpdatePageFncType updatePageFnc);
+#endif
 
 Std_ReturnType Dcm_DspSessionControl(Dcm_MsgContextType *msgContext,
                                      Dcm_NegativeResponseCodeType *nrc);
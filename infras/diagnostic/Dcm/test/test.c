@@ -0,0 +1,565 @@
+/**
+ * SSAS - Simple Smart Automotive Software
+ * Copyright (C) 2021 Parai Wang <parai@foxmail.com>
+ *
+ * test of the paged buffer: ReadMemoryByAddress and ReadDTCInformation responses many times
+ * larger than the 64 bytes Tx buffer of test/config/Dcm.json are pulled through Dcm_CopyTxData the
+ * way CanTp and DoIP do. And test of the DID lookup of ReadDataByIdentifier,
+ * WriteDataByIdentifier, IOControlByIdentifier and the dynamically defined DIDs.
+ */
+/* ================================ [ INCLUDES  ] ============================================== */
+#include "Dcm.h"
+#include "Dcm_Cfg.h"
+#include "PduR_Dcm.h"
+#include "Dem.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+/* ================================ [ MACROS    ] ============================================== */
+#define TEST_MEMORY_ADDRESS 0x1234
+#define TEST_MEMORY_SIZE 5000
+#define TEST_RESPONSE_SIZE (TEST_MEMORY_SIZE + 1)
+#define TEST_NUM_OF_DTCS 100
+
+#define TEST_ASSERT(cond)                                                                          \
+  if (!(cond)) {                                                                                   \
+    printf(" FAIL at line %d: %s\n", __LINE__, #cond);                                             \
+    exit(-1);                                                                                      \
+  }
+/* ================================ [ TYPES     ] ============================================== */
+typedef enum {
+  TX_ACCEPT,
+  TX_REJECT,                 /* rejected without touching the response */
+  TX_PULL_AND_REJECT,        /* DoIP: the first chunk is pulled, then the send fails */
+  TX_PULL_CONFIRM_AND_REJECT /* as above, but with a E_NOT_OK TxConfirmation first */
+} TxBehaviorType;
+/* ================================ [ DECLARES  ] ============================================== */
+/* ================================ [ DATAS     ] ============================================== */
+static TxBehaviorType lTxBehavior = TX_ACCEPT;
+static int lTxCalls = 0;
+static PduLengthType lTxLength = 0;
+static int lReadPending = 0;
+static int lReadPendingAt = -1;
+static uint8_t lResponse[TEST_RESPONSE_SIZE];
+static int lDTCIndex = 0;
+static int lDTCFailAt = -1;
+static int lDTCCalls = 0;
+static uint8_t lCounter[4] = {0x11, 0x22, 0x33, 0x44};
+static uint8_t lVoltage[2] = {0x0C, 0x80};
+static uint8_t lIOCtlFC01 = 0;
+static int lIOCtlFC02Calls = 0;
+/* ================================ [ LOCALS    ] ============================================== */
+static uint8_t memoryByte(uint32_t address) {
+  return (uint8_t)((address * 7) ^ (address >> 8));
+}
+
+static void request(const uint8_t *data, PduLengthType length) {
+  PduInfoType info;
+  PduLengthType bufferSize;
+
+  info.SduDataPtr = (uint8_t *)data;
+  info.MetaDataPtr = NULL;
+  info.SduLength = length;
+  TEST_ASSERT(BUFREQ_OK == Dcm_StartOfReception(DCM_P2P_PDU, &info, length, &bufferSize));
+  TEST_ASSERT(BUFREQ_OK == Dcm_CopyRxData(DCM_P2P_PDU, &info, &bufferSize));
+  Dcm_TpRxIndication(DCM_P2P_PDU, E_OK);
+}
+
+static void requestReadMemory(void) {
+  const uint8_t req[] = {0x23,
+                         0x44,
+                         0,
+                         0,
+                         (TEST_MEMORY_ADDRESS >> 8) & 0xFF,
+                         TEST_MEMORY_ADDRESS & 0xFF,
+                         0,
+                         0,
+                         (TEST_MEMORY_SIZE >> 8) & 0xFF,
+                         TEST_MEMORY_SIZE & 0xFF};
+  request(req, sizeof(req));
+}
+
+/* pull the whole response, a BUFREQ_E_BUSY is retried as the TP does on its next cycle */
+static int receive(PduLengthType firstChunk, PduLengthType chunk) {
+  PduInfoType info;
+  PduLengthType index = 0;
+  PduLengthType available = 0;
+  BufReq_ReturnType ret;
+  int busy = 0;
+
+  memset(lResponse, 0, sizeof(lResponse));
+  while (index < lTxLength) {
+    info.SduDataPtr = &lResponse[index];
+    info.MetaDataPtr = NULL;
+    info.SduLength = (0 == index) ? firstChunk : chunk;
+    if (info.SduLength > (lTxLength - index)) {
+      info.SduLength = lTxLength - index;
+    }
+    if ((lReadPendingAt >= 0) && (index >= (PduLengthType)lReadPendingAt)) {
+      lReadPending = 2;
+      lReadPendingAt = -1;
+    }
+    ret = Dcm_CopyTxData(DCM_P2P_PDU, &info, NULL, &available);
+    if (BUFREQ_E_BUSY == ret) {
+      busy++;
+      TEST_ASSERT(busy < 10);
+    } else {
+      TEST_ASSERT(BUFREQ_OK == ret);
+      index += info.SduLength;
+      TEST_ASSERT(available == (lTxLength - index));
+    }
+  }
+  Dcm_TpTxConfirmation(DCM_P2P_PDU, E_OK);
+
+  return busy;
+}
+
+static void checkReadMemoryResponse(void) {
+  int i;
+  TEST_ASSERT(TEST_RESPONSE_SIZE == lTxLength);
+  TEST_ASSERT(0x63 == lResponse[0]);
+  for (i = 0; i < TEST_MEMORY_SIZE; i++) {
+    TEST_ASSERT(memoryByte(TEST_MEMORY_ADDRESS + i) == lResponse[1 + i]);
+  }
+}
+
+static void mainFunctionUntilTx(int expectedTxCalls) {
+  int i;
+  for (i = 0; (i < 10) && (lTxCalls < expectedTxCalls); i++) {
+    Dcm_MainFunction();
+  }
+  TEST_ASSERT(expectedTxCalls == lTxCalls);
+}
+
+/* a request with a short response, pulled the CanTp way */
+static void transact(const uint8_t *req, PduLengthType length) {
+  lTxCalls = 0;
+  request(req, length);
+  mainFunctionUntilTx(1);
+  receive(6, 7);
+}
+
+static void checkResponse(const uint8_t *res, PduLengthType length) {
+  TEST_ASSERT(length == lTxLength);
+  TEST_ASSERT(0 == memcmp(res, lResponse, length));
+}
+
+static void checkNegativeResponse(uint8_t sid, uint8_t nrc) {
+  const uint8_t res[] = {0x7F, sid, nrc};
+  checkResponse(res, sizeof(res));
+}
+
+static uint32_t dtcNumber(int index) {
+  return 0x100000 + (uint32_t)index * 3;
+}
+
+static void requestReadDTC(void) {
+  const uint8_t req[] = {0x19, 0x02, 0xFF};
+  lDTCIndex = 0;
+  lDTCCalls = 0;
+  lTxCalls = 0;
+  request(req, sizeof(req));
+  mainFunctionUntilTx(1);
+}
+
+static void TestPagedRead(PduLengthType firstChunk, PduLengthType chunk, int pendingAt) {
+  int busy;
+  printf("Test paged read with chunks %d/%d, pending at %d:", (int)firstChunk, (int)chunk,
+         pendingAt);
+  lTxCalls = 0;
+  lReadPendingAt = pendingAt;
+  requestReadMemory();
+  mainFunctionUntilTx(1);
+  busy = receive(firstChunk, chunk);
+  checkReadMemoryResponse();
+  TEST_ASSERT((pendingAt >= 0) == (busy > 0));
+  printf(" PASS\n");
+}
+
+static void TestPagedRetry(TxBehaviorType behavior) {
+  int i;
+  printf("Test paged retry with Tx behavior %d:", behavior);
+  lTxCalls = 0;
+  lTxBehavior = behavior;
+  requestReadMemory();
+  mainFunctionUntilTx(1);
+  lTxBehavior = TX_ACCEPT;
+  if (TX_REJECT == behavior) {
+    /* nothing consumed, so the response is sent again as a whole */
+    mainFunctionUntilTx(2);
+    receive(6, 7);
+    checkReadMemoryResponse();
+  } else {
+    /* consumed pages can't be sent again, so the response is dropped */
+    for (i = 0; i < 10; i++) {
+      Dcm_MainFunction();
+    }
+    TEST_ASSERT(1 == lTxCalls);
+    /* and the next request is served normally */
+    requestReadMemory();
+    mainFunctionUntilTx(2);
+    receive(1460, 1460);
+    checkReadMemoryResponse();
+  }
+  printf(" PASS\n");
+}
+
+static void TestShortRead(void) {
+  const uint8_t req[] = {0x23, 0x44, 0, 0, 0x10, 0, 0, 0, 0, 0x20};
+  int i;
+  printf("Test short read:");
+  lTxCalls = 0;
+  request(req, sizeof(req));
+  mainFunctionUntilTx(1);
+  TEST_ASSERT(0x21 == lTxLength);
+  receive(6, 7);
+  for (i = 0; i < 0x20; i++) {
+    TEST_ASSERT(memoryByte(0x1000 + i) == lResponse[1 + i]);
+  }
+  printf(" PASS\n");
+}
+
+static void readDTC(PduLengthType firstChunk, PduLengthType chunk) {
+  int i;
+  uint8_t *dtc;
+  requestReadDTC();
+  TEST_ASSERT((3 + 4 * TEST_NUM_OF_DTCS) == lTxLength);
+  receive(firstChunk, chunk);
+  TEST_ASSERT(0x59 == lResponse[0]);
+  TEST_ASSERT(0x02 == lResponse[1]);
+  TEST_ASSERT(0xFF == lResponse[2]);
+  for (i = 0; i < TEST_NUM_OF_DTCS; i++) {
+    dtc = &lResponse[3 + 4 * i];
+    TEST_ASSERT(dtcNumber(i) == (((uint32_t)dtc[0] << 16) + ((uint32_t)dtc[1] << 8) + dtc[2]));
+    TEST_ASSERT(0x09 == dtc[3]);
+  }
+  TEST_ASSERT(TEST_NUM_OF_DTCS == lDTCCalls);
+}
+
+static void TestPagedReadDTC(PduLengthType firstChunk, PduLengthType chunk) {
+  printf("Test paged read DTC with chunks %d/%d:", (int)firstChunk, (int)chunk);
+  readDTC(firstChunk, chunk);
+  printf(" PASS\n");
+}
+
+static void TestPagedReadDTCFailed(void) {
+  PduInfoType info;
+  PduLengthType available;
+  BufReq_ReturnType ret = BUFREQ_OK;
+  int calls;
+  printf("Test paged read DTC failed:");
+  lDTCFailAt = 40;
+  requestReadDTC();
+  info.MetaDataPtr = NULL;
+  info.SduLength = 7;
+  while (BUFREQ_OK == ret) {
+    info.SduDataPtr = lResponse;
+    ret = Dcm_CopyTxData(DCM_P2P_PDU, &info, NULL, &available);
+  }
+  TEST_ASSERT(BUFREQ_E_NOT_OK == ret);
+  /* the response is gone, the page function is not called again */
+  calls = lDTCCalls;
+  TEST_ASSERT(BUFREQ_E_NOT_OK == Dcm_CopyTxData(DCM_P2P_PDU, &info, NULL, &available));
+  TEST_ASSERT(calls == lDTCCalls);
+  Dcm_TpTxConfirmation(DCM_P2P_PDU, E_NOT_OK);
+  lDTCFailAt = -1;
+  /* and the next request is served normally */
+  readDTC(6, 7);
+  printf(" PASS\n");
+}
+
+static void TestReadDID(void) {
+  const uint8_t req[] = {0x22, 0xF1, 0x90, 0x01, 0x02, 0xAB, 0x01};
+  const uint8_t reqUnknown[] = {0x22, 0x12, 0x34};
+  const uint8_t reqMixed[] = {0x22, 0x01, 0x02, 0x12, 0x34};
+  const uint8_t res[] = {0x62, 0xF1, 0x90, 'S', 'S', 'A', 'S', '0', '1', '2', '3', '4', '5',
+                         '6', '7', '8', '9', 'A', 'B', 'C', 0x01, 0x02, 0x0C, 0x80, 0xAB,
+                         0x01, 0x11, 0x22, 0x33, 0x44};
+  printf("Test read DID:");
+  transact(req, sizeof(req));
+  checkResponse(res, sizeof(res));
+  transact(reqUnknown, sizeof(reqUnknown));
+  checkNegativeResponse(0x22, DCM_E_REQUEST_OUT_OF_RANGE);
+  /* the whole request is rejected by any unknown DID in it */
+  transact(reqMixed, sizeof(reqMixed));
+  checkNegativeResponse(0x22, DCM_E_REQUEST_OUT_OF_RANGE);
+  printf(" PASS\n");
+}
+
+static void TestWriteDID(void) {
+  const uint8_t req[] = {0x2E, 0xAB, 0x01, 0xA1, 0xA2, 0xA3, 0xA4};
+  const uint8_t reqRead[] = {0x22, 0xAB, 0x01};
+  const uint8_t reqUnknown[] = {0x2E, 0xF1, 0x90, 0x00};
+  const uint8_t res[] = {0x6E, 0xAB, 0x01};
+  const uint8_t resRead[] = {0x62, 0xAB, 0x01, 0xA1, 0xA2, 0xA3, 0xA4};
+  printf("Test write DID:");
+  transact(req, sizeof(req));
+  checkResponse(res, sizeof(res));
+  transact(reqRead, sizeof(reqRead));
+  checkResponse(resRead, sizeof(resRead));
+  /* readable only */
+  transact(reqUnknown, sizeof(reqUnknown));
+  checkNegativeResponse(0x2E, DCM_E_REQUEST_OUT_OF_RANGE);
+  printf(" PASS\n");
+}
+
+static void TestIOControl(void) {
+  const uint8_t reqFC01[] = {0x2F, 0xFC, 0x01, 0x03, 0x55};
+  const uint8_t reqFC01Return[] = {0x2F, 0xFC, 0x01, 0x00};
+  const uint8_t reqFC02[] = {0x2F, 0xFC, 0x02, 0x03, 0x66};
+  const uint8_t reqFC02Return[] = {0x2F, 0xFC, 0x02, 0x00};
+  const uint8_t reqUnknown[] = {0x2F, 0xFC, 0x03, 0x03, 0x77};
+  const uint8_t resFC01[] = {0x6F, 0xFC, 0x01, 0x03, 0x55};
+  const uint8_t resFC01Return[] = {0x6F, 0xFC, 0x01, 0x00};
+  const uint8_t resFC02[] = {0x6F, 0xFC, 0x02, 0x03};
+  printf("Test IO control:");
+  transact(reqFC01, sizeof(reqFC01));
+  checkResponse(resFC01, sizeof(resFC01));
+  TEST_ASSERT(0x55 == lIOCtlFC01);
+  transact(reqFC01Return, sizeof(reqFC01Return));
+  checkResponse(resFC01Return, sizeof(resFC01Return));
+  TEST_ASSERT(0 == lIOCtlFC01);
+  transact(reqFC02, sizeof(reqFC02));
+  checkResponse(resFC02, sizeof(resFC02));
+  TEST_ASSERT(1 == lIOCtlFC02Calls);
+  transact(reqFC02Return, sizeof(reqFC02Return));
+  checkNegativeResponse(0x2F, DCM_E_REQUEST_OUT_OF_RANGE);
+  transact(reqUnknown, sizeof(reqUnknown));
+  checkNegativeResponse(0x2F, DCM_E_REQUEST_OUT_OF_RANGE);
+  TEST_ASSERT(1 == lIOCtlFC02Calls);
+  printf(" PASS\n");
+}
+
+static void TestDynamicDID(void) {
+  /* F300 is the 2nd and 3rd bytes of AB01 followed by the 1st byte of 0102 */
+  const uint8_t reqDefine[] = {0x2C, 0x01, 0xF3, 0x00, 0xAB, 0x01, 0x02,
+                               0x02, 0x01, 0x02, 0x01, 0x01};
+  const uint8_t reqDefine2[] = {0x2C, 0x01, 0xF3, 0x01, 0xF1, 0x90, 0x01, 0x04};
+  const uint8_t reqRead[] = {0x22, 0xF3, 0x00};
+  const uint8_t reqReadBoth[] = {0x22, 0xF3, 0x01, 0xAB, 0x01, 0xF3, 0x00};
+  const uint8_t reqClear[] = {0x2C, 0x03, 0xF3, 0x00};
+  const uint8_t resDefine[] = {0x6C, 0x01, 0xF3, 0x00};
+  const uint8_t resDefine2[] = {0x6C, 0x01, 0xF3, 0x01};
+  const uint8_t resRead[] = {0x62, 0xF3, 0x00, 0xA2, 0xA3, 0x0C};
+  const uint8_t resReadBoth[] = {0x62, 0xF3, 0x01, 'S',  'S',  'A',  'S',  0xAB, 0x01,
+                                 0xA1, 0xA2, 0xA3, 0xA4, 0xF3, 0x00, 0xA2, 0xA3, 0x0C};
+  const uint8_t resClear[] = {0x6C, 0x03, 0xF3, 0x00};
+  printf("Test dynamic DID:");
+  transact(reqRead, sizeof(reqRead));
+  checkNegativeResponse(0x22, DCM_E_REQUEST_OUT_OF_RANGE);
+  transact(reqDefine, sizeof(reqDefine));
+  checkResponse(resDefine, sizeof(resDefine));
+  transact(reqDefine2, sizeof(reqDefine2));
+  checkResponse(resDefine2, sizeof(resDefine2));
+  transact(reqRead, sizeof(reqRead));
+  checkResponse(resRead, sizeof(resRead));
+  /* the dynamic ones are not sorted, mixed with a static one */
+  transact(reqReadBoth, sizeof(reqReadBoth));
+  checkResponse(resReadBoth, sizeof(resReadBoth));
+  /* a defined id can't be defined again */
+  transact(reqDefine, sizeof(reqDefine));
+  checkNegativeResponse(0x2C, DCM_E_REQUEST_OUT_OF_RANGE);
+  transact(reqClear, sizeof(reqClear));
+  checkResponse(resClear, sizeof(resClear));
+  transact(reqRead, sizeof(reqRead));
+  checkNegativeResponse(0x22, DCM_E_REQUEST_OUT_OF_RANGE);
+  printf(" PASS\n");
+}
+/* ================================ [ FUNCTIONS ] ============================================== */
+Std_ReturnType PduR_DcmTransmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr) {
+  Std_ReturnType r = E_OK;
+  PduInfoType info;
+  PduLengthType available;
+  uint8_t chunk[1460];
+
+  lTxCalls++;
+  lTxLength = PduInfoPtr->SduLength;
+  if (TX_ACCEPT != lTxBehavior) {
+    if (TX_REJECT != lTxBehavior) {
+      info.SduDataPtr = chunk;
+      info.MetaDataPtr = NULL;
+      info.SduLength = sizeof(chunk);
+      TEST_ASSERT(BUFREQ_OK == Dcm_CopyTxData(TxPduId, &info, NULL, &available));
+    }
+    if (TX_PULL_CONFIRM_AND_REJECT == lTxBehavior) {
+      Dcm_TpTxConfirmation(TxPduId, E_NOT_OK);
+    }
+    r = E_NOT_OK;
+  }
+
+  return r;
+}
+
+Dcm_ReturnReadMemoryType Dcm_ReadMemory(Dcm_OpStatusType OpStatus, uint8_t MemoryIdentifier,
+                                        uint32_t MemoryAddress, uint32_t MemorySize,
+                                        uint8_t *MemoryData,
+                                        Dcm_NegativeResponseCodeType *ErrorCode) {
+  Dcm_ReturnReadMemoryType ret = DCM_READ_OK;
+  uint32_t i;
+
+  if (lReadPending > 0) {
+    lReadPending--;
+    ret = DCM_READ_PENDING;
+  } else {
+    for (i = 0; i < MemorySize; i++) {
+      MemoryData[i] = memoryByte(MemoryAddress + i);
+    }
+  }
+
+  return ret;
+}
+
+Std_ReturnType Dem_SetDTCFilter(uint8_t ClientId, uint8_t DTCStatusMask,
+                                Dem_DTCFormatType DTCFormat, Dem_DTCOriginType DTCOrigin,
+                                boolean FilterWithSeverity, Dem_DTCSeverityType DTCSeverityMask,
+                                boolean FilterForFaultDetectionCounter) {
+  lDTCIndex = 0;
+  return E_OK;
+}
+
+Std_ReturnType Dem_GetNumberOfFilteredDTC(uint8_t ClientId, uint16_t *NumberOfFilteredDTC) {
+  *NumberOfFilteredDTC = TEST_NUM_OF_DTCS;
+  return E_OK;
+}
+
+Std_ReturnType Dem_GetNextFilteredDTC(uint8_t ClientId, uint32_t *DTC, uint8_t *DTCStatus) {
+  Std_ReturnType r = E_NOT_OK;
+
+  lDTCCalls++;
+  if ((lDTCIndex < TEST_NUM_OF_DTCS) && (lDTCIndex != lDTCFailAt)) {
+    *DTC = dtcNumber(lDTCIndex);
+    *DTCStatus = 0x09;
+    lDTCIndex++;
+    r = E_OK;
+  }
+
+  return r;
+}
+
+/* the snapshot and extended data records are not tested */
+Std_ReturnType Dem_SelectDTC(uint8_t ClientId, uint32_t DTC, Dem_DTCFormatType DTCFormat,
+                             Dem_DTCOriginType DTCOrigin) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_SetFreezeFrameRecordFilter(uint8_t ClientId, Dem_DTCFormatType DTCFormat) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_GetNumberOfFreezeFrameRecords(uint8_t ClientId,
+                                                 uint16_t *NumberOfFilteredRecords) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_GetNextFilteredRecord(uint8_t ClientId, uint32_t *DTC, uint8_t *RecordNumber) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_SelectFreezeFrameData(uint8_t ClientId, uint8_t RecordNumber) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_GetNextFreezeFrameData(uint8_t ClientId, uint8_t *DestBuffer,
+                                          uint16_t *BufSize) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Dem_GetNextExtendedDataRecord(uint8_t ClientId, uint8_t *DestBuffer,
+                                             uint16_t *BufSize) {
+  return E_NOT_OK;
+}
+
+Std_ReturnType Test_ReadF190(Dcm_OpStatusType opStatus, uint8_t *data, uint16_t length,
+                             Dcm_NegativeResponseCodeType *errorCode) {
+  TEST_ASSERT(17 == length);
+  memcpy(data, "SSAS0123456789ABC", length);
+  return E_OK;
+}
+
+Std_ReturnType Test_ReadAB01(Dcm_OpStatusType opStatus, uint8_t *data, uint16_t length,
+                             Dcm_NegativeResponseCodeType *errorCode) {
+  TEST_ASSERT(sizeof(lCounter) == length);
+  memcpy(data, lCounter, length);
+  return E_OK;
+}
+
+Std_ReturnType Test_Read0102(Dcm_OpStatusType opStatus, uint8_t *data, uint16_t length,
+                             Dcm_NegativeResponseCodeType *errorCode) {
+  TEST_ASSERT(sizeof(lVoltage) == length);
+  memcpy(data, lVoltage, length);
+  return E_OK;
+}
+
+Std_ReturnType Test_WriteAB01(Dcm_OpStatusType opStatus, uint8_t *data, uint16_t length,
+                              Dcm_NegativeResponseCodeType *errorCode) {
+  TEST_ASSERT(sizeof(lCounter) == length);
+  memcpy(lCounter, data, length);
+  return E_OK;
+}
+
+Std_ReturnType Test_Write0102(Dcm_OpStatusType opStatus, uint8_t *data, uint16_t length,
+                              Dcm_NegativeResponseCodeType *errorCode) {
+  TEST_ASSERT(sizeof(lVoltage) == length);
+  memcpy(lVoltage, data, length);
+  return E_OK;
+}
+
+Std_ReturnType Test_IOCtl_FC01_ShortTermAdjustment(uint8_t *ControlRecord, uint16_t length,
+                                                   uint8_t *resData, uint16_t *resDataLen,
+                                                   uint8_t *nrc) {
+  TEST_ASSERT(1 == length);
+  lIOCtlFC01 = ControlRecord[0];
+  resData[0] = lIOCtlFC01;
+  *resDataLen = 1;
+  return E_OK;
+}
+
+Std_ReturnType Test_IOCtl_FC01_ReturnControlToEcu(uint8_t *ControlRecord, uint16_t length,
+                                                  uint8_t *resData, uint16_t *resDataLen,
+                                                  uint8_t *nrc) {
+  lIOCtlFC01 = 0;
+  *resDataLen = 0;
+  return E_OK;
+}
+
+Std_ReturnType Test_IOCtl_FC02_ShortTermAdjustment(uint8_t *ControlRecord, uint16_t length,
+                                                   uint8_t *resData, uint16_t *resDataLen,
+                                                   uint8_t *nrc) {
+  lIOCtlFC02Calls++;
+  *resDataLen = 0;
+  return E_OK;
+}
+
+Std_ReturnType Test_GetSessionChangePermission(Dcm_SesCtrlType sesCtrlTypeActive,
+                                               Dcm_SesCtrlType sesCtrlTypeNew,
+                                               Dcm_NegativeResponseCodeType *ErrorCode) {
+  return E_OK;
+}
+
+void Dcm_SessionChangeIndication(Dcm_SesCtrlType sesCtrlTypeActive, Dcm_SesCtrlType sesCtrlTypeNew,
+                                 boolean timeout) {
+}
+
+void Dcm_PerformReset(uint8_t resetType) {
+}
+
+int main(int argc, char *argv[]) {
+  Dcm_Init(NULL);
+  TestShortRead();
+  TestPagedRead(6, 7, -1);       /* CanTp */
+  TestPagedRead(1460, 1460, -1); /* DoIP, chunks larger than the Tx buffer */
+  TestPagedRead(3, 100, -1);
+  TestPagedRead(6, 7, 1000); /* pending ReadMemory page */
+  TestPagedRetry(TX_REJECT);
+  TestPagedRetry(TX_PULL_AND_REJECT);
+  TestPagedRetry(TX_PULL_CONFIRM_AND_REJECT);
+  TestPagedReadDTC(6, 7);
+  TestPagedReadDTC(1460, 1460);
+  TestPagedReadDTCFailed();
+  TestReadDID();
+  TestWriteDID();
+  TestIOControl();
+  TestDynamicDID();
+  return 0;
+}
@@ -32,6 +32,9 @@ void CanIf_TxConfirmation(PduIdType CanTxPduId);
 
 /* @SWS_CANIF_00189 */
 void CanIf_SetDynamicTxId(PduIdType CanIfTxSduId, Can_IdType CanId);
+
+/* retry the buffered Tx PDUs which Can_Write refused */
+void CanIf_MainFunction(void);
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,10 @@ extern "C" {
 void CanIf_RxIndication(const Can_HwType *Mailbox, const PduInfoType *PduInfoPtr);
 /* @SWS_CANIF_00007 */
 void CanIf_TxConfirmation(PduIdType CanTxPduId);
+/* @SWS_CANIF_00218 */
+void CanIf_ControllerBusOff(uint8_t ControllerId);
+/* @SWS_CANIF_00699 */
+void CanIf_ControllerModeIndication(uint8_t ControllerId, Can_ControllerStateType ControllerMode);
 #ifdef __cplusplus
 }
 #endif
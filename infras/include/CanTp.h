@@ -8,6 +8,7 @@
 #define CANTP_H
 /* ================================ [ INCLUDES  ] ============================================== */
 #include "ComStack_Types.h"
+#include "Std_Timer.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +36,12 @@ Std_ReturnType CanTp_Transmit(PduIdType TxPduId, const PduInfoType *PduInfoPtr);
 void CanTp_MainFunction(void);
 
 void CanTp_MainFunction_Channel(uint8_t Channel);
+
+/* Send the pending CF once its STmin elapsed, to be called by the platform as often as the
+ * required STmin precision, e.g. from a timer programmed with the returned time, only
+ * available with CANTP_USE_STD_TIMER.
+ * return the time in us until the pending CF is due, 0 if there is no pending CF */
+std_time_t CanTp_MainFunction_SeparationTime(uint8_t Channel);
 #ifdef __cplusplus
 }
 #endif
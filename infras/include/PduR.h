@@ -26,4 +26,6 @@ void PduR_EnableRouting(PduR_RoutingPathGroupIdType id);
 
 /* @SWS_PduR_00617 */
 void PduR_DisableRouting(PduR_RoutingPathGroupIdType id, boolean initialize);
+
+void PduR_MainFunction(void);
 #endif /* _PDUR_H */
@@ -59,6 +59,10 @@ typedef enum
 
 typedef struct Sd_EventHandlerSubscriber_s {
   STAILQ_ENTRY(Sd_EventHandlerSubscriber_s) entry;
+  /* next one in the same bucket of the subscriber hash of Sd */
+  struct Sd_EventHandlerSubscriber_s *hnext;
+  /* the event handler this one subscribes to */
+  uint16_t HandleId;
   /* remote subscriber address */
   TcpIp_SockAddrType RemoteAddr;
   uint32_t TTL;
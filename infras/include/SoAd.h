@@ -104,6 +104,8 @@ Std_ReturnType SoAd_TakeControl(SoAd_SoConIdType SoConId);
 Std_ReturnType SoAd_SetNonBlock(SoAd_SoConIdType SoConId, boolean nonBlocked);
 Std_ReturnType SoAd_SetTimeout(SoAd_SoConIdType SoConId, uint32_t timeoutMs);
 Std_ReturnType SoAd_ControlRx(SoAd_SoConIdType SoConId, uint8_t* data, uint32_t length);
+/* get the socket of the connection taken control, so the owner is able to poll it */
+Std_ReturnType SoAd_GetSocket(SoAd_SoConIdType SoConId, TcpIp_SocketIdType *SocketIdPtr);
 #ifdef __cplusplus
 }
 #endif
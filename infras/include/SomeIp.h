@@ -60,6 +60,11 @@ BufReq_ReturnType SomeIp_SoAdTpCopyRxData(PduIdType RxPduId, const PduInfoType *
                                           PduLengthType *bufferSizePtr);
 
 Std_ReturnType SomeIp_Request(uint32_t requestId, uint8_t *data, uint32_t length);
+/* as SomeIp_Request, but the response is waited for timeoutMs instead of the ResponseTimeout */
+Std_ReturnType SomeIp_RequestWithTimeout(uint32_t requestId, uint8_t *data, uint32_t length,
+                                         uint32_t timeoutMs);
+/* stop waiting the response of the request, a late response is dropped without onError */
+Std_ReturnType SomeIp_CancelRequest(uint32_t requestId);
 Std_ReturnType SomeIp_FireForgot(uint32_t requestId, uint8_t *data, uint32_t length);
 Std_ReturnType SomeIp_Notification(uint32_t requestId, uint8_t *data, uint32_t length);
 
@@ -68,6 +73,13 @@ void SomeIp_MainFunction(void);
 
 Std_ReturnType SomeIp_ConnectionTakeControl(uint16_t serviceId, uint16_t conId);
 Std_ReturnType SomeIp_ConnectionRxControl(uint16_t serviceId, uint16_t conId, uint8_t *data, uint32_t length);
+/* send the responses of the async requests of the connection taken control which are ready now,
+ * instead of waiting for the next SomeIp_MainFunction */
+Std_ReturnType SomeIp_ConnectionAsyncControl(uint16_t serviceId, uint16_t conId);
+Std_ReturnType SomeIp_ConnectionGetSocket(uint16_t serviceId, uint16_t conId,
+                                          TcpIp_SocketIdType *SocketIdPtr);
+/* close the connection taken control, e.g. the peer is gone */
+Std_ReturnType SomeIp_ConnectionClose(uint16_t serviceId, uint16_t conId);
 #ifdef __cplusplus
 }
 #endif
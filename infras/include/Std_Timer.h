@@ -28,6 +28,10 @@ extern "C" {
   }                                                                                                \
   while (0)
 
+/* wrap safe "now >= deadline", given the two are less than half the range apart */
+#define STD_TIME_IS_REACHED(now, deadline)                                                         \
+  ((std_time_t)((now) - (deadline)) <= (STD_TIME_MAX >> 1))
+
 #define STD_TIMER_ONE_SECOND ((std_time_t)1000000000)
 #define STD_TIMER_ONE_MILISECOND ((std_time_t)1000000)
 /* ================================ [ TYPES     ] ============================================== */
@@ -53,6 +57,9 @@ std_time_t Std_GetTimerElapsedTime(Std_TimerType *timer);
 
 void Std_TimerSet(Std_TimerType *timer, std_time_t timeout);
 bool Std_IsTimerTimeout(Std_TimerType *timer);
+/* the wall clock time in us, which differs on each boot unlike Std_GetTime but may jump, so it
+ * is for seeds and not for timers, only on linux and windows */
+std_time_t Std_GetRealTime(void);
 /* for log purpose, return a time in string format: Year-Month-Day-Hour-Minute-Second-Milisecond */
 void Std_GetDateTime(char *ts, size_t sz);
 #ifdef __cplusplus
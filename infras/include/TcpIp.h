@@ -27,6 +27,11 @@ extern "C" {
 
 #define TCPIP_IPV4_ADDR(b0, b1, b2, b3)                                                            \
   ((((uint32_t)b0) << 24) + (((uint32_t)b1) << 16) + (((uint32_t)b2) << 8) + b3)
+
+#ifdef USE_TCPIP_EPOLL
+#define TCPIP_EVENT_READ ((uint8_t)0x01)
+#define TCPIP_EVENT_HANGUP ((uint8_t)0x02)
+#endif
 /* ================================ [ TYPES     ] ============================================== */
 typedef int TcpIp_SocketIdType;
 
@@ -77,6 +82,30 @@ typedef enum
 
 typedef struct TcpIp_Config_s TcpIp_ConfigType;
 
+typedef struct {
+  TcpIp_SockAddrType RemoteAddr;
+  uint8_t *BufPtr;
+  uint32_t Length; /* InOut */
+} TcpIp_RecvMsgType;
+
+#ifdef USE_LWIP
+typedef struct {
+  TcpIp_SockAddrType RemoteAddr; /* only for UDP */
+  uint8_t *BufPtr;
+  uint32_t Length;
+  void *pbuf; /* private: the lent pbuf */
+  void *conn; /* private: the TCP netconn to be acknowledged on release */
+} TcpIp_RecvBufferType;
+#endif
+
+#ifdef USE_TCPIP_EPOLL
+typedef struct {
+  uint32_t cookie; /* the one given by TcpIp_Watch */
+  TcpIp_SocketIdType SocketId;
+  uint8_t events; /* TCPIP_EVENT_READ or TCPIP_EVENT_HANGUP */
+} TcpIp_SocketEventType;
+#endif
+
 /* ================================ [ DECLARES  ] ============================================== */
 /* ================================ [ DATAS     ] ============================================== */
 /* ================================ [ LOCALS    ] ============================================== */
@@ -129,10 +158,33 @@ Std_ReturnType TcpIp_Recv(TcpIp_SocketIdType SocketId, uint8_t *BufPtr,
 
 Std_ReturnType TcpIp_RecvFrom(TcpIp_SocketIdType SocketId, TcpIp_SockAddrType *RemoteAddrPtr,
                               uint8_t *BufPtr, uint32_t *Length /* InOut */);
+/* receive at most *Num datagrams at once, a truncated datagram is reported with Length 0 */
+Std_ReturnType TcpIp_RecvFromMulti(TcpIp_SocketIdType SocketId, TcpIp_RecvMsgType *Msgs,
+                                   uint16_t *Num /* InOut */);
+
+#ifdef USE_LWIP
+/* lend the next received pbuf of the socket without copy, a chained pbuf is linearized. Length 0
+ * means nothing pending. The buffer must be given back by TcpIp_ReleaseBuffer, and the socket
+ * shall not be read by TcpIp_Recv/TcpIp_RecvFrom at the same time. */
+Std_ReturnType TcpIp_RecvBuffer(TcpIp_SocketIdType SocketId, TcpIp_RecvBufferType *Buffer);
+
+void TcpIp_ReleaseBuffer(TcpIp_RecvBufferType *Buffer);
+#endif
 
 Std_ReturnType TcpIp_SendTo(TcpIp_SocketIdType SocketId, const TcpIp_SockAddrType *RemoteAddrPtr,
                             const uint8_t *BufPtr, uint32_t Length);
 
+/* same as TcpIp_SendTo, but if built with TCPIP_TX_BATCH_SIZE, the datagram is copied and queued
+ * until TcpIp_FlushTx sends all the queued datagrams with one sendmmsg per socket in the queued
+ * order. TcpIp_FlushTx is called by TcpIp_MainFunction, and should also be called after the last
+ * main function which may queue datagrams. A datagram is kept queued while its socket is full, and
+ * if it is dropped by an error, the next TcpIp_SendToQueued of the socket returns E_NOT_OK */
+Std_ReturnType TcpIp_SendToQueued(TcpIp_SocketIdType SocketId,
+                                  const TcpIp_SockAddrType *RemoteAddrPtr, const uint8_t *BufPtr,
+                                  uint32_t Length);
+
+void TcpIp_FlushTx(void);
+
 Std_ReturnType TcpIp_Send(TcpIp_SocketIdType SocketId, const uint8_t *BufPtr, uint32_t Length);
 
 /*
@@ -145,6 +197,15 @@ Std_ReturnType TcpIp_TcpKeepAlive(TcpIp_SocketIdType SocketId, uint32_t Idel, ui
                                   uint32_t Count);
 
 uint16_t TcpIp_Tell(TcpIp_SocketIdType SocketId);
+#ifdef USE_TCPIP_EPOLL
+/* register the socket to the event set, the cookie is reported back by TcpIp_WaitEvents */
+Std_ReturnType TcpIp_Watch(TcpIp_SocketIdType SocketId, uint32_t cookie);
+Std_ReturnType TcpIp_Unwatch(TcpIp_SocketIdType SocketId);
+/* return the number of ready sockets, wait at most timeoutMs if none is ready */
+int TcpIp_WaitEvents(TcpIp_SocketEventType *events, int maxEvents, uint32_t timeoutMs);
+/* block at most timeoutMs until any watched socket is ready, the events are not consumed */
+boolean TcpIp_Wait(uint32_t timeoutMs);
+#endif
 #ifdef __cplusplus
 }
 #endif
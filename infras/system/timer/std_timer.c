@@ -66,8 +66,31 @@ static void __attribute__((constructor)) __std_timer_init(void) {
 }
 #endif
 /* ================================ [ FUNCTIONS ] ============================================== */
-#if defined(linux) || defined(_WIN32)
+#if defined(linux)
+/* monotonic, so the timers are not moved by a change of the wall clock */
 std_time_t Std_GetTime(void) {
+  struct timespec now;
+  std_time_t tm;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &now);
+  tm = (std_time_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+
+  return tm;
+}
+#elif defined(_WIN32)
+std_time_t Std_GetTime(void) {
+  struct timeval now;
+  std_time_t tm;
+
+  (void)gettimeofday(&now, NULL);
+  tm = (std_time_t)now.tv_sec * 1000000 + now.tv_usec;
+
+  return tm;
+}
+#endif
+
+#if defined(linux) || defined(_WIN32)
+std_time_t Std_GetRealTime(void) {
   struct timeval now;
   std_time_t tm;
 
@@ -44,7 +44,7 @@ AddOption('--net',
           dest='net',
           type=str,
           default='none',
-          help='to choose which net(lwip or none) to be used')
+          help='to choose which net(lwip, epoll or none) to be used')
 
 AddOption('--cpl',
           dest='compiler',
@@ -10,8 +10,90 @@ from .Com import get_messages
 
 __all__ = ['Gen']
 
+CANIF_RX_HASH_EMPTY = 0xFFFF
+CANIF_RX_HASH_M1 = 0x9E3779B97F4A7C15
+CANIF_RX_HASH_M2 = 0xC2B2AE3D27D4EB4F
+
+
+def rx_hash_key(canid, hoh):
+    # the 32 bits CAN ID keeps its IDE/FD flag bits, so the hoh goes above it
+    return (hoh << 32) | (canid & 0xFFFFFFFF)
+
+
+def rx_hash(key, multiplier, bits):
+    return ((key * multiplier) & 0xFFFFFFFFFFFFFFFF) >> (64 - bits)
+
+
+def gen_rx_hash(cfg):
+    # hash and displace: the keys are spread over buckets by M1, each bucket gets a seed which
+    # moves all its keys by M2 to free slots, thus CanIf_RxIndication needs only 1 probe.
+    # The masked PDUs can't be hashed, they are grouped by mask and each group is sorted by key,
+    # so CanIf_RxIndication does a binary search of the masked CAN ID per mask.
+    exact = {}
+    masked = {}
+    keys = {}
+    index = 0
+    for network in cfg['networks']:
+        for pdu in network['RxPdus']:
+            mask = toNum(pdu.get('mask', '0xFFFFFFFF'))
+            key = rx_hash_key(toNum(pdu['id']), pdu.get('hoh', 0))
+            if (key, mask) in keys:
+                raise Exception('CanIf: Rx PDU %s has the same CAN ID 0x%x and hoh %s as %s' %
+                                (pdu['name'], toNum(pdu['id']), pdu.get('hoh', 0),
+                                 keys[(key, mask)]))
+            keys[(key, mask)] = pdu['name']
+            if mask != 0xFFFFFFFF:
+                masked.setdefault(mask, []).append((key, index))
+            else:
+                exact[key] = index
+            index += 1
+    if index >= CANIF_RX_HASH_EMPTY:
+        raise Exception('CanIf: too much Rx PDUs %d' % (index))
+    seedBits = 1
+    while (1 << seedBits) < (len(exact) / 4):
+        seedBits += 1
+    bits = 1
+    while (1 << bits) < (len(exact) * 5 / 4):
+        bits += 1
+    buckets = [[] for i in range(1 << seedBits)]
+    for key in exact.keys():
+        buckets[rx_hash(key, CANIF_RX_HASH_M1, seedBits)].append(key)
+    seeds = [0] * (1 << seedBits)
+    table = [CANIF_RX_HASH_EMPTY] * (1 << bits)
+    for b in sorted(range(len(buckets)), key=lambda b: -len(buckets[b])):
+        for seed in range(0x10000):
+            slots = set([rx_hash(key ^ seed, CANIF_RX_HASH_M2, bits) for key in buckets[b]])
+            if (len(slots) == len(buckets[b])) and all(table[x] == CANIF_RX_HASH_EMPTY for x in slots):
+                break
+        else:
+            raise Exception('CanIf: no perfect hash found for %d Rx PDUs' % (len(exact)))
+        seeds[b] = seed
+        for key in buckets[b]:
+            table[rx_hash(key ^ seed, CANIF_RX_HASH_M2, bits)] = exact[key]
+    masks = [(mask, [index for _, index in sorted(masked[mask])]) for mask in sorted(masked.keys())]
+    return table, bits, seeds, seedBits, masks
+
+
+def get_tx_hths(cfg):
+    # the buffered Tx PDUs of each HTH, ordered by CAN ID priority, the lowest ID first
+    hths = {}
+    ID = 0
+    for network in cfg['networks']:
+        for pdu in network['TxPdus']:
+            if 'TxBufferSize' in network:
+                hoh = pdu.get('hoh', 0)
+                if hoh not in hths:
+                    hths[hoh] = []
+                hths[hoh].append((toNum(pdu['id']), ID, pdu))
+            ID += 1
+    for hoh, pdus in hths.items():
+        pdus.sort(key=lambda x: (x[0] & 0x7FFFFFFF, x[1]))
+    return hths
+
 
 def Gen_CanIf(cfg, dir):
+    hths = get_tx_hths(cfg)
+    hasTxBuffer = len(hths) > 0
     modules = []
     for network in cfg['networks']:
         for pdu in network['RxPdus'] + network['TxPdus']:
@@ -25,6 +107,15 @@ def Gen_CanIf(cfg, dir):
         '/* ================================ [ INCLUDES  ] ============================================== */\n')
     H.write(
         '/* ================================ [ MACROS    ] ============================================== */\n')
+    H.write('#define CANIF_USE_RX_HASH\n')
+    if hasTxBuffer:
+        H.write('#define CANIF_USE_TX_BUFFER\n')
+        H.write('#ifndef CANIF_MAIN_FUNCTION_PERIOD\n')
+        H.write('#define CANIF_MAIN_FUNCTION_PERIOD 10\n')
+        H.write('#endif\n')
+        H.write('#define CANIF_CONVERT_MS_TO_MAIN_CYCLES(x) \\\n')
+        H.write('  ((x + CANIF_MAIN_FUNCTION_PERIOD - 1) / CANIF_MAIN_FUNCTION_PERIOD)\n')
+    H.write('\n')
     ID = 0
     for network in cfg['networks']:
         for pdu in network['RxPdus']:
@@ -94,6 +185,32 @@ def Gen_CanIf(cfg, dir):
             if pdu.get('dynamic', False):
                 C.write('static Can_IdType canidOf%s = %s;\n' %
                         (pdu['name'], pdu['id']))
+    if hasTxBuffer:
+        for netId, network in enumerate(cfg['networks']):
+            if 'TxBufferSize' not in network:
+                continue
+            for pdu in network['TxPdus']:
+                size = pdu.get('size', network['TxBufferSize'])
+                C.write('static uint8_t CanIf_TxBufferData_%s[%s];\n' % (pdu['name'], size))
+                C.write('static CanIf_TxBufferType CanIf_TxBuffer_%s = {\n' % (pdu['name']))
+                C.write('  CanIf_TxBufferData_%s, %s, 0, FALSE,\n' % (pdu['name'], size))
+                C.write('};\n\n')
+        maxHoh = max(hths.keys())
+        for hoh in range(maxHoh + 1):
+            if hoh in hths:
+                C.write('static uint16_t CanIf_TxHthBusy_%s;\n' % (hoh))
+                C.write('static const PduIdType CanIf_TxHthPdus_%s[] = {\n' % (hoh))
+                for canid, ID, pdu in hths[hoh]:
+                    C.write('  CANIF_%s, /* 0x%x */\n' % (pdu['name'], canid))
+                C.write('};\n\n')
+        C.write('static const CanIf_TxHthType CanIf_TxHths[] = {\n')
+        for hoh in range(maxHoh + 1):
+            if hoh in hths:
+                C.write('  { CanIf_TxHthPdus_%s, &CanIf_TxHthBusy_%s, ARRAY_SIZE(CanIf_TxHthPdus_%s) },\n' % (
+                    hoh, hoh, hoh))
+            else:
+                C.write('  { NULL, NULL, 0 },\n')
+        C.write('};\n\n')
     C.write('static const CanIf_TxPduType CanIf_TxPdus[] = {\n')
     for netId, network in enumerate(cfg['networks']):
         for pdu in network['TxPdus']:
@@ -112,13 +229,47 @@ def Gen_CanIf(cfg, dir):
             else:
                 C.write('    NULL, /* p_canid */\n')
             C.write('    %s, /* hoh */\n' % (pdu.get('hoh', 0)))
+            if 'TxBufferSize' in network:
+                C.write('    &CanIf_TxBuffer_%s,\n' % (pdu['name']))
+            elif hasTxBuffer:
+                C.write('    NULL, /* buffer */\n')
             C.write('  },\n')
     C.write('};\n\n')
+    table, bits, seeds, seedBits, masks = gen_rx_hash(cfg)
+    C.write('static const uint16_t CanIf_RxHashSeeds[] = {\n')
+    for i in range(0, len(seeds), 8):
+        C.write('  %s,\n' % (', '.join(['0x%x' % (v) for v in seeds[i:i + 8]])))
+    C.write('};\n\n')
+    C.write('static const uint16_t CanIf_RxHash[] = {\n')
+    for i in range(0, len(table), 8):
+        C.write('  %s,\n' % (', '.join(['0x%x' % (v) for v in table[i:i + 8]])))
+    C.write('};\n\n')
+    for i, (mask, masked) in enumerate(masks):
+        C.write('static const uint16_t CanIf_RxMasked%s[] = {\n' % (i))
+        C.write('  %s,\n' % (', '.join(['%s' % (v) for v in masked])))
+        C.write('};\n\n')
+    if len(masks) > 0:
+        C.write('static const CanIf_RxMaskType CanIf_RxMasks[] = {\n')
+        for i, (mask, masked) in enumerate(masks):
+            C.write('  {CanIf_RxMasked%s, 0x%x, ARRAY_SIZE(CanIf_RxMasked%s)},\n' % (i, mask, i))
+        C.write('};\n\n')
     C.write('const CanIf_ConfigType CanIf_Config = {\n')
     C.write('  CanIf_RxPdus,\n')
     C.write('  CanIf_TxPdus,\n')
     C.write('  ARRAY_SIZE(CanIf_RxPdus),\n')
     C.write('  ARRAY_SIZE(CanIf_TxPdus),\n')
+    C.write('  CanIf_RxHashSeeds,\n')
+    C.write('  CanIf_RxHash,\n')
+    if len(masks) > 0:
+        C.write('  CanIf_RxMasks,\n')
+    else:
+        C.write('  NULL,\n')
+    C.write('  %s, /* numOfRxMasks */\n' % (len(masks)))
+    C.write('  %s, /* rxHashSeedBits */\n' % (seedBits))
+    C.write('  %s, /* rxHashBits */\n' % (bits))
+    if hasTxBuffer:
+        C.write('  CanIf_TxHths,\n')
+        C.write('  ARRAY_SIZE(CanIf_TxHths),\n')
     C.write('};\n\n')
     C.write(
         '/* ================================ [ LOCALS    ] ============================================== */\n')
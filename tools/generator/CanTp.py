@@ -8,6 +8,22 @@ from .helper import *
 __all__ = ['Gen']
 
 
+def CheckCfBurst(cfg, canif):
+    # the CanIf Tx buffer keeps only the last frame of a PDU, so the burst CFs, which all are
+    # transmitted through the channel's single Tx PDU, would overwrite each other there
+    if cfg.get('cf_burst', 1) <= 1:
+        return
+    names = ['%s_TX' % (chl['name']) for chl in cfg['channels']]
+    for network in canif.get('networks', []):
+        if 'TxBufferSize' not in network:
+            continue
+        for pdu in network.get('TxPdus', []):
+            if (pdu.get('up', None) == 'CanTp') and (pdu['name'] in names):
+                raise Exception('CanTp cf_burst %s is not supported with the CanIf Tx buffer of '
+                                'network %s, Tx PDU %s' % (cfg['cf_burst'], network['name'],
+                                                          pdu['name']))
+
+
 def Gen_CanTp(cfg, dir):
     H = open('%s/CanTp_Cfg.h' % (dir), 'w')
     GenHeader(H)
@@ -33,6 +49,12 @@ def Gen_CanTp(cfg, dir):
     H.write('#define CANTP_MAIN_FUNCTION_PERIOD 10\n')
     H.write('#define CANTP_CONVERT_MS_TO_MAIN_CYCLES(x)  \\\n')
     H.write('  ((x + CANTP_MAIN_FUNCTION_PERIOD - 1) / CANTP_MAIN_FUNCTION_PERIOD)\n')
+    if cfg.get('std_timer', False):
+        H.write('#define CANTP_USE_STD_TIMER\n')
+    if cfg.get('cf_burst', 1) > 1:
+        # the Can below must be able to queue that many frames of the channel, the CanIf Tx
+        # buffer can't, see CheckCfBurst
+        H.write('#define CANTP_CF_BURST %s\n' % (cfg['cf_burst']))
     H.write(
         '/* ================================ [ TYPES     ] ============================================== */\n')
     H.write(
@@ -146,4 +168,8 @@ def Gen(cfg):
     os.makedirs(dir, exist_ok=True)
     with open(cfg) as f:
         cfg = json.load(f)
+    canif = os.path.join(os.path.dirname(dir), 'CanIf.json')
+    if os.path.isfile(canif):
+        with open(canif) as f:
+            CheckCfBurst(cfg, json.load(f))
     Gen_CanTp(cfg, dir)
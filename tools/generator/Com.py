@@ -155,6 +155,12 @@ def gen_sig(sig, msg, C, isTx):
         C.write('    &Com_SignalRxConfig_%s, /* rxConfig */\n' % (sig['name']))
         C.write('    NULL, /* txConfig */\n')
     C.write('#endif\n')
+    C.write('#ifdef COM_USE_RX_SEQLOCK\n')
+    if isTx or ('group' in sig):
+        C.write('    NULL, /* rxContext */\n')
+    else:
+        C.write('    &Com_IPduRxContext_%s, /* rxContext */\n' % (msg['name']))
+    C.write('#endif\n')
     C.write('#ifdef USE_SHELL\n')
     C.write('    "%s",\n' % (sig['name']))
     C.write('    %s,\n' % (str(sig.get('isGroup', False)).upper()))
@@ -172,6 +178,14 @@ def gen_rx_msg_cfg(network, msg, C):
     C.write('  &Com_IPduRxContext_%s,\n' % (msg['name']))
     C.write('  %s, /* RxNotification */\n' % (RxNotification))
     C.write('  %s, /* RxTOut */\n' % (RxTOut))
+    C.write('#ifdef COM_USE_GATEWAY\n')
+    if len(msg.get('gateways', [])) > 0:
+        C.write('  Com_GwMappings_%s,\n' % (msg['name']))
+        C.write('  ARRAY_SIZE(Com_GwMappings_%s),\n' % (msg['name']))
+    else:
+        C.write('  NULL, /* GwMappings */\n')
+        C.write('  0, /* numOfGwMappings */\n')
+    C.write('#endif\n')
     C.write('  COM_CONVERT_MS_TO_MAIN_CYCLES(%s), /* FirstTimeout */\n' %
             (FirstTimeout))
     C.write('  COM_CONVERT_MS_TO_MAIN_CYCLES(%s), /* Timeout */\n' % (Timeout))
@@ -201,6 +215,67 @@ def gen_tx_msg_cfg(network, msg, C):
     C.write('};\n\n')
 
 
+def get_gateway_signal(signals, ref):
+    # a signal is referenced as [network.][message.]signal, the signal name alone is only
+    # enough when no other PDU has a signal of the same name
+    keys = tuple(ref.split('.'))
+    found = [v for k, v in signals.items() if k[3-len(keys):] == keys]
+    if len(found) == 0:
+        raise Exception('gateway signal %s not found' % (ref))
+    if len(found) > 1:
+        raise Exception('gateway signal %s is ambiguous, qualify it as %s' % (
+            ref, ' or '.join('%s.%s.%s' % (v[2]['name'], v[1]['name'], v[0]['name']) for v in found)))
+    return found[0]
+
+
+def get_gateways(cfg):
+    signals = {}
+    txPduIds = {}
+    PDU_ID = 0
+    for network in cfg['networks']:
+        for msg in network['messages']:
+            isTx = msg['node'] == network['me']
+            if isTx:
+                # the same message name may be used on several buses
+                txPduIds[(network['name'], msg['name'])] = PDU_ID
+            PDU_ID += 1
+            for sig in msg['signals']:
+                signals[(network['name'], msg['name'], sig['name'])] = (sig, msg, network, isTx)
+    for network in cfg['networks']:
+        for msg in network['messages']:
+            msg['gateways'] = []
+    for gw in cfg.get('gateways', []):
+        src, rxMsg, rxNetwork, isTx = get_gateway_signal(signals, gw['source'])
+        if isTx:
+            raise Exception('gateway source %s is not a RX signal' % (gw['source']))
+        dst, txMsg, txNetwork, isTx = get_gateway_signal(signals, gw['target'])
+        if not isTx:
+            raise Exception('gateway target %s is not a TX signal' % (gw['target']))
+        if ('group' in src) or ('group' in dst):
+            raise Exception('gateway %s -> %s: route the signal group instead of its group signals' % (
+                gw['source'], gw['target']))
+        if (get_signal_info(src)[0] != get_signal_info(dst)[0]) or (src['size'] != dst['size']):
+            raise Exception('gateway %s -> %s: type or size mismatch' % (gw['source'], gw['target']))
+        name = '%s_%s' % (txNetwork['name'], toMacro(txMsg['name']))
+        txPduId = txPduIds[(txNetwork['name'], txMsg['name'])]
+        rxMsg['gateways'].append((src, dst, 'COM_%s' % (name.upper()), txPduId))
+    for network in cfg['networks']:
+        for msg in network['messages']:
+            # sorted by the Tx IPdu, thus each changed Tx IPdu is only triggered once
+            msg['gateways'].sort(key=lambda x: x[3])
+
+
+def gen_gw_mappings(msg, C):
+    if len(msg.get('gateways', [])) == 0:
+        return
+    C.write('static const Com_GwMappingType Com_GwMappings_%s[] = {\n' % (msg['name']))
+    for src, dst, pduId, _ in msg['gateways']:
+        C.write('  {&Com_SignalConfigs[COM_%sID_%s], &Com_SignalConfigs[COM_%sID_%s], %s},\n' % (
+            'G' if src.get('isGroup', False) else 'S', src['name'],
+            'G' if dst.get('isGroup', False) else 'S', dst['name'], pduId))
+    C.write('};\n\n')
+
+
 def gen_msg(msg, C, network):
     isTx = msg['node'] == network['me']
     C.write('  {\n')
@@ -248,6 +323,8 @@ def Gen_Com(cfg, dir):
         H.write('#define COM_USE_%s\n' % (nt))
     H.write('#define COM_USE_SIGNAL_CONFIG\n')
     H.write('#define COM_USE_SIGNAL_UPDATE_BIT\n')
+    if len(cfg.get('gateways', [])) > 0:
+        H.write('#define COM_USE_GATEWAY\n')
     H.write('\n')
     for network in cfg['networks']:
         H.write('#define COM_RX_FOR_%s(id, PduInfoPtr) \\\n' %
@@ -440,6 +517,11 @@ def Gen_Com(cfg, dir):
                     'G' if sig.get('isGroup', False) else 'S',
                     sig['name']))
             C.write('};\n\n')
+    C.write('#ifdef COM_USE_GATEWAY\n')
+    for network in cfg['networks']:
+        for msg in network['messages']:
+            gen_gw_mappings(msg, C)
+    C.write('#endif /* COM_USE_GATEWAY */\n')
     for network in cfg['networks']:
         for msg in network['messages']:
             gen_cfg = gen_rx_msg_cfg
@@ -547,10 +629,13 @@ def post(cfg):
             else:
                 rxmsgs.append(msg)
         network['messages'] = txmsgs + rxmsgs
+    get_gateways(cfg)
 
 
 def extract(cfg, dir):
     cfg_ = {'class': 'Com', 'networks': []}
+    if 'gateways' in cfg:
+        cfg_['gateways'] = cfg['gateways']
     bNew = False
     for network in cfg['networks']:
         if 'dbc' in network:
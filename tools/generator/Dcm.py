@@ -105,9 +105,12 @@ def gen_read_did_config(C, service, cfg):
         C.write('  },\n')
     C.write('};\n\n')
 
+    ids = gen_sorted_ids(C, 'Dcm_ReadDIDIds', service['DIDs'])
     C.write('static const Dcm_ReadDIDConfigType Dcm_ReadDataByIdentifierConfig = {\n')
     C.write('  Dcm_ReadDIDs,\n')
     C.write('  ARRAY_SIZE(Dcm_ReadDIDs),\n')
+    C.write('  %s,\n' % (ids))
+    C.write('  %s,\n' % (len(service['DIDs'])))
     C.write('};\n\n')
 
 
@@ -194,8 +197,10 @@ def gen_write_did_config(C, service, cfg):
         C.write('  },\n')
     C.write('};\n\n')
 
+    ids = gen_sorted_ids(C, 'Dcm_WriteDIDIds', service['DIDs'])
     C.write('static const Dcm_WriteDIDConfigType Dcm_WriteDataByIdentifierConfig = {\n')
     C.write('  Dcm_WriteDIDs,\n')
+    C.write('  %s,\n' % (ids))
     C.write('  ARRAY_SIZE(Dcm_WriteDIDs),\n')
     C.write('};\n\n')
 
@@ -346,8 +351,10 @@ def gen_ioctl_config(C, service, cfg):
         C.write('    },\n')
         C.write('  },\n')
     C.write('};\n\n')
+    ids = gen_sorted_ids(C, 'Dcm_IOCtrlIds', service['IOCTLs'])
     C.write('static const Dcm_IOControlConfigType Dcm_IOControlByIdentifierConfig = {\n')
     C.write('  Dcm_IOCtrls,\n')
+    C.write('  %s,\n' % (ids))
     C.write('  ARRAY_SIZE(Dcm_IOCtrls),\n')
     C.write('};\n\n')
 
@@ -454,6 +461,25 @@ ServiceMap = {
 }
 
 
+def gen_sorted_ids(C, name, objs):
+    # the DID tables are sorted by preprocess, so Dcm_Dsp can binary search this id table and
+    # use the index of the hit to get the config directly
+    if len(objs) == 0:
+        return 'NULL'
+    C.write('static const uint16_t %s[] = {\n' % (name))
+    for obj in objs:
+        C.write('  0x%X,\n' % (toNum(obj['id'])))
+    C.write('};\n\n')
+    return name
+
+
+def sort_by_id(objs, what):
+    objs.sort(key=lambda x: toNum(x['id']))
+    for a, b in zip(objs, objs[1:]):
+        if toNum(a['id']) == toNum(b['id']):
+            raise Exception('%s 0x%X is duplicated' % (what, toNum(a['id'])))
+
+
 def preprocess(cfg):
     for x in cfg['services']:
         x['id'] = toNum(x['id'])
@@ -463,6 +489,11 @@ def preprocess(cfg):
         elif x['id'] == 0x22:
             for did in x['DIDs']:
                 did['id'] = toNum(did['id'])
+            sort_by_id(x['DIDs'], 'read DID')
+        elif x['id'] == 0x2E:
+            sort_by_id(x['DIDs'], 'write DID')
+        elif x['id'] == 0x2F:
+            sort_by_id(x['IOCTLs'], 'IOCTL')
     for x in cfg['sessions']:
         x['id'] = toNum(x['id'])
 
@@ -528,6 +559,8 @@ def Gen_Dcm(cfg, dir):
         H.write('#define DCM_USE_SERVICE_%s\n' % (ServiceMap[service['id']]['name']))
         if isDtcRelated or isCryptoRelated:
             H.write('#endif\n')
+    if cfg['buffer'].get('paged', False):
+        H.write('#define DCM_USE_PAGED_BUFFER\n')
     H.write(
         '/* ================================ [ TYPES     ] ============================================== */\n')
     H.write(
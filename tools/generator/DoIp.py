@@ -23,6 +23,10 @@ def Gen_DoIp(cfg, dir):
         ID += 1
     H.write('\n#define DOIP_MAX_TESTER_CONNECTIONS %s\n\n' %
             (cfg['max_connections']))
+    H.write('#define DOIP_NUM_BYTE_DIAG_ACK_NACK %s\n' % (cfg.get('ack_nack_bytes', 8)))
+    H.write('#define DOIP_TX_BUFFER_SIZE %s\n' % (cfg.get('tx_buffer_size', 1460)))
+    H.write('#define DOIP_TX_BUDGET_PER_CYCLE %s\n\n' %
+            (cfg.get('tx_budget', '(DOIP_TX_BUFFER_SIZE * DOIP_MAX_TESTER_CONNECTIONS)')))
     H.write('#define DOIP_MAIN_FUNCTION_PERIOD 10\n')
     H.write('#define DOIP_CONVERT_MS_TO_MAIN_CYCLES(x) \\\n')
     H.write('  ((x + DOIP_MAIN_FUNCTION_PERIOD - 1) / DOIP_MAIN_FUNCTION_PERIOD)\n\n')
@@ -125,7 +129,7 @@ def Gen_DoIp(cfg, dir):
     C.write('static const DoIP_TesterType DoIP_Testers[] = {\n')
     for tester in cfg['testers']:
         C.write('  {\n')
-        C.write('    8, /* NumByteDiagAckNack */\n')
+        C.write('    DOIP_NUM_BYTE_DIAG_ACK_NACK, /* NumByteDiagAckNack */\n')
         C.write('    %s, /* TesterSA */\n' % (tester['address']))
         C.write('    DoIP_%s_RoutingActivationRefs,\n' % (tester['name']))
         C.write('    ARRAY_SIZE(DoIP_%s_RoutingActivationRefs),\n' %
@@ -135,6 +139,11 @@ def Gen_DoIp(cfg, dir):
 
     C.write(
         'static DoIP_TesterConnectionContextType DoIP_TesterConnectionContext[DOIP_MAX_TESTER_CONNECTIONS];\n\n')
+    C.write(
+        'static uint8_t DoIP_TesterTxBuffer[DOIP_MAX_TESTER_CONNECTIONS][DOIP_TX_BUFFER_SIZE];\n\n')
+    C.write('/* header 8 + SA/TA 4 + ack code 1 + echo of the request */\n')
+    C.write('static uint8_t DoIP_TesterAckBuffer[DOIP_MAX_TESTER_CONNECTIONS]'
+            '[13 + DOIP_NUM_BYTE_DIAG_ACK_NACK];\n\n')
     C.write(
         'static const DoIP_TesterConnectionType DoIP_TesterConnections[DOIP_MAX_TESTER_CONNECTIONS] = {\n')
     for i in range(cfg['max_connections']):
@@ -142,6 +151,10 @@ def Gen_DoIp(cfg, dir):
         C.write('    &DoIP_TesterConnectionContext[%s],\n' % (i))
         C.write('    SOAD_SOCKID_DOIP_TCP_APT%s,\n' % (i))
         C.write('    SOAD_TX_PID_DOIP_TCP_APT%s,\n' % (i))
+        C.write('    DoIP_TesterTxBuffer[%s],\n' % (i))
+        C.write('    sizeof(DoIP_TesterTxBuffer[%s]),\n' % (i))
+        C.write('    DoIP_TesterAckBuffer[%s],\n' % (i))
+        C.write('    sizeof(DoIP_TesterAckBuffer[%s]),\n' % (i))
         C.write('  },\n')
     C.write('};\n\n')
 
@@ -209,6 +222,7 @@ def Gen_DoIp(cfg, dir):
     C.write('  ARRAY_SIZE(DoIP_Testers),\n')
     C.write('  RxPduIdToConnectionMap,\n')
     C.write('  ARRAY_SIZE(RxPduIdToConnectionMap),\n')
+    C.write('  DOIP_TX_BUDGET_PER_CYCLE,\n')
     C.write('};\n')
     C.write(
         '/* ================================ [ LOCALS    ] ============================================== */\n')
@@ -13,7 +13,8 @@ __all__ = ['Gen']
 
 HIGH_MODULES = ['Dcm']
 TP_MODULES = ['DoIP', 'CanTp', 'LinTp']
-LOW_MODULES = TP_MODULES + ['CanIf']
+IF_MODULES = ['CanIf']
+LOW_MODULES = TP_MODULES + IF_MODULES
 
 
 enable_base_id = True
@@ -38,11 +39,28 @@ def Gen_PduR(cfg, dir):
     groups = {}
     modules = []
     hasGW = False
+    hasIfGW = False
+    hasCutThrough = False
     for rt in cfg['routines']:
         fr = rt['from']
         to = rt['to']
         if fr in TP_MODULES and to in TP_MODULES:
             hasGW = True
+            if 'cut_through' in rt:
+                ct = rt['cut_through']
+                if to != 'CanTp':
+                    raise Exception('%s: cut-through is only supported with destination CanTp' % (rt['name']))
+                if 'memory' not in cfg:
+                    raise Exception('%s: cut-through requires the PduR memory pool' % (rt['name']))
+                # the first frame of the destination must be available when the transmission starts
+                if ct['threshold'] < 64 or ct['size'] < ct['threshold']:
+                    raise Exception('%s: cut-through requires 64 <= threshold <= size' % (rt['name']))
+                hasCutThrough = True
+        if fr in IF_MODULES and to in IF_MODULES:
+            if not isinstance(rt.get('dest', rt['name']), str):
+                # the FIFO of the path is released by the Tx confirmation of one destination
+                raise Exception('%s: IF gateway path supports only one destination' % (rt['name']))
+            hasIfGW = True
         if fr not in groups:
             groups[fr] = {'high': {}, 'low': {}}
         if to in HIGH_MODULES:
@@ -69,6 +87,15 @@ def Gen_PduR(cfg, dir):
         H.write('#define PDUR_USE_MEMPOOL\n')
     if(hasGW):
         H.write('#define PDUR_USE_TP_GATEWAY\n')
+    if(hasIfGW):
+        H.write('#define PDUR_USE_IF_GATEWAY\n')
+        H.write('#ifndef PDUR_MAIN_FUNCTION_PERIOD\n')
+        H.write('#define PDUR_MAIN_FUNCTION_PERIOD 10\n')
+        H.write('#endif\n')
+        H.write('#define PDUR_CONVERT_MS_TO_MAIN_CYCLES(x) \\\n')
+        H.write('  ((x + PDUR_MAIN_FUNCTION_PERIOD - 1) / PDUR_MAIN_FUNCTION_PERIOD)\n')
+    if(hasCutThrough):
+        H.write('#define PDUR_USE_TP_CUT_THROUGH\n')
     H.write('#define PDUR_DCM_TX_BASE_ID %s\n' % (getBaseId(groups, modsFrom=['Dcm'])))
     if enable_base_id:
         H.write('#define PDUR_DOIP_RX_BASE_ID %s\n' % (getBaseId(groups, modsFrom=['DoIP'])))
@@ -91,6 +118,9 @@ def Gen_PduR(cfg, dir):
             for to, rts in grptos.items():
                 for rt in rts:
                     H.write('#define PDUR_%s %s\n' % (rt['name'], index))
+                    if fr in IF_MODULES and to in IF_MODULES and 'dest' in rt:
+                        # the Tx confirmation of the destination comes back with the dest name
+                        H.write('#define PDUR_%s PDUR_%s\n' % (rt['dest'], rt['name']))
                     index += 1
     if 'memory' in cfg:
         MC.Gen_Macros(mcfg, H)
@@ -228,8 +258,31 @@ def Gen_PduR(cfg, dir):
         C.write('  },\n')
         C.write('};\n\n')
         if fr in TP_MODULES and to in TP_MODULES:
-            C.write(
-                'static PduR_BufferType PduR_Buffer_%s = { NULL, 0, 0 };\n' % (name))
+            if hasCutThrough:
+                ct = rt.get('cut_through', {'threshold': 0, 'size': 0})
+                C.write('static PduR_BufferType PduR_Buffer_%s = { NULL, 0, 0, %s, %s };\n' % (
+                    name, ct['threshold'], ct['size']))
+            else:
+                C.write(
+                    'static PduR_BufferType PduR_Buffer_%s = { NULL, 0, 0 };\n' % (name))
+        if fr in IF_MODULES and to in IF_MODULES:
+            queue = rt.get('queue', {})
+            depth = queue.get('depth', 1)
+            size = queue.get('size', 8)
+            policy = queue.get('policy', 'DROP_OLDEST')
+            timeout = queue.get('timeout', 100)
+            C.write('static uint8_t PduR_QueueData_%s[%s * %s];\n' % (name, depth, size))
+            C.write('static PduLengthType PduR_QueueLengths_%s[%s];\n' % (name, depth))
+            C.write('static PduR_QueueContextType PduR_QueueContext_%s;\n' % (name))
+            C.write('static const PduR_QueueType PduR_Queue_%s = {\n' % (name))
+            C.write('  &PduR_QueueContext_%s,\n' % (name))
+            C.write('  PduR_QueueData_%s,\n' % (name))
+            C.write('  PduR_QueueLengths_%s,\n' % (name))
+            C.write('  %s, /* size */\n' % (size))
+            C.write('  %s, /* depth */\n' % (depth))
+            C.write('  PDUR_CONVERT_MS_TO_MAIN_CYCLES(%s), /* timeout */\n' % (timeout))
+            C.write('  PDUR_QUEUE_%s,\n' % (policy))
+            C.write('};\n\n')
     C.write('static const PduR_RoutingPathType PduR_RoutingPaths[] = {\n')
     index = 0
     for fr, grphls in groups.items():
@@ -246,6 +299,12 @@ def Gen_PduR(cfg, dir):
                         C.write('    &PduR_Buffer_%s,\n' % (name))
                     else:
                         C.write('    NULL,\n')
+                    C.write('#ifdef PDUR_USE_IF_GATEWAY\n')
+                    if fr in IF_MODULES and to in IF_MODULES:
+                        C.write('    &PduR_Queue_%s,\n' % (name))
+                    else:
+                        C.write('    NULL,\n')
+                    C.write('#endif\n')
                     C.write('  },\n')
                     index += 1
     C.write('};\n\n')
@@ -57,6 +57,11 @@ def Gen_SoAd(cfg, dir):
         elif 'client' in sock:
             H.write('#define SOAD_TX_PID_%s %s\n' % (mn, ID))
             ID += 1
+    if 'udp_rx_batch' in cfg:
+        H.write('\n#define SOAD_UDP_RX_BATCH %s\n' % (cfg['udp_rx_batch']))
+        # the default is the largest Net buffer, a smaller one drops the longer datagrams
+        if 'udp_rx_buffer_size' in cfg:
+            H.write('#define SOAD_UDP_RX_BUFFER_SIZE %s\n' % (cfg['udp_rx_buffer_size']))
     H.write(
         '/* ================================ [ TYPES     ] ============================================== */\n')
     H.write(
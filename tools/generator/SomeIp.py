@@ -849,6 +849,14 @@ def Gen_ClientService(service, dir):
     C.close()
 
 
+def Gen_SdIndex(C, name, keys):
+    # sorted by key for the binary search of Sd, equal keys keep the config order
+    C.write('static const Sd_IndexType %s[] = {\n' % (name))
+    for index, key in sorted(enumerate(keys), key=lambda x: (x[1], x[0])):
+        C.write('  {0x%X, %s},\n' % (key, index))
+    C.write('};\n\n')
+
+
 def Gen_SD(cfg, dir):
     H = open('%s/Sd_Cfg.h' % (dir), 'w')
     GenHeader(H)
@@ -989,6 +997,8 @@ def Gen_SD(cfg, dir):
                     (service['name'], ge['name']))
             C.write('  },\n')
         C.write('};\n\n')
+        Gen_SdIndex(C, 'Sd_EventHandlersIndex_%s' % (service['name']),
+                    [toNum(ge['groupId']) for ge in service['event-groups']])
     for service in cfg.get('clients', []):
         if 'event-groups' not in service:
             continue
@@ -1016,6 +1026,8 @@ def Gen_SD(cfg, dir):
                 service['name'], ID))
             C.write('  },\n')
         C.write('};\n\n')
+        Gen_SdIndex(C, 'Sd_ConsumedEventGroupsIndex_%s' % (service['name']),
+                    [toNum(ge['groupId']) for ge in service['event-groups']])
     if len(cfg.get('servers', [])) > 0:
         C.write('static Sd_ServerServiceContextType Sd_ServerService_Contexts[%s];\n\n' % (
             len(cfg.get('servers', []))))
@@ -1041,12 +1053,13 @@ def Gen_SD(cfg, dir):
         C.write('    &Sd_ServerService_Contexts[%s],\n' % (ID))
         C.write('    0, /* InstanceIndex */\n')
         if 'event-groups' not in service:
-            C.write('    NULL,\n    0,\n')
+            C.write('    NULL,\n    0,\n    NULL,\n')
         elif 0 == len(service['event-groups']):
-            C.write('    NULL,\n    0,\n')
+            C.write('    NULL,\n    0,\n    NULL,\n')
         else:
             C.write('    Sd_EventHandlers_%s,\n' % (service['name']))
             C.write('    ARRAY_SIZE(Sd_EventHandlers_%s),\n' %(service['name']))
+            C.write('    Sd_EventHandlersIndex_%s,\n' % (service['name']))
         C.write('    SOMEIP_SSID_%s, /* SomeIpServiceId */\n' %(mn))
         C.write('  },\n')
     if len(cfg.get('servers', [])) > 0:
@@ -1077,16 +1090,23 @@ def Gen_SD(cfg, dir):
         C.write('    &Sd_ClientService_Contexts[%s],\n' % (ID))
         C.write('    0, /* InstanceIndex */\n')
         if 'event-groups' not in service:
-            C.write('    NULL,\n    0,\n')
+            C.write('    NULL,\n    0,\n    NULL,\n')
         elif 0 == len(service['event-groups']):
-            C.write('    NULL,\n    0,\n')
+            C.write('    NULL,\n    0,\n    NULL,\n')
         else:
             C.write('    Sd_ConsumedEventGroups_%s,\n' % (service['name']))
             C.write('    ARRAY_SIZE(Sd_ConsumedEventGroups_%s),\n' %
                     (service['name']))
+            C.write('    Sd_ConsumedEventGroupsIndex_%s,\n' % (service['name']))
         C.write('  },\n')
     if len(cfg.get('clients', [])) > 0:
         C.write('};\n\n')
+    if len(cfg.get('servers', [])) > 0:
+        Gen_SdIndex(C, 'Sd_ServerServicesIndex',
+                    [(toNum(s['service']) << 16) + toNum(s['instance']) for s in cfg['servers']])
+    if len(cfg.get('clients', [])) > 0:
+        Gen_SdIndex(C, 'Sd_ClientServicesIndex',
+                    [(toNum(s['service']) << 16) + toNum(s['instance']) for s in cfg['clients']])
     C.write('static uint8_t sd_buffer[1400];\n')
     C.write('static Sd_InstanceContextType sd_context;\n')
     C.write('static const Sd_InstanceType Sd_Instances[] = {\n')
@@ -1112,15 +1132,19 @@ def Gen_SD(cfg, dir):
     if len(cfg.get('servers', [])) > 0:
         C.write('    Sd_ServerServices,             /* ServerServices */\n')
         C.write('    ARRAY_SIZE(Sd_ServerServices), /* numOfServerServices */\n')
+        C.write('    Sd_ServerServicesIndex,        /* ServerServicesIndex */\n')
     else:
         C.write('    NULL,                          /* ServerServices */\n')
         C.write('    0,                             /* numOfServerServices */\n')
+        C.write('    NULL,                          /* ServerServicesIndex */\n')
     if len(cfg.get('clients', [])) > 0:
         C.write('    Sd_ClientServices,             /* ClientServices */\n')
         C.write('    ARRAY_SIZE(Sd_ClientServices), /* numOfClientServices */\n')
+        C.write('    Sd_ClientServicesIndex,        /* ClientServicesIndex */\n')
     else:
         C.write('    NULL,                          /* ClientServices */\n')
         C.write('    0,                             /* numOfClientServices */\n')
+        C.write('    NULL,                          /* ClientServicesIndex */\n')
     C.write('    sd_buffer,                     /* buffer */\n')
     C.write('    sizeof(sd_buffer),\n')
     C.write('    &sd_context,\n')
@@ -1207,6 +1231,99 @@ def Gen_SD(cfg, dir):
     C.close()
 
 
+def IsFixedStruct(name, structs, fixed):
+    # no optional member and no variable array, also in the nested structs, so the serialized
+    # layout is known here. Decided from the config only, not from the with_length/with_tag
+    # marks of the header generation, and memoized in fixed as nested structs are shared.
+    if name not in fixed:
+        struct = structs[name]
+        isFixed = True
+        for data in struct['data']:
+            dinfo = GetTypeInfo(data, structs)
+            if data.get('optional', False):
+                isFixed = False
+            elif dinfo['IsArray'] and (data.get('variable_array', False) or
+                                       dinfo.get('variable_array', False)):
+                isFixed = False
+            elif (data['type'] in structs) and (not IsFixedStruct(data['type'], structs, fixed)):
+                isFixed = False
+        fixed[name] = isFixed
+    return fixed[name]
+
+
+def Gen_XfPutGet(C, name, struct, structs):
+    wide = {2: 'SHORT', 4: 'LONG', 8: 'LONG_LONG'}
+    ctypes = {2: 'uint16_t', 4: 'uint32_t', 8: 'uint64_t'}
+    puts = []
+    gets = []
+    temps = []
+    offset = 0
+    for data in struct['data']:
+        dinfo = GetTypeInfo(data, structs)
+        n = data.get('size', 1)
+        field = 'p->%s' % (data['name'])
+        if data['type'] in structs:
+            wsz = GetStructSize(structs[data['type']], structs)
+            if dinfo['IsArray']:
+                puts.append('for (i = 0; i < %s; i++) {' % (n))
+                puts.append('  SomeIpXf_Put%s(&buffer[%s + %s * i], &%s[i]);' %
+                            (data['type'], offset, wsz, field))
+                puts.append('}')
+                gets.append('for (i = 0; i < %s; i++) {' % (n))
+                gets.append('  SomeIpXf_Get%s(&buffer[%s + %s * i], &%s[i]);' %
+                            (data['type'], offset, wsz, field))
+                gets.append('}')
+                temps.append('i')
+            else:
+                puts.append('SomeIpXf_Put%s(&buffer[%s], &%s);' % (data['type'], offset, field))
+                gets.append('SomeIpXf_Get%s(&buffer[%s], &%s);' % (data['type'], offset, field))
+            offset += wsz * n
+            continue
+        sz = dinfo['size']
+        if 1 == sz:
+            if dinfo['IsArray']:
+                puts.append('memcpy(&buffer[%s], %s, %s);' % (offset, field, n))
+                gets.append('memcpy(%s, &buffer[%s], %s);' % (field, offset, n))
+            else:
+                puts.append('buffer[%s] = (uint8_t)%s;' % (offset, field))
+                gets.append('%s = (%s)buffer[%s];' % (field, dinfo['ctype'], offset))
+        elif dinfo['IsArray']:
+            bulk = {2: 'Shorts', 4: 'Longs', 8: 'LongLongs'}[sz]
+            puts.append('SomeIpXf_Put%s(&buffer[%s], (const %s *)%s, %s);' %
+                        (bulk, offset, ctypes[sz], field, n))
+            gets.append('SomeIpXf_Get%s(&buffer[%s], (%s *)%s, %s);' %
+                        (bulk, offset, ctypes[sz], field, n))
+        elif dinfo['ctype'] in ['float', 'double']:
+            # the bits of the IEEE 754 value are serialized as an integer
+            tmp = 'u%s' % (sz * 8)
+            temps.append(tmp)
+            puts.append('memcpy(&%s, &%s, %s);' % (tmp, field, sz))
+            puts.append('SOMEIPXF_PUT_%s(&buffer[%s], %s);' % (wide[sz], offset, tmp))
+            gets.append('%s = SOMEIPXF_GET_%s(&buffer[%s]);' % (tmp, wide[sz], offset))
+            gets.append('memcpy(&%s, &%s, %s);' % (field, tmp, sz))
+        else:
+            puts.append('SOMEIPXF_PUT_%s(&buffer[%s], (%s)%s);' %
+                        (wide[sz], offset, ctypes[sz], field))
+            gets.append('%s = (%s)SOMEIPXF_GET_%s(&buffer[%s]);' %
+                        (field, dinfo['ctype'], wide[sz], offset))
+        offset += sz * n
+    assert offset == GetStructSize(struct, structs)
+    for fnc, ptype, lines in [('Put', 'uint8_t *buffer, const void *pStruct', puts),
+                              ('Get', 'const uint8_t *buffer, void *pStruct', gets)]:
+        C.write('static void SomeIpXf_%s%s(%s) {\n' % (fnc, name, ptype))
+        C.write('  %s%s_Type *p = (%s%s_Type *)pStruct;\n' %
+                ('const ' if fnc == 'Put' else '', name, 'const ' if fnc == 'Put' else '', name))
+        if 'i' in temps:
+            C.write('  uint32_t i;\n')
+        for tmp, ctype in [('u32', 'uint32_t'), ('u64', 'uint64_t')]:
+            if tmp in temps:
+                C.write('  %s %s;\n' % (ctype, tmp))
+        C.write('\n')
+        for l in lines:
+            C.write('  %s\n' % (l))
+        C.write('}\n\n')
+
+
 def Gen_SOMEIPXF(cfg, dir):
     for service in cfg.get('servers', []):
         Gen_ServerServiceXf(service, cfg, dir)
@@ -1265,12 +1382,19 @@ def Gen_SOMEIPXF(cfg, dir):
         '/* ================================ [ INCLUDES  ] ============================================== */\n')
     C.write('#include "SomeIpXf_Priv.h"\n')
     C.write('#include "SomeIpXf_Cfg.h"\n')
+    C.write('#include <string.h>\n')
     C.write(
         '/* ================================ [ MACROS    ] ============================================== */\n')
     C.write(
         '/* ================================ [ TYPES     ] ============================================== */\n')
     C.write(
         '/* ================================ [ DECLARES  ] ============================================== */\n')
+    structs = GetStructs(cfg)
+    fixed = {}
+    for name, struct in structs.items():
+        if IsFixedStruct(name, structs, fixed):
+            C.write('static void SomeIpXf_Put%s(uint8_t *buffer, const void *pStruct);\n' % (name))
+            C.write('static void SomeIpXf_Get%s(const uint8_t *buffer, void *pStruct);\n' % (name))
     C.write(
         '/* ================================ [ DATAS     ] ============================================== */\n')
     for name, struct in GetStructs(cfg).items():
@@ -1340,9 +1464,20 @@ def Gen_SOMEIPXF(cfg, dir):
         else:
             sizeOfStructLengthField = 0
         C.write('  %s /* sizeOfStructLengthField for %s */,\n' % (sizeOfStructLengthField, sz))
+        if IsFixedStruct(name, structs, fixed):
+            C.write('  SomeIpXf_Put%s,\n' % (name))
+            C.write('  SomeIpXf_Get%s,\n' % (name))
+            C.write('  %s, /* wireSize */\n' % (sz))
+        else:
+            C.write('  NULL,\n')
+            C.write('  NULL,\n')
+            C.write('  0,\n')
         C.write('};\n\n')
     C.write(
         '/* ================================ [ LOCALS    ] ============================================== */\n')
+    for name, struct in structs.items():
+        if IsFixedStruct(name, structs, fixed):
+            Gen_XfPutGet(C, name, struct, structs)
     C.write(
         '/* ================================ [ FUNCTIONS ] ============================================== */\n')
     C.close()
@@ -1428,6 +1563,17 @@ def Gen_SOMEIP(cfg, dir):
     H.write('\n#define SOMEIP_MAIN_FUNCTION_PERIOD 10\n')
     H.write('#define SOMEIP_CONVERT_MS_TO_MAIN_CYCLES(x) \\\n')
     H.write('  ((x + SOMEIP_MAIN_FUNCTION_PERIOD - 1) / SOMEIP_MAIN_FUNCTION_PERIOD)\n')
+    if 'tcp_ring' in cfg:
+        H.write('#define SOMEIP_TCP_RING_SIZE %s\n' % (cfg['tcp_ring']))
+    tp = cfg.get('tp', {})
+    if 'window' in tp:
+        H.write('#define SOMEIP_TP_TX_WINDOW %s\n' % (tp['window']))
+    if 'budget_method' in tp:
+        H.write('#define SOMEIP_TP_TX_BUDGET_METHOD %s\n' % (tp['budget_method']))
+    if 'budget_event' in tp:
+        H.write('#define SOMEIP_TP_TX_BUDGET_EVENT %s\n' % (tp['budget_event']))
+    if 'pacing_us' in tp:
+        H.write('#define SOMEIP_TP_TX_PACING_US %s\n' % (tp['pacing_us']))
     H.write(
         '/* ================================ [ TYPES     ] ============================================== */\n')
     H.write(
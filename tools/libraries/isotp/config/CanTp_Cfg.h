@@ -10,6 +10,8 @@
 #define CANTP_MAIN_FUNCTION_PERIOD 10
 #define CANTP_CONVERT_MS_TO_MAIN_CYCLES(x)                                                         \
   ((x + CANTP_MAIN_FUNCTION_PERIOD - 1) / CANTP_MAIN_FUNCTION_PERIOD)
+/* the STmin is timed by Std_GetTime, not by the 10ms main function */
+#define CANTP_USE_STD_TIMER
 /* ================================ [ TYPES     ] ============================================== */
 typedef struct {
   const char *device;
@@ -36,6 +36,7 @@ static pthread_mutex_t lMutex = PTHREAD_MUTEX_INITIALIZER;
 static void *can_server_main(void *args) {
   isotp_t *isotp = (isotp_t *)args;
   Std_TimerType timer10ms;
+  std_time_t stminLeft;
   uint8_t Channel = isotp->Channel;
   CanTp_ParamType param;
   Std_ReturnType ret;
@@ -74,6 +75,10 @@ static void *can_server_main(void *args) {
       Std_TimerStart(&timer10ms);
     }
 
+    pthread_mutex_lock(&isotp->mutex);
+    stminLeft = CanTp_MainFunction_SeparationTime(Channel);
+    pthread_mutex_unlock(&isotp->mutex);
+
     pthread_mutex_lock(&isotp->mutex);
     if (Std_IsTimerStarted(&isotp->timerErrorNotify)) {
       if (Std_GetTimerElapsedTime(&isotp->timerErrorNotify) >= isotp->errorTimeout) {
@@ -84,7 +89,12 @@ static void *can_server_main(void *args) {
     }
     pthread_mutex_unlock(&isotp->mutex);
 
-    usleep(1000);
+    if ((stminLeft > 0) && (stminLeft < 1000)) {
+      /* wake up in time for the next CF */
+      usleep(stminLeft);
+    } else {
+      usleep(1000);
+    }
   }
 
   Can_SetControllerMode(Channel, CAN_CS_STOPPED);
@@ -296,8 +306,11 @@ BufReq_ReturnType IsoTp_CanCopyRxData(PduIdType id, const PduInfoType *info,
     pthread_mutex_lock(&isotp->mutex);
     if ((isotp->RX.index + info->SduLength) <= isotp->RX.length) {
       ASLOG(ISOTP, ("[%d] copy rx data(%d)\n", id, info->SduLength));
-      memcpy(&isotp->RX.data[isotp->RX.index], info->SduDataPtr, info->SduLength);
-      isotp->RX.index += info->SduLength;
+      if (info->SduLength > 0) {
+        memcpy(&isotp->RX.data[isotp->RX.index], info->SduDataPtr, info->SduLength);
+        isotp->RX.index += info->SduLength;
+      }
+      *bufferSizePtr = (PduLengthType)(isotp->RX.length - isotp->RX.index);
       ret = BUFREQ_OK;
     } else {
       ASLOG(ISOTPE, ("[%d] listen buffer overflow\n", id));